@@ -24,9 +24,14 @@
 #include <ScalarField.h>
 
 #include "PyScalarType.h"
+#include "dlpackPy.hpp"
+#include "pyccParallel.h"
 #include "pyccTrace.h"
 #include "ScalarFieldPy_DocStrings.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace bp = boost::python;
@@ -60,6 +65,12 @@ bnp::ndarray ToNpArray_py(CCCoreLib::ScalarField &self)
     return result;
 }
 
+bp::object ToDLPack_py(bp::object self, bp::object stream = bp::object())
+{
+    CCCoreLib::ScalarField& sf = bp::extract<CCCoreLib::ScalarField&>(self);
+    return DLPack_wrap_py(self, sf.data(), DLPack_dtype<ScalarType>(), sf.size());
+}
+
 void fromNPArray_copy(CCCoreLib::ScalarField &self, bnp::ndarray const & array)
 {
     if (array.get_dtype() != bnp::dtype::get_builtin<PyScalarType>())
@@ -88,6 +99,185 @@ bp::tuple computeMeanAndVariance_py(CCCoreLib::ScalarField &self)
     return res;
 }
 
+//! partial statistics on a chunk, moments shifted by the first valid value for accuracy
+struct SFChunkStats_py
+{
+    size_t count = 0;
+    size_t nanCount = 0;
+    double minVal = std::numeric_limits<double>::max();
+    double maxVal = std::numeric_limits<double>::lowest();
+    double shift = 0;
+    double s1 = 0; // sum of (v - shift)
+    double s2 = 0; // sum of (v - shift)^2
+};
+
+//! resolution of the histogram used for approximate percentiles
+const size_t SF_STATS_FINE_BINS = 16384;
+
+bp::dict stats_py(CCCoreLib::ScalarField &self, int bins = 256, bp::list percentiles = bp::list())
+{
+    if (bins < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "number of bins must be positive or zero");
+        bp::throw_error_already_set();
+    }
+    std::vector<double> pcts;
+    for (bp::ssize_t i = 0; i < bp::len(percentiles); i++)
+    {
+        double p = bp::extract<double>(percentiles[i]);
+        if (p < 0. || p > 100.)
+        {
+            PyErr_SetString(PyExc_ValueError, "percentiles must be in [0, 100]");
+            bp::throw_error_already_set();
+        }
+        pcts.push_back(p);
+    }
+    const ScalarType* v = self.data();
+    size_t n = self.size();
+    std::vector<pyCC_Range> ranges = pyCC_SplitRange(n);
+
+    // --- first pass: count, NaN count, min, max, moments
+    std::vector<SFChunkStats_py> chunks(ranges.size());
+    pyCC_ParallelForRanges(ranges, [v, &chunks](const pyCC_Range& r)
+    {
+        SFChunkStats_py c;
+        for (size_t i = r.begin; i < r.end; i++)
+        {
+            double x = v[i];
+            if (std::isnan(x))
+            {
+                c.nanCount++;
+                continue;
+            }
+            if (c.count == 0)
+                c.shift = x;
+            c.count++;
+            c.minVal = std::min(c.minVal, x);
+            c.maxVal = std::max(c.maxVal, x);
+            double dx = x - c.shift;
+            c.s1 += dx;
+            c.s2 += dx * dx;
+        }
+        chunks[r.chunk] = c;
+    });
+
+    // merge the chunks (Chan et al. pairwise update of mean and M2)
+    size_t count = 0;
+    size_t nanCount = 0;
+    double minVal = std::numeric_limits<double>::max();
+    double maxVal = std::numeric_limits<double>::lowest();
+    double mean = 0;
+    double m2 = 0;
+    for (const SFChunkStats_py& c : chunks)
+    {
+        nanCount += c.nanCount;
+        if (c.count == 0)
+            continue;
+        double cMean = c.shift + c.s1 / c.count;
+        double cM2 = std::max(c.s2 - c.s1 * c.s1 / c.count, 0.);
+        size_t total = count + c.count;
+        double delta = cMean - mean;
+        mean += delta * c.count / total;
+        m2 += cM2 + delta * delta * (static_cast<double>(count) * c.count / total);
+        count = total;
+        minVal = std::min(minVal, c.minVal);
+        maxVal = std::max(maxVal, c.maxVal);
+    }
+
+    bp::dict res;
+    res["count"] = count;
+    res["nanCount"] = nanCount;
+    bnp::ndarray hist = bnp::zeros(bp::make_tuple(bins), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray edges = bnp::zeros(bp::make_tuple(bins + 1), bnp::dtype::get_builtin<double>());
+    bp::dict pctRes;
+    if (count == 0)
+    {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        res["min"] = nan;
+        res["max"] = nan;
+        res["mean"] = nan;
+        res["variance"] = nan;
+        for (double p : pcts)
+            pctRes[p] = nan;
+        res["histogram"] = hist;
+        res["binEdges"] = edges;
+        res["percentiles"] = pctRes;
+        return res;
+    }
+    res["min"] = minVal;
+    res["max"] = maxVal;
+    res["mean"] = mean;
+    res["variance"] = m2 / count;
+
+    // --- second pass, once the range is known: histogram and fine histogram for the percentiles
+    size_t nbBins = bins;
+    size_t nbFine = pcts.empty() ? 0 : SF_STATS_FINE_BINS;
+    double width = maxVal - minVal;
+    double binScale = (width > 0) ? nbBins / width : 0;
+    double fineScale = (width > 0) ? nbFine / width : 0;
+    std::vector<std::vector<int64_t>> chunkHist(ranges.size());
+    std::vector<std::vector<uint32_t>> chunkFine(ranges.size());
+    if (nbBins || nbFine)
+    {
+        pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+        {
+            std::vector<int64_t>& h = chunkHist[r.chunk];
+            std::vector<uint32_t>& f = chunkFine[r.chunk];
+            h.assign(nbBins, 0);
+            f.assign(nbFine, 0);
+            for (size_t i = r.begin; i < r.end; i++)
+            {
+                double x = v[i];
+                if (std::isnan(x))
+                    continue;
+                double rel = x - minVal;
+                if (nbBins)
+                    h[std::min(static_cast<size_t>(rel * binScale), nbBins - 1)]++;
+                if (nbFine)
+                    f[std::min(static_cast<size_t>(rel * fineScale), nbFine - 1)]++;
+            }
+        });
+    }
+    int64_t* dh = reinterpret_cast<int64_t*>(hist.get_data());
+    double* de = reinterpret_cast<double*>(edges.get_data());
+    for (size_t b = 0; b <= nbBins; b++)
+        de[b] = (b == nbBins) ? maxVal : minVal + b * width / nbBins;
+    for (const std::vector<int64_t>& h : chunkHist)
+        for (size_t b = 0; b < h.size(); b++)
+            dh[b] += h[b];
+
+    // percentiles: linear interpolation of the rank inside the fine bin
+    std::vector<uint64_t> fine(nbFine, 0);
+    for (const std::vector<uint32_t>& f : chunkFine)
+        for (size_t b = 0; b < f.size(); b++)
+            fine[b] += f[b];
+    for (double p : pcts)
+    {
+        double rank = p / 100. * (count - 1);
+        double value = maxVal;
+        uint64_t cumul = 0;
+        for (size_t b = 0; b < nbFine; b++)
+        {
+            if (fine[b] && rank < cumul + fine[b])
+            {
+                double frac = (fine[b] > 1) ? (rank - cumul) / (fine[b] - 1) : 0.5;
+                value = minVal + (b + std::min(frac, 1.)) * width / nbFine;
+                break;
+            }
+            cumul += fine[b];
+        }
+        pctRes[p] = std::min(std::max(value, minVal), maxVal);
+    }
+    res["histogram"] = hist;
+    res["binEdges"] = edges;
+    res["percentiles"] = pctRes;
+    CCTRACE("stats: " << count << " values, " << nanCount << " NaN");
+    return res;
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(stats_py_overloads, stats_py, 1, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ToDLPack_py_overloads, ToDLPack_py, 1, 2)
+
 ScalarType& (CCCoreLib::ScalarField::* getValue1)(std::size_t) = &CCCoreLib::ScalarField::getValue; // getValue1: pointer to member function
 const ScalarType& (CCCoreLib::ScalarField::* getValue2)(std::size_t) const = &CCCoreLib::ScalarField::getValue; //pointer to member function with const qualifier
 //typedef const ScalarType& (CCCoreLib::ScalarField::*gvftype)(std::size_t) const; // the same using a typedef
@@ -96,6 +286,8 @@ const ScalarType& (CCCoreLib::ScalarField::* getValue2)(std::size_t) const = &CC
 void export_ScalarField()
 {
     class_<CCCoreLib::ScalarField, boost::noncopyable>("ScalarField", ScalarFieldPy_ScalarField_doc, no_init) // boost::noncopyable required to avoid issue with protected destructor
+        .def("__dlpack__", &ToDLPack_py, ToDLPack_py_overloads(args("self", "stream"), ScalarFieldPy_dlpack_doc))
+        .def("__dlpack_device__", &DLPack_device_py, ScalarFieldPy_dlpack_device_doc)
         .def("addElement", &CCCoreLib::ScalarField::addElement, ScalarFieldPy_addElement_doc)
         .def("computeMeanAndVariance", &computeMeanAndVariance_py, ScalarFieldPy_computeMeanAndVariance_doc)
         .def("computeMinAndMax", &CCCoreLib::ScalarField::computeMinAndMax, ScalarFieldPy_computeMinAndMax_doc)
@@ -112,6 +304,7 @@ void export_ScalarField()
         .def("resizeSafe", &CCCoreLib::ScalarField::resizeSafe, ScalarFieldPy_resizeSafe_doc)
         .def("setName", &CCCoreLib::ScalarField::setName, ScalarFieldPy_setName_doc)
         .def("setValue", &CCCoreLib::ScalarField::setValue, ScalarFieldPy_setValue_doc)
+        .def("stats", &stats_py, stats_py_overloads(args("self", "bins", "percentiles"), ScalarFieldPy_stats_doc))
         .def("swap", &CCCoreLib::ScalarField::swap, ScalarFieldPy_swap_doc)
         .def("toNpArray", &ToNpArray_py, ScalarFieldPy_toNpArray_doc)
         .def("toNpArrayCopy", &ToNpArray_copy, ScalarFieldPy_toNpArrayCopy_doc)
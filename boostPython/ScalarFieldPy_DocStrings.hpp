@@ -25,6 +25,24 @@ A simple scalar field (to be associated to a point cloud).
 A monodimensional array of scalar values.
 Invalid values can be represented by CCCoreLib::NAN_VALUE.)";
 
+const char* ScalarFieldPy_dlpack_doc= R"(
+Export the ScalarField data as a one dimension DLPack tensor, without copy (DLPack protocol).
+
+Used by the tensor libraries, for instance ``torch.from_dlpack(sf)``.
+As with :py:meth:`toNpArray`, data is not copied and stays owned by the ScalarField:
+the tensor must not be used after the destruction or the resize of the ScalarField.
+
+:param stream: not used (CPU only), default None
+
+:return: a PyCapsule 'dltensor'
+:rtype: PyCapsule )";
+
+const char* ScalarFieldPy_dlpack_device_doc= R"(
+Return the device of the tensor exported by :py:meth:`__dlpack__` (DLPack protocol).
+
+:return: (1, 0) (kDLCPU, device 0)
+:rtype: tuple )";
+
 const char* ScalarFieldPy_addElement_doc= R"(
 Add a value at the end of the vector.
 
@@ -131,6 +149,24 @@ Set the value at the given index.
 :param int index: index in the ScalarField
 :param float value: value to set at index )";
 
+const char* ScalarFieldPy_stats_doc= R"(
+Computes all the statistics of the scalar field at once, multithreaded.
+
+A first parallel pass gives the number of valid values, the number of NaN, min, max, mean and variance.
+A second parallel pass, when the range is known, gives the histogram and the percentiles.
+The percentiles are approximate, interpolated in a histogram of 16384 bins (no sort):
+the error is below (max - min)/16384.
+NaN values are ignored, except in nanCount.
+
+:param int,optional bins: number of bins of the histogram, default 256, 0 for no histogram
+:param list,optional percentiles: list of percentiles to compute, in [0, 100], default empty
+
+:return: a dictionary with keys 'count', 'nanCount', 'min', 'max', 'mean', 'variance',
+         'histogram' (numpy array of int64, size bins), 'binEdges' (numpy array of float64, size bins+1),
+         'percentiles' (dictionary {percentile: value})
+:rtype: dict
+)";
+
 const char* ScalarFieldPy_swap_doc= R"(
 Swap values between two indices.
 
@@ -0,0 +1,619 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "arrowPy.hpp"
+
+#include <boost/python.hpp>
+#include <Python.h>
+
+#include <ccPointCloud.h>
+#include <ccColorTypes.h>
+#include <ccNormalVectors.h>
+#include <ScalarField.h>
+
+#include "PyScalarType.h"
+#include "packedSFPy.hpp"
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace bp = boost::python;
+
+// --- export
+
+//! one exported column: owns its name, and its data when converted
+struct ArrowColumn_py
+{
+    std::string name;
+    const char* format;
+    std::vector<char> storage;  //!< converted data, empty when the data is borrowed from the cloud
+    const void* buffers[2];     //!< validity (always null: no null values) and data
+    PyObject* owner;            //!< Python owner of borrowed data, or nullptr
+
+    ArrowColumn_py(const std::string& n, const char* f)
+        : name(n), format(f), owner(nullptr)
+    {
+        buffers[0] = nullptr;
+        buffers[1] = nullptr;
+    }
+
+    template<typename T> T* allocate(size_t count)
+    {
+        storage.resize(count * sizeof(T));
+        buffers[1] = storage.data();
+        return reinterpret_cast<T*>(storage.data());
+    }
+
+    void borrow(const void* data, PyObject* pyOwner)
+    {
+        buffers[1] = data;
+        owner = pyOwner;
+        Py_INCREF(owner);
+    }
+};
+
+//! parent structures of the record batch, the children are released independently
+template<typename T> struct ArrowParent_py
+{
+    std::vector<T> children;
+    std::vector<T*> childPtrs;
+    const void* buffers[1];
+};
+
+static void ArrowSchema_releaseChild(ArrowSchema* schema)
+{
+    delete static_cast<std::string*>(schema->private_data);
+    schema->release = nullptr;
+}
+
+static void ArrowSchema_release(ArrowSchema* schema)
+{
+    ArrowParent_py<ArrowSchema>* parent = static_cast<ArrowParent_py<ArrowSchema>*>(schema->private_data);
+    for (auto& child : parent->children)
+        if (child.release)
+            child.release(&child);
+    delete parent;
+    schema->release = nullptr;
+}
+
+static void ArrowArray_releaseChild(ArrowArray* array)
+{
+    ArrowColumn_py* column = static_cast<ArrowColumn_py*>(array->private_data);
+    if (column->owner)
+    {
+        // the consumer may release the array from any thread, without the GIL
+        PyGILState_STATE state = PyGILState_Ensure();
+        Py_DECREF(column->owner);
+        PyGILState_Release(state);
+    }
+    delete column;
+    array->release = nullptr;
+}
+
+static void ArrowArray_release(ArrowArray* array)
+{
+    ArrowParent_py<ArrowArray>* parent = static_cast<ArrowParent_py<ArrowArray>*>(array->private_data);
+    for (auto& child : parent->children)
+        if (child.release)
+            child.release(&child);
+    delete parent;
+    array->release = nullptr;
+}
+
+static void ArrowSchema_capsuleDestructor(PyObject* capsule)
+{
+    ArrowSchema* schema = static_cast<ArrowSchema*>(PyCapsule_GetPointer(capsule, "arrow_schema"));
+    if (schema->release)
+        schema->release(schema);
+    delete schema;
+}
+
+static void ArrowArray_capsuleDestructor(PyObject* capsule)
+{
+    ArrowArray* array = static_cast<ArrowArray*>(PyCapsule_GetPointer(capsule, "arrow_array"));
+    if (array->release)
+        array->release(array);
+    delete array;
+}
+
+static std::vector<ArrowColumn_py*> ccPointCloud_arrowColumns(ccPointCloud& cloud, PyObject* owner)
+{
+    std::vector<ArrowColumn_py*> columns;
+    size_t nbPts = cloud.size();
+
+    // --- interleaved coordinates: converted in parallel, in one pass
+    ArrowColumn_py* cx = new ArrowColumn_py("X", "f");
+    ArrowColumn_py* cy = new ArrowColumn_py("Y", "f");
+    ArrowColumn_py* cz = new ArrowColumn_py("Z", "f");
+    columns.push_back(cx);
+    columns.push_back(cy);
+    columns.push_back(cz);
+    float* x = cx->allocate<float>(nbPts);
+    float* y = cy->allocate<float>(nbPts);
+    float* z = cz->allocate<float>(nbPts);
+    if (nbPts)
+    {
+        const PointCoordinateType* s = reinterpret_cast<const PointCoordinateType*>(cloud.getPoint(0));
+        pyCC_ParallelFor(nbPts, [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                x[i] = s[3*i];
+                y[i] = s[3*i+1];
+                z[i] = s[3*i+2];
+            }
+        });
+    }
+
+    // --- scalar fields: no copy
+    for (unsigned j = 0; j < cloud.getNumberOfScalarFields(); j++)
+    {
+        CCCoreLib::ScalarField* sf = cloud.getScalarField(j);
+        ArrowColumn_py* col = new ArrowColumn_py(sf->getName(), (sizeof(ScalarType) == 4) ? "f" : "g");
+        col->borrow(sf->data(), owner);
+        columns.push_back(col);
+    }
+
+    // --- RGBA colors: interleaved, converted in parallel
+    if (cloud.hasColors())
+    {
+        unsigned char* c[4];
+        const char* names[4] = { "R", "G", "B", "A" };
+        for (int k = 0; k < 4; k++)
+        {
+            ArrowColumn_py* col = new ArrowColumn_py(names[k], "C");
+            c[k] = col->allocate<unsigned char>(nbPts);
+            columns.push_back(col);
+        }
+        pyCC_ParallelFor(nbPts, [&cloud, c](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const ccColor::Rgba& rgba = cloud.getPointColor(static_cast<unsigned>(i));
+                c[0][i] = rgba.r;
+                c[1][i] = rgba.g;
+                c[2][i] = rgba.b;
+                c[3][i] = rgba.a;
+            }
+        });
+    }
+
+    // --- compressed normals: decoded in parallel
+    if (cloud.hasNormals())
+    {
+        float* n[3];
+        const char* names[3] = { "Nx", "Ny", "Nz" };
+        for (int k = 0; k < 3; k++)
+        {
+            ArrowColumn_py* col = new ArrowColumn_py(names[k], "f");
+            n[k] = col->allocate<float>(nbPts);
+            columns.push_back(col);
+        }
+        pyCC_ParallelFor(nbPts, [&cloud, n](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const CCVector3& N = cloud.getPointNormal(static_cast<unsigned>(i));
+                n[0][i] = N.x;
+                n[1][i] = N.y;
+                n[2][i] = N.z;
+            }
+        });
+    }
+    return columns;
+}
+
+bp::tuple ccPointCloud_toArrow_py(bp::object self)
+{
+    CCTRACE("toArrow");
+    ccPointCloud& cloud = bp::extract<ccPointCloud&>(self);
+    // the scalar field columns are borrowed: the evicted and packed fields are restored for good
+    materializeScalarFields_py(cloud);
+    std::vector<ArrowColumn_py*> columns = ccPointCloud_arrowColumns(cloud, self.ptr());
+    size_t nbCols = columns.size();
+    int64_t nbPts = cloud.size();
+
+    ArrowSchema* schema = new ArrowSchema;
+    ArrowParent_py<ArrowSchema>* schemaParent = new ArrowParent_py<ArrowSchema>;
+    schemaParent->children.resize(nbCols);
+    ArrowArray* array = new ArrowArray;
+    ArrowParent_py<ArrowArray>* arrayParent = new ArrowParent_py<ArrowArray>;
+    arrayParent->children.resize(nbCols);
+    arrayParent->buffers[0] = nullptr;
+
+    for (size_t j = 0; j < nbCols; j++)
+    {
+        ArrowColumn_py* col = columns[j];
+
+        ArrowSchema& cs = schemaParent->children[j];
+        std::string* name = new std::string(col->name);
+        cs.format = col->format;
+        cs.name = name->c_str();
+        cs.metadata = nullptr;
+        cs.flags = 0;
+        cs.n_children = 0;
+        cs.children = nullptr;
+        cs.dictionary = nullptr;
+        cs.release = &ArrowSchema_releaseChild;
+        cs.private_data = name;
+        schemaParent->childPtrs.push_back(&cs);
+
+        ArrowArray& ca = arrayParent->children[j];
+        ca.length = nbPts;
+        ca.null_count = 0;
+        ca.offset = 0;
+        ca.n_buffers = 2;
+        ca.n_children = 0;
+        ca.buffers = col->buffers;
+        ca.children = nullptr;
+        ca.dictionary = nullptr;
+        ca.release = &ArrowArray_releaseChild;
+        ca.private_data = col;
+        arrayParent->childPtrs.push_back(&ca);
+    }
+
+    schema->format = "+s";
+    schema->name = "";
+    schema->metadata = nullptr;
+    schema->flags = 0;
+    schema->n_children = nbCols;
+    schema->children = schemaParent->childPtrs.data();
+    schema->dictionary = nullptr;
+    schema->release = &ArrowSchema_release;
+    schema->private_data = schemaParent;
+
+    array->length = nbPts;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->n_children = nbCols;
+    array->buffers = arrayParent->buffers;
+    array->children = arrayParent->childPtrs.data();
+    array->dictionary = nullptr;
+    array->release = &ArrowArray_release;
+    array->private_data = arrayParent;
+
+    bp::object schemaCapsule(bp::handle<>(PyCapsule_New(schema, "arrow_schema", &ArrowSchema_capsuleDestructor)));
+    bp::object arrayCapsule(bp::handle<>(PyCapsule_New(array, "arrow_array", &ArrowArray_capsuleDestructor)));
+    CCTRACE("exported " << nbCols << " columns, " << nbPts << " rows");
+    return bp::make_tuple(schemaCapsule, arrayCapsule);
+}
+
+bp::tuple ccPointCloud_arrow_c_array_py(bp::object self, bp::object requested_schema)
+{
+    return ccPointCloud_toArrow_py(self);
+}
+
+// --- import
+
+//! moves the imported structures out of the capsules, and releases them at the end of the scope
+struct ArrowImport_guard
+{
+    ArrowSchema schema;
+    ArrowArray array;
+    ArrowImport_guard()
+    {
+        schema.release = nullptr;
+        array.release = nullptr;
+    }
+    ~ArrowImport_guard()
+    {
+        if (array.release)
+            array.release(&array);
+        if (schema.release)
+            schema.release(&schema);
+    }
+};
+
+typedef double (*ArrowReader_py)(const void* data, int64_t index);
+
+template<typename T> double ArrowRead_py(const void* data, int64_t index)
+{
+    return static_cast<double>(static_cast<const T*>(data)[index]);
+}
+
+//! reader for a primitive Arrow format, nullptr if not supported
+static ArrowReader_py ArrowReader_get(const char* format)
+{
+    if (!format || strlen(format) != 1)
+        return nullptr;
+    switch (format[0])
+    {
+    case 'c': return &ArrowRead_py<int8_t>;
+    case 'C': return &ArrowRead_py<uint8_t>;
+    case 's': return &ArrowRead_py<int16_t>;
+    case 'S': return &ArrowRead_py<uint16_t>;
+    case 'i': return &ArrowRead_py<int32_t>;
+    case 'I': return &ArrowRead_py<uint32_t>;
+    case 'l': return &ArrowRead_py<int64_t>;
+    case 'L': return &ArrowRead_py<uint64_t>;
+    case 'f': return &ArrowRead_py<float>;
+    case 'g': return &ArrowRead_py<double>;
+    default: return nullptr;
+    }
+}
+
+//! a readable imported column
+struct ArrowInput_py
+{
+    const void* data;
+    const uint8_t* validity;
+    int64_t offset;
+    ArrowReader_py read;
+
+    bool isValid(int64_t i) const
+    {
+        if (!validity)
+            return true;
+        int64_t j = i + offset;
+        return (validity[j >> 3] >> (j & 7)) & 1;
+    }
+
+    double value(int64_t i) const
+    {
+        return read(data, i + offset);
+    }
+
+    //! true if one of the n values is null
+    bool hasNulls(int64_t n) const
+    {
+        if (!validity)
+            return false;
+        for (int64_t i = 0; i < n; i++)
+            if (!isValid(i))
+                return true;
+        return false;
+    }
+};
+
+ccPointCloud* fromArrow_py(bp::object batch, const QString& name)
+{
+    bp::object capsules = batch;
+    if (PyObject_HasAttrString(batch.ptr(), "__arrow_c_array__"))
+        capsules = batch.attr("__arrow_c_array__")();
+    if (!PyTuple_Check(capsules.ptr()) || PyTuple_GET_SIZE(capsules.ptr()) != 2
+        || !PyCapsule_IsValid(PyTuple_GET_ITEM(capsules.ptr(), 0), "arrow_schema")
+        || !PyCapsule_IsValid(PyTuple_GET_ITEM(capsules.ptr(), 1), "arrow_array"))
+    {
+        PyErr_SetString(PyExc_TypeError, "an object with an __arrow_c_array__ method, or a pair of capsules (arrow_schema, arrow_array) is required");
+        bp::throw_error_already_set();
+    }
+
+    // move the structures: the capsules destructors will not release them
+    ArrowImport_guard guard;
+    ArrowSchema* schemaIn = static_cast<ArrowSchema*>(PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules.ptr(), 0), "arrow_schema"));
+    ArrowArray* arrayIn = static_cast<ArrowArray*>(PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules.ptr(), 1), "arrow_array"));
+    if (!schemaIn->release || !arrayIn->release)
+    {
+        PyErr_SetString(PyExc_ValueError, "Arrow capsules already consumed");
+        bp::throw_error_already_set();
+    }
+    guard.schema = *schemaIn;
+    schemaIn->release = nullptr;
+    guard.array = *arrayIn;
+    arrayIn->release = nullptr;
+    const ArrowSchema& schema = guard.schema;
+    const ArrowArray& array = guard.array;
+
+    if (strcmp(schema.format, "+s") != 0 || schema.n_children != array.n_children)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect Arrow data, a record batch (struct array) is required");
+        bp::throw_error_already_set();
+    }
+
+    // --- identify the columns
+    int coordCols[3] = { -1, -1, -1 };
+    int colorCols[4] = { -1, -1, -1, -1 };
+    int normalCols[3] = { -1, -1, -1 };
+    std::vector<int> sfCols;
+    std::vector<ArrowInput_py> inputs(schema.n_children);
+    std::vector<std::string> names(schema.n_children);
+    for (int64_t j = 0; j < schema.n_children; j++)
+    {
+        const ArrowSchema* cs = schema.children[j];
+        const ArrowArray* ca = array.children[j];
+        ArrowInput_py& in = inputs[j];
+        // the name is optional in the Arrow C data interface
+        names[j] = cs->name ? cs->name : "";
+        const std::string& colName = names[j];
+        in.read = ArrowReader_get(cs->format);
+        if (!in.read || ca->n_buffers != 2)
+        {
+            CCTRACE("column " << colName << " format " << cs->format << " not supported, ignored");
+            continue;
+        }
+        in.validity = (ca->null_count != 0) ? static_cast<const uint8_t*>(ca->buffers[0]) : nullptr;
+        in.data = ca->buffers[1];
+        in.offset = array.offset + ca->offset;
+
+        if (colName == "X" || colName == "x")
+            coordCols[0] = j;
+        else if (colName == "Y" || colName == "y")
+            coordCols[1] = j;
+        else if (colName == "Z" || colName == "z")
+            coordCols[2] = j;
+        else if (colName == "R" && cs->format[0] == 'C')
+            colorCols[0] = j;
+        else if (colName == "G" && cs->format[0] == 'C')
+            colorCols[1] = j;
+        else if (colName == "B" && cs->format[0] == 'C')
+            colorCols[2] = j;
+        else if (colName == "A" && cs->format[0] == 'C')
+            colorCols[3] = j;
+        else if (colName == "Nx")
+            normalCols[0] = j;
+        else if (colName == "Ny")
+            normalCols[1] = j;
+        else if (colName == "Nz")
+            normalCols[2] = j;
+        else
+            sfCols.push_back(j);
+    }
+    if (coordCols[0] < 0 || coordCols[1] < 0 || coordCols[2] < 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect Arrow data, numeric columns X, Y, Z are required");
+        bp::throw_error_already_set();
+    }
+    bool withColors = (colorCols[0] >= 0 && colorCols[1] >= 0 && colorCols[2] >= 0);
+    bool withNormals = (normalCols[0] >= 0 && normalCols[1] >= 0 && normalCols[2] >= 0);
+    if (!withColors)
+    {
+        for (int k = 0; k < 4; k++)
+            if (colorCols[k] >= 0)
+                sfCols.push_back(colorCols[k]);
+    }
+    if (!withNormals)
+    {
+        for (int k = 0; k < 3; k++)
+            if (normalCols[k] >= 0)
+                sfCols.push_back(normalCols[k]);
+    }
+
+    // --- one scalar field per name
+    std::vector<std::string> sfNames;
+    std::set<std::string> distinct;
+    for (int j : sfCols)
+    {
+        sfNames.push_back(names[j].empty() ? "column " + std::to_string(j) : names[j]);
+        if (!distinct.insert(sfNames.back()).second)
+        {
+            PyErr_Format(PyExc_ValueError, "Incorrect Arrow data, duplicate column %s", sfNames.back().c_str());
+            bp::throw_error_already_set();
+        }
+    }
+
+    // --- null values are only supported in scalar fields (NaN)
+    std::vector<int> denseCols(coordCols, coordCols + 3);
+    if (withColors)
+        denseCols.insert(denseCols.end(), colorCols, colorCols + 4);
+    if (withNormals)
+        denseCols.insert(denseCols.end(), normalCols, normalCols + 3);
+    for (int j : denseCols)
+    {
+        if (j >= 0 && inputs[j].hasNulls(array.length))
+        {
+            PyErr_Format(PyExc_ValueError, "Incorrect Arrow data, null values in column %s", names[j].c_str());
+            bp::throw_error_already_set();
+        }
+    }
+
+    // --- fill the cloud, each conversion in parallel
+    size_t nbPts = array.length;
+    ccPointCloud* cloud = new ccPointCloud(name);
+    if (!cloud->reserve(nbPts) || !cloud->resize(nbPts))
+    {
+        delete cloud;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (nbPts == 0)
+        return cloud;
+
+    const ArrowInput_py cx = inputs[coordCols[0]];
+    const ArrowInput_py cy = inputs[coordCols[1]];
+    const ArrowInput_py cz = inputs[coordCols[2]];
+    PointCoordinateType* d = (PointCoordinateType*)cloud->getPoint(0);
+    pyCC_ParallelFor(nbPts, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            d[3*i]   = static_cast<PointCoordinateType>(cx.value(i));
+            d[3*i+1] = static_cast<PointCoordinateType>(cy.value(i));
+            d[3*i+2] = static_cast<PointCoordinateType>(cz.value(i));
+        }
+    });
+    cloud->invalidateBoundingBox();
+
+    if (withColors && !cloud->resizeTheRGBTable(false))
+    {
+        delete cloud;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (withColors)
+    {
+        ccColor::Rgba* rgba = cloud->rgbaColors()->data();
+        ArrowInput_py c[4];
+        for (int k = 0; k < 4; k++)
+            c[k] = (colorCols[k] >= 0) ? inputs[colorCols[k]] : ArrowInput_py();
+        bool withAlpha = (colorCols[3] >= 0);
+        pyCC_ParallelFor(nbPts, [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                rgba[i] = ccColor::Rgba(static_cast<ColorCompType>(c[0].value(i)),
+                                        static_cast<ColorCompType>(c[1].value(i)),
+                                        static_cast<ColorCompType>(c[2].value(i)),
+                                        withAlpha ? static_cast<ColorCompType>(c[3].value(i)) : ccColor::MAX);
+            }
+        });
+        cloud->showColors(true);
+    }
+
+    if (withNormals && !cloud->resizeTheNormsTable())
+    {
+        delete cloud;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (withNormals)
+    {
+        NormsIndexesTableType* normals = cloud->normals();
+        const ArrowInput_py nx = inputs[normalCols[0]];
+        const ArrowInput_py ny = inputs[normalCols[1]];
+        const ArrowInput_py nz = inputs[normalCols[2]];
+        pyCC_ParallelFor(nbPts, [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                CCVector3 N(static_cast<PointCoordinateType>(nx.value(i)),
+                            static_cast<PointCoordinateType>(ny.value(i)),
+                            static_cast<PointCoordinateType>(nz.value(i)));
+                normals->setValue(i, ccNormalVectors::GetNormIndex(N));
+            }
+        });
+        cloud->showNormals(true);
+    }
+
+    for (size_t k = 0; k < sfCols.size(); k++)
+    {
+        int j = sfCols[k];
+        int sfIdx = cloud->addScalarField(sfNames[k].c_str());
+        if (sfIdx < 0)
+        {
+            delete cloud;
+            PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+            bp::throw_error_already_set();
+        }
+        CCCoreLib::ScalarField* sf = cloud->getScalarField(sfIdx);
+        ScalarType* v = sf->data();
+        const ArrowInput_py in = inputs[j];
+        pyCC_ParallelFor(nbPts, [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                v[i] = in.isValid(i) ? static_cast<ScalarType>(in.value(i)) : CCCoreLib::NAN_VALUE;
+        });
+        sf->computeMinAndMax();
+    }
+    CCTRACE("fromArrow: " << nbPts << " points, " << cloud->getNumberOfScalarFields() << " scalar fields");
+    return cloud;
+}
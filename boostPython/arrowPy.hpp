@@ -0,0 +1,85 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef ARROWPY_HPP_
+#define ARROWPY_HPP_
+
+#include <boost/python.hpp>
+#include <cstdint>
+
+#include <QString>
+
+class ccPointCloud;
+
+// --- Arrow C Data Interface ABI (https://arrow.apache.org/docs/format/CDataInterface.html).
+// The layout of these structures must not be modified: they are shared with the Arrow implementations.
+
+extern "C"
+{
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+    struct ArrowSchema
+    {
+        const char* format;
+        const char* name;
+        const char* metadata;
+        int64_t flags;
+        int64_t n_children;
+        struct ArrowSchema** children;
+        struct ArrowSchema* dictionary;
+        void (*release)(struct ArrowSchema*);
+        void* private_data;
+    };
+
+    struct ArrowArray
+    {
+        int64_t length;
+        int64_t null_count;
+        int64_t offset;
+        int64_t n_buffers;
+        int64_t n_children;
+        const void** buffers;
+        struct ArrowArray** children;
+        struct ArrowArray* dictionary;
+        void (*release)(struct ArrowArray*);
+        void* private_data;
+    };
+
+#endif // ARROW_C_DATA_INTERFACE
+}
+
+//! export the cloud as an Arrow record batch: a pair of PyCapsules ("arrow_schema", "arrow_array")
+/*! Columns: X, Y, Z, then the scalar fields, R, G, B, A if the cloud has colors, Nx, Ny, Nz if it has normals.
+ *  Scalar fields are exported without copy (C++ keeps the ownership, as with toNpArray),
+ *  interleaved coordinates, colors and compressed normals are converted in parallel.
+ */
+boost::python::tuple ccPointCloud_toArrow_py(boost::python::object self);
+
+//! Arrow PyCapsule interface, same as ccPointCloud_toArrow_py (the requested schema is ignored)
+boost::python::tuple ccPointCloud_arrow_c_array_py(boost::python::object self,
+                                                   boost::python::object requested_schema = boost::python::object());
+
+//! create a new cloud from an Arrow record batch (object with __arrow_c_array__, or pair of capsules)
+ccPointCloud* fromArrow_py(boost::python::object batch, const QString& name = QString());
+
+#endif
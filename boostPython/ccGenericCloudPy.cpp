@@ -27,15 +27,74 @@
 #include <GenericProgressCallback.h>
 #include <CCGeom.h>
 
+#include "contentVersionPy.hpp"
+#include "kdTreePy.hpp"
+#include "octreeIOPy.hpp"
 #include "pyccTrace.h"
 #include "ccGenericCloudPy_DocStrings.hpp"
 
+#include <algorithm>
+#include <string>
+
 namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
 
 using namespace boost::python;
 
+std::vector<unsigned> indexesFromNpArray(bnp::ndarray const& array, unsigned cloudSize)
+{
+    if (array.get_nd() != 1)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array dimension, one dimension required");
+        bp::throw_error_already_set();
+    }
+    size_t n = array.shape(0);
+    std::vector<unsigned> indexes;
+    if (array.get_dtype() == bnp::dtype::get_builtin<bool>())
+    {
+        if (n != cloudSize)
+        {
+            PyErr_SetString(PyExc_ValueError, "Incorrect mask size, should be the cloud size");
+            bp::throw_error_already_set();
+        }
+        bnp::ndarray mask = (array.get_flags() & bnp::ndarray::C_CONTIGUOUS) ? array : array.copy();
+        const bool* m = reinterpret_cast<const bool*>(mask.get_data());
+        size_t count = std::count(m, m + n, true);
+        indexes.reserve(count);
+        for (size_t i = 0; i < n; i++)
+            if (m[i])
+                indexes.push_back(static_cast<unsigned>(i));
+        return indexes;
+    }
+    std::string kind = bp::extract<std::string>(array.get_dtype().attr("kind"));
+    if (kind != "i" && kind != "u")
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array data type, integers or booleans required");
+        bp::throw_error_already_set();
+    }
+    bnp::dtype dt = bnp::dtype::get_builtin<int64_t>();
+    bnp::ndarray idx = ((array.get_dtype() == dt) && (array.get_flags() & bnp::ndarray::C_CONTIGUOUS)) ? array : array.astype(dt);
+    const int64_t* s = reinterpret_cast<const int64_t*>(idx.get_data());
+    indexes.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (s[i] < 0 || s[i] >= cloudSize)
+        {
+            PyErr_Format(PyExc_IndexError, "index %lld out of range [0, %u[", static_cast<long long>(s[i]), cloudSize);
+            bp::throw_error_already_set();
+        }
+        indexes[i] = static_cast<unsigned>(s[i]);
+    }
+    return indexes;
+}
+
 CCVector3 PointCloudTpl_ccGenericPointCloud_QString_getPoint_py(CCCoreLib::PointCloudTpl<ccGenericPointCloud, QString>& self, unsigned index)
 {
+    if (index >= self.size())
+    {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        bp::throw_error_already_set();
+    }
     const CCVector3* vec = self.getPoint(index);
     return *vec;
 }
@@ -64,13 +123,64 @@ CCVector3 ReferenceCloud_getNextPoint(CCCoreLib::ReferenceCloud& self)
 
 CCVector3 ReferenceCloud_getPoint(CCCoreLib::ReferenceCloud& self, unsigned index)
 {
+    if (index >= self.size())
+    {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        bp::throw_error_already_set();
+    }
     const CCVector3* vec = self.getPoint(index);
     return *vec;
 }
 
+CCVector3d ccShiftedObject_getGlobalShift_py(ccShiftedObject& self)
+{
+    return self.getGlobalShift();
+}
+
+void ccShiftedObject_setGlobalShift_py(ccShiftedObject& self, const CCVector3d& shift)
+{
+    self.setGlobalShift(shift);
+}
+
+CCCoreLib::ReferenceCloud* ReferenceCloud_fromIndices_py(CCCoreLib::GenericIndexedCloudPersist* cloud, bnp::ndarray const& array)
+{
+    if (!cloud)
+    {
+        PyErr_SetString(PyExc_ValueError, "a cloud is required");
+        bp::throw_error_already_set();
+    }
+    std::vector<unsigned> indexes = indexesFromNpArray(array, cloud->size());
+    CCCoreLib::ReferenceCloud* ref = new CCCoreLib::ReferenceCloud(cloud);
+    if (!ref->resize(static_cast<unsigned>(indexes.size())))
+    {
+        delete ref;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    for (unsigned i = 0; i < indexes.size(); i++)
+        ref->setPointIndex(i, indexes[i]);
+    CCTRACE("ReferenceCloud fromIndices: " << ref->size());
+    return ref;
+}
+
+bnp::ndarray ReferenceCloud_toIndices_py(CCCoreLib::ReferenceCloud& self)
+{
+    unsigned n = self.size();
+    bnp::ndarray result = bnp::empty(bp::make_tuple(n), bnp::dtype::get_builtin<unsigned>());
+    unsigned* d = reinterpret_cast<unsigned*>(result.get_data());
+    for (unsigned i = 0; i < n; i++)
+        d[i] = self.getPointGlobalIndex(i);
+    return result;
+}
+
 CCCoreLib::GenericIndexedCloudPersist* (CCCoreLib::ReferenceCloud::*getAssCloud1)() = &CCCoreLib::ReferenceCloud::getAssociatedCloud;
 
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ccGenericPointCloud_computeOctree_overloads, computeOctree, 0, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_computeKDTree_py_overloads, ccGenericPointCloud_computeKDTree_py, 1, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_computeOctree_py_overloads, ccGenericPointCloud_computeOctree_py, 1, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_knn_py_overloads, ccGenericPointCloud_knn_py, 3, 6)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_loadOctree_py_overloads, ccGenericPointCloud_loadOctree_py, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_updateOctree_py_overloads, ccGenericPointCloud_updateOctree_py, 1, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccGenericPointCloud_radiusSearch_py_overloads, ccGenericPointCloud_radiusSearch_py, 3, 4)
 
 void export_ccGenericCloud()
 {
@@ -80,15 +190,41 @@ void export_ccGenericCloud()
         ;
 
     class_<ccShiftedObject, bases<ccHObject>, boost::noncopyable>("ccShiftedObject", no_init)
+        .def("getGlobalScale", &ccShiftedObject::getGlobalScale, ccShiftedObject_getGlobalScale_doc)
+        .def("getGlobalShift", &ccShiftedObject_getGlobalShift_py, ccShiftedObject_getGlobalShift_doc)
+        .def("isShifted", &ccShiftedObject::isShifted, ccShiftedObject_isShifted_doc)
+        .def("setGlobalScale", &ccShiftedObject::setGlobalScale, ccShiftedObject_setGlobalScale_doc)
+        .def("setGlobalShift", &ccShiftedObject_setGlobalShift_py, ccShiftedObject_setGlobalShift_doc)
         ;
 
     class_<CCCoreLib::GenericIndexedCloudPersist, boost::noncopyable>("GenericIndexedCloudPersist", no_init)
         ;
 
     class_<ccGenericPointCloud, bases<CCCoreLib::GenericIndexedCloudPersist, ccShiftedObject>, boost::noncopyable>("ccGenericPointCloud", no_init)
-        .def("computeOctree", &ccGenericPointCloud::computeOctree, ccGenericPointCloud_computeOctree_overloads(ccGenericPointCloud_computeOctree_doc))
+        .def("computeKDTree", &ccGenericPointCloud_computeKDTree_py,
+             ccGenericPointCloud_computeKDTree_py_overloads(args("self", "leafSize", "maxThreadCount"),
+                                                            ccGenericPointCloud_computeKDTree_doc))
+        .def("computeOctree", &ccGenericPointCloud_computeOctree_py,
+             ccGenericPointCloud_computeOctree_py_overloads(args("self", "progressCb", "autoAddChild", "maxThreadCount"),
+                                                            ccGenericPointCloud_computeOctree_doc))
         .def("getOctree", &ccGenericPointCloud::getOctree, ccGenericPointCloud_getOctree_doc)
+        .def("deleteKDTree", &ccGenericPointCloud_deleteKDTree_py, ccGenericPointCloud_deleteKDTree_doc)
         .def("deleteOctree", &ccGenericPointCloud::deleteOctree, ccGenericPointCloud_deleteOctree_doc)
+        .def("getContentHash", &ccGenericPointCloud_contentHash_py, ccGenericPointCloud_getContentHash_doc)
+        .def("getContentVersion", &ccGenericPointCloud_getContentVersion_py, ccGenericPointCloud_getContentVersion_doc)
+        .def("getKDTree", &ccGenericPointCloud_getKDTree_py, ccGenericPointCloud_getKDTree_doc)
+        .def("knn", &ccGenericPointCloud_knn_py,
+             ccGenericPointCloud_knn_py_overloads(args("self", "queryPoints", "k", "maxDist", "backend", "epsilon"),
+                                                  ccGenericPointCloud_knn_doc))
+        .def("loadOctree", &ccGenericPointCloud_loadOctree_py,
+             ccGenericPointCloud_loadOctree_py_overloads(args("self", "filename", "autoAddChild"), ccGenericPointCloud_loadOctree_doc))
+        .def("radiusSearch", &ccGenericPointCloud_radiusSearch_py,
+             ccGenericPointCloud_radiusSearch_py_overloads(args("self", "queryPoints", "radius", "backend"),
+                                                           ccGenericPointCloud_radiusSearch_doc))
+        .def("saveOctree", &ccGenericPointCloud_saveOctree_py, ccGenericPointCloud_saveOctree_doc)
+        .def("updateOctree", &ccGenericPointCloud_updateOctree_py,
+             ccGenericPointCloud_updateOctree_py_overloads(args("self", "progressCb", "autoAddChild", "maxThreadCount"),
+                                                           ccGenericPointCloud_updateOctree_doc))
         ;
 
     class_<CCCoreLib::PointCloudTpl<ccGenericPointCloud, QString>, bases<ccGenericPointCloud>, boost::noncopyable>("PointCloudTpl_ccGenericPointCloud_QString", no_init)
@@ -99,6 +235,8 @@ void export_ccGenericCloud()
                                                                                      init<CCCoreLib::GenericIndexedCloudPersist*>())
         .def("enableScalarField", &CCCoreLib::ReferenceCloud::enableScalarField, ReferenceCloud_enableScalarField_doc)
         .def("forwardIterator", &CCCoreLib::ReferenceCloud::forwardIterator, ReferenceCloud_forwardIterator_doc)
+        .def("fromIndices", &ReferenceCloud_fromIndices_py, return_value_policy<manage_new_object>(), ReferenceCloud_fromIndices_doc)
+            .staticmethod("fromIndices")
         .def("getAssociatedCloud", getAssCloud1, return_value_policy<reference_existing_object>(), ReferenceCloud_getAssociatedCloud_doc)
         .def("getBoundingBox", &ReferenceCloud_getBoundingBox_py, ReferenceCloud_getBoundingBox_doc)
         .def("getCurrentPointCoordinates", &ReferenceCloud_getCurrentPointCoordinates,
@@ -118,8 +256,9 @@ void export_ccGenericCloud()
              ReferenceCloud_setCurrentPointScalarValue_doc)
         .def("setPointScalarValue", &CCCoreLib::ReferenceCloud::setPointScalarValue, ReferenceCloud_setPointScalarValue_doc)
         .def("size", &CCCoreLib::ReferenceCloud::size, ReferenceCloud_size_doc)
+        .def("toIndices", &ReferenceCloud_toIndices_py, ReferenceCloud_toIndices_doc)
         ;
 
-    // TODO: some methods may lead to abort: for instance getPoint with bad index
+    // TODO: some methods may lead to abort: for instance getPointScalarValue with bad index
 }
 
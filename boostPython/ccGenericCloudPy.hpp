@@ -19,6 +19,14 @@
 #ifndef CCGENERICCLOUDPY_HPP_
 #define CCGENERICCLOUDPY_HPP_
 
+#include <boost/python/numpy.hpp>
+#include <vector>
+
+//! global indexes given by a numpy array: integers (any integer type), or a boolean mask of size cloudSize
+/*! raises a Python TypeError on bad array types, IndexError on out of range indexes
+ */
+std::vector<unsigned> indexesFromNpArray(boost::python::numpy::ndarray const& array, unsigned cloudSize);
+
 void export_ccGenericCloud();
 
 #endif
@@ -30,6 +30,41 @@ Get the name of the entity
 :return: entity name
 :rtype: str)";
 
+const char* ccShiftedObject_getGlobalScale_doc= R"(
+Returns the scale applied to original coordinates.
+
+:return: global scale
+:rtype: float)";
+
+const char* ccShiftedObject_getGlobalShift_doc= R"(
+Returns the shift applied to original coordinates.
+
+Global coordinates are obtained with: Pglobal = Plocal/globalScale - globalShift
+
+:return: global shift (x, y, z)
+:rtype: tuple)";
+
+const char* ccShiftedObject_isShifted_doc= R"(
+Returns whether the cloud is shifted or not.
+
+:return: `True` if the global shift is not null or the global scale is not 1.
+:rtype: bool)";
+
+const char* ccShiftedObject_setGlobalScale_doc= R"(
+Sets the scale applied to original coordinates (information storage only).
+
+The coordinates stored in the cloud are not modified.
+
+:param float scale: global scale)";
+
+const char* ccShiftedObject_setGlobalShift_doc= R"(
+Sets the shift applied to original coordinates (information storage only).
+
+The coordinates stored in the cloud are not modified.
+Such a shift can typically be applied at loading time (see :py:func:`loadPointCloud`).
+
+:param tuple shift: global shift (x, y, z))";
+
 const char* ccGenericPointCloud_computeOctree_doc= R"(
 Computes the cloud octree.
 
@@ -39,24 +74,159 @@ The octree bounding-box is automatically defined as the smallest
 WARNING: any previously attached octree will be deleted,
 even if the new octree computation failed.
 
-:param progressCb: (default None), use None
+The build is multithreaded: the cell codes of the points are computed by chunks in parallel,
+then sorted with a parallel radix sort. The octree is identical to the sequential build:
+the points with NaN coordinates are not projected in the octree.
+With `maxThreadCount=1` or a progress callback, the sequential CloudCompare build is used.
+
+:param progressCb: (default None), progress callback, used only by the sequential build
 :param bool,optional autoAddChild: (default `True`) whether to automatically add the computed octree as child of this cloud or not
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores, 1 for the sequential build
 
 :return: the computed octree
 :rtype: ccOctree)";
 
+const char* ccGenericPointCloud_computeKDTree_doc= R"(
+Computes a KD-tree index of the cloud, attached as a child of the cloud, next to the octree.
+
+The KD-tree is an alternative to the octree for kNN queries on clouds with highly varying densities,
+see :py:class:`ccKDTree`. Any previous KD-tree of the cloud is deleted.
+The subtrees are built in parallel.
+
+:param int,optional leafSize: (default 16) maximum number of points in a leaf
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores
+
+:return: the KD-tree, None if the cloud is empty or if there is not enough memory
+:rtype: ccKDTree)";
+
+const char* ccGenericPointCloud_deleteKDTree_doc= R"(
+Erases the KD-tree, if any)";
+
 const char* ccGenericPointCloud_deleteOctree_doc= R"(
 Erases the octree)";
 
+const char* ccGenericPointCloud_getKDTree_doc= R"(
+Returns the KD-tree of the cloud (if any), see :py:meth:`computeKDTree`.
+
+:return: KD-tree
+:rtype: ccKDTree or None)";
+
+const char* ccGenericPointCloud_knn_doc= R"(
+Finds the k nearest neighbours of a set of query points, with the spatial index chosen per call.
+
+- `"octree"`: the octree of the cloud, computed if needed, see :py:meth:`ccOctree.knn`.
+  Efficient on rather uniform densities, and when the octree is needed by other processings.
+- `"kdtree"`: the KD-tree of the cloud, computed if needed, see :py:meth:`ccKDTree.knn`.
+  Efficient on highly varying densities (terrestrial scans).
+- `"auto"`: the KD-tree if the cloud has one, else the octree.
+
+With epsilon > 0, the search is approximate (see :py:meth:`ccKDTree.knn`): it requires the KD-tree,
+computed if needed with "auto", a ValueError is raised with "octree".
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param int k: number of neighbours
+:param float,optional maxDist: (default 0) the maximum search distance (ignored if <= 0)
+:param str,optional backend: (default "auto") "auto", "octree" or "kdtree"
+:param float,optional epsilon: (default 0) the approximation factor, 0 for an exact search
+
+:return: tuple (indexes, squareDistances) of numpy arrays of shape (N,k), int64 and float64,
+         sorted by increasing distance, padded with -1 and inf.
+:rtype: tuple)";
+
+const char* ccGenericPointCloud_radiusSearch_doc= R"(
+Finds the points within a radius of a set of query points, with the spatial index chosen per call.
+
+The backend is chosen as in :py:meth:`knn`.
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param float radius: the search radius
+:param str,optional backend: (default "auto") "auto", "octree" or "kdtree"
+
+:return: tuple (offsets, indexes, squareDistances) of numpy arrays in CSR layout,
+         see :py:meth:`ccOctree.radiusSearch`.
+:rtype: tuple)";
+
 const char* ccGenericPointCloud_getOctree_doc= R"(
 Returns the associated octree (if any).
 
+The octree is dropped when the coordinates are modified through the cloud methods
+(see :py:meth:`getContentVersion`): use :py:meth:`updateOctree` to get an octree in any case.
+
 :return: octree
 :rtype: ccOctree or None)";
 
+const char* ccGenericPointCloud_getContentHash_doc= R"(
+Returns a hash of the cloud coordinates, computed in parallel.
+
+Used to check that a saved octree (see :py:meth:`saveOctree`) still matches the cloud.
+
+:return: 64 bits hash of the coordinates
+:rtype: int)";
+
+const char* ccGenericPointCloud_getContentVersion_doc= R"(
+Returns the content version of the cloud, incremented at each modification of the coordinates
+done through CloudComPy: :py:meth:`~.ccPointCloud.coordsFromNPArray_copy`, :py:meth:`~.ccPointCloud.fromNpArrayGlobal`,
+:py:meth:`~.ccPointCloud.translate`, :py:meth:`~.ccPointCloud.scale`, :py:meth:`~.ccPointCloud.applyRigidTransformation`,
+:py:meth:`~.ccPointCloud.resize`, :py:meth:`~.ccPointCloud.fuse`, :py:meth:`~.ccPointCloud.reorderSpatially`,
+the release of a modified array given by :py:meth:`~.ccPointCloud.toNpArray`,
+or :py:meth:`~.ccPointCloud.notifyGeometryUpdate`.
+
+Each modification drops the structures built on the coordinates (octree, KD-tree),
+except the transformations that preserve the octree cells (translation, uniform scale):
+the octree bounding box is then updated instead.
+The version can be used to invalidate caches of derived data kept on the Python side.
+It starts at 0, and is stored in the cloud metadata: it is saved in BIN files and restored on load.
+
+:return: the content version
+:rtype: int)";
+
+const char* ccGenericPointCloud_loadOctree_doc= R"(
+Loads an octree saved with :py:meth:`saveOctree`, instead of computing it.
+
+The cell codes are read as they were saved, without computation nor sort.
+The octree is loaded only if the file matches the cloud: same number of points, same coordinates
+(checked with :py:meth:`getContentHash`), same build options of CloudComPy.
+The cell data is also checked (point indexes within the cloud, each point once, sorted codes, finite bounds),
+so that a corrupted file is rejected.
+The loaded octree replaces the current octree of the cloud.
+
+:param str filename: the octree file
+:param bool,optional autoAddChild: (default `True`) whether to add the octree as child of this cloud or not
+
+:return: `True` if the octree is loaded, `False` if the file is missing, corrupted or does not match the cloud
+:rtype: bool)";
+
+const char* ccGenericPointCloud_saveOctree_doc= R"(
+Saves the octree of the cloud in a file, to be reloaded later with :py:meth:`loadOctree`,
+for instance next to the cloud file.
+
+The file contains the octree bounds, the cell codes and index mapping, and the cloud content hash.
+A ValueError is raised if the cloud has no octree (see :py:meth:`computeOctree`).
+
+:param str filename: the octree file
+
+:return: `True` if the file is written
+:rtype: bool)";
+
+const char* ccGenericPointCloud_updateOctree_doc= R"(
+Returns the octree of the cloud, computed only if it is missing (never computed, or dropped
+by a modification of the coordinates, see :py:meth:`getContentVersion`).
+
+Use it instead of :py:meth:`deleteOctree` + :py:meth:`computeOctree` before each use.
+Same parameters as :py:meth:`computeOctree`, used only if the octree is computed.
+
+:param progressCb: (default None), progress callback, used only by the sequential build
+:param bool,optional autoAddChild: (default `True`) whether to automatically add the computed octree as child of this cloud or not
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores, 1 for the sequential build
+
+:return: octree, None if the computation failed
+:rtype: ccOctree)";
+
 const char* PointCloudTpl_ccGenericPointCloud_QString_getPoint_doc= R"(
 get the ith point in the cloud array.
 
+An IndexError is raised if the index is out of range.
+
 :return: point coordinates
 :rtype: tuple)";
 
@@ -91,6 +261,23 @@ The scalar field will be reserved with the same capacity as the cloud.
 const char* ReferenceCloud_forwardIterator_doc= R"(
 Forwards the local element iterator.)";
 
+const char* ReferenceCloud_fromIndices_doc= R"(
+Creates a ReferenceCloud on a cloud, from a numpy array of global indexes, in one call.
+
+The array can be:
+
+- a one dimension array of integers (any integer type): the global indexes of the selected points,
+- a boolean mask of the cloud size: the selected points are the ones set to `True`.
+
+Each index is checked, an IndexError is raised if an index is out of range.
+A ValueError is raised if the cloud is None.
+
+:param GenericIndexedCloudPersist cloud: the associated cloud
+:param ndarray indexes: integer indexes or boolean mask
+
+:return: a new ReferenceCloud (owned by Python)
+:rtype: ReferenceCloud)";
+
 const char* ReferenceCloud_getAssociatedCloud_doc= R"(
 Returns the associated (source) cloud.
 
@@ -160,7 +347,7 @@ GenericIndexedCloudPersist class.
 
 :param int index: index of the requested point (between 0 and the cloud size minus 1)
 
-:return: the requested point coordinates (undefined behavior if index is invalid)
+:return: the requested point coordinates (IndexError if index is invalid)
 :rtype: tuple)";
 
 const char* ReferenceCloud_getPointGlobalIndex_doc= R"(
@@ -208,6 +395,12 @@ Returns the number of points in the cloud
 :return: number of points
 :rtype: int)";
 
+const char* ReferenceCloud_toIndices_doc= R"(
+Returns all the global indexes of the ReferenceCloud in a numpy array, in one call.
+
+:return: global indexes, a new numpy array of uint32 owned by Python
+:rtype: ndarray)";
+
 // const char* = R"()";
 
 #endif /* CCGENERICCLOUDPY_DOCSTRINGS_HPP_ */
@@ -19,6 +19,7 @@
 #include "ccOctreePy.hpp"
 
 #include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
 
 #include <DgmOctree.h>
 
@@ -29,11 +30,22 @@
 #include "ccOctreePy_DocStrings.hpp"
 
 #include "PyScalarType.h"
+#include "cellKernelsPy.hpp"
+#include "gilPy.hpp"
+#include "knnGraphPy.hpp"
+#include "neighboursPy.hpp"
+#include "pyccParallel.h"
 #include "pyccTrace.h"
 #include <QObject>
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+
 
 namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
 
 using namespace boost::python;
 
@@ -309,10 +321,301 @@ bp::tuple DgmOctree_getTheCellPosWhichIncludesThePointLI_py(CCCoreLib::DgmOctree
     return bp::make_tuple(cellPos, inBounds);
 }
 
+std::vector<unsigned> DgmOctree_queryOrder_py(const CCCoreLib::DgmOctree& octree,
+                                              const std::vector<CCVector3>& points,
+                                              unsigned char level)
+{
+    size_t n = points.size();
+    const int maxPos = (1 << level) - 1;
+    std::vector<CCCoreLib::DgmOctree::CellCode> codes(n);
+    pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            Tuple3i pos;
+            bool inBounds;
+            octree.getTheCellPosWhichIncludesThePoint(&points[i], pos, level, inBounds);
+            for (int d = 0; d < 3; d++)
+                pos.u[d] = std::min(std::max(pos.u[d], 0), maxPos);
+            codes[i] = CCCoreLib::DgmOctree::GenerateTruncatedCellCode(pos, level);
+        }
+    });
+    std::vector<unsigned> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&codes](unsigned a, unsigned b) { return codes[a] < codes[b]; });
+    return order;
+}
+
+bp::tuple DgmOctree_knn_py(CCCoreLib::DgmOctree& self,
+                           bnp::ndarray const& queryPoints,
+                           unsigned k,
+                           double maxDist,
+                           unsigned char level)
+{
+    if (k == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "k must be at least 1");
+        bp::throw_error_already_set();
+    }
+    if (level > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL)
+    {
+        PyErr_SetString(PyExc_ValueError, "level out of range");
+        bp::throw_error_already_set();
+    }
+    CCCoreLib::GenericIndexedCloudPersist* cloud = self.associatedCloud();
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    size_t n = points.size();
+    if (level == 0)
+        level = self.findBestLevelForAGivenPopulationPerCell(std::max(k, 3u));
+    std::vector<unsigned> order;
+    {
+        GILRelease_py noGIL;
+        order = DgmOctree_queryOrder_py(self, points, level);
+    }
+    bp::tuple res = knnArrays_py(n, k, order, [&]()
+    {
+        // one neighbourhood per thread
+        std::shared_ptr<CCCoreLib::ReferenceCloud> Yk(new CCCoreLib::ReferenceCloud(cloud));
+        return [&self, &points, cloud, k, level, maxDist, Yk](size_t i, std::vector<Neighbour_py>& neighbours)
+        {
+            Yk->clear(false);
+            double maxSquareDist = 0;
+            int found = self.findPointNeighbourhood(&points[i], Yk.get(), k, level, maxSquareDist, maxDist);
+            unsigned nbFound = std::min(static_cast<unsigned>(std::max(found, 0)), std::min(k, Yk->size()));
+            for (unsigned j = 0; j < nbFound; j++)
+            {
+                unsigned index = Yk->getPointGlobalIndex(j);
+                neighbours.emplace_back((*cloud->getPoint(index) - points[i]).norm2d(), index);
+            }
+        };
+    });
+    CCTRACE("knn: " << n << " queries, k=" << k << ", level " << static_cast<int>(level));
+    return res;
+}
+
+//! neighbourhood searches for many query points, result in CSR arrays (offsets, indexes, squareDistances)
+/*! search(center, neighbours) fills the neighbours of one query, it must be thread safe.
+ *  The queries are run in parallel by cell order, see csrArrays_py.
+ */
+template<typename Search> bp::tuple DgmOctree_csrSearch_py(CCCoreLib::DgmOctree& self,
+                                                          const std::vector<CCVector3>& points,
+                                                          unsigned char level,
+                                                          Search search)
+{
+    size_t n = points.size();
+    CCCoreLib::GenericIndexedCloudPersist* cloud = self.associatedCloud();
+    std::vector<unsigned> order;
+    {
+        GILRelease_py noGIL;
+        order = DgmOctree_queryOrder_py(self, points, level);
+    }
+    bp::tuple res = csrArrays_py(n, order, [&]()
+    {
+        // one neighbours set per thread
+        std::shared_ptr<CCCoreLib::DgmOctree::NeighboursSet> found(new CCCoreLib::DgmOctree::NeighboursSet);
+        return [&points, &search, cloud, found](size_t i, std::vector<Neighbour_py>& neighbours)
+        {
+            found->clear();
+            search(points[i], *found);
+            for (const CCCoreLib::DgmOctree::PointDescriptor& p : *found)
+                neighbours.emplace_back((*cloud->getPoint(p.pointIndex) - points[i]).norm2d(), p.pointIndex);
+            std::sort(neighbours.begin(), neighbours.end());
+        };
+    });
+    CCTRACE("neighbourhood search: " << n << " queries, level " << static_cast<int>(level));
+    return res;
+}
+
+unsigned char DgmOctree_searchLevel_py(CCCoreLib::DgmOctree& self, double radius, unsigned char level)
+{
+    if (level > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL)
+    {
+        PyErr_SetString(PyExc_ValueError, "level out of range");
+        bp::throw_error_already_set();
+    }
+    if (!(radius > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "search size must be strictly positive");
+        bp::throw_error_already_set();
+    }
+    if (level == 0)
+        level = self.findBestLevelForAGivenNeighbourhoodSizeExtraction(static_cast<PointCoordinateType>(radius));
+    return level;
+}
+
+bp::tuple DgmOctree_radiusSearch_py(CCCoreLib::DgmOctree& self,
+                                    bnp::ndarray const& queryPoints,
+                                    double radius,
+                                    unsigned char level)
+{
+    level = DgmOctree_searchLevel_py(self, radius, level);
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    const PointCoordinateType r = static_cast<PointCoordinateType>(radius);
+    return DgmOctree_csrSearch_py(self, points, level,
+                                  [&self, r, level](const CCVector3& center, CCCoreLib::DgmOctree::NeighboursSet& neighbours)
+    {
+        self.getPointsInSphericalNeighbourhood(center, r, neighbours, level);
+    });
+}
+
+bp::tuple DgmOctree_boxSearch_py(CCCoreLib::DgmOctree& self,
+                                 bnp::ndarray const& queryPoints,
+                                 CCVector3 dimensions,
+                                 unsigned char level = 0)
+{
+    level = DgmOctree_searchLevel_py(self, std::max(dimensions.x, std::max(dimensions.y, dimensions.z)) / 2, level);
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    return DgmOctree_csrSearch_py(self, points, level,
+                                  [&self, dimensions, level](const CCVector3& center, CCCoreLib::DgmOctree::NeighboursSet& neighbours)
+    {
+        CCCoreLib::DgmOctree::BoxNeighbourhood box;
+        box.center = center;
+        box.dimensions = dimensions;
+        box.level = level;
+        self.getPointsInBoxNeighbourhood(box);
+        neighbours.swap(box.neighbours);
+    });
+}
+
+bp::tuple DgmOctree_cylinderSearch_py(CCCoreLib::DgmOctree& self,
+                                      bnp::ndarray const& queryPoints,
+                                      CCVector3 dir,
+                                      double radius,
+                                      double halfLength,
+                                      unsigned char level = 0)
+{
+    level = DgmOctree_searchLevel_py(self, radius, level);
+    if (dir.norm2() == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "null cylinder direction");
+        bp::throw_error_already_set();
+    }
+    dir.normalize();
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    const PointCoordinateType r = static_cast<PointCoordinateType>(radius);
+    const PointCoordinateType h = static_cast<PointCoordinateType>(halfLength);
+    return DgmOctree_csrSearch_py(self, points, level,
+                                  [&self, dir, r, h, level](const CCVector3& center, CCCoreLib::DgmOctree::NeighboursSet& neighbours)
+    {
+        CCCoreLib::DgmOctree::CylindricalNeighbourhood cyl;
+        cyl.center = center;
+        cyl.dir = dir;
+        cyl.radius = r;
+        cyl.maxHalfLength = h;
+        cyl.level = level;
+        self.getPointsInCylindricalNeighbourhood(cyl);
+        neighbours.swap(cyl.neighbours);
+    });
+}
+
+std::vector<size_t> DgmOctree_cellStarts_py(const CCCoreLib::DgmOctree& self, unsigned char level)
+{
+    const CCCoreLib::DgmOctree::cellsContainer& cells = self.pointsAndTheirCellCodes();
+    size_t n = cells.size();
+    const unsigned char shift = CCCoreLib::DgmOctree::GET_BIT_SHIFT(level);
+    auto isStart = [&cells, shift](size_t i)
+    {
+        return i == 0 || (cells[i].theCode >> shift) != (cells[i - 1].theCode >> shift);
+    };
+    // the starts are numbered by per chunk prefix sums
+    std::vector<pyCC_Range> ranges = pyCC_SplitRange(n);
+    std::vector<size_t> firstCell(ranges.size() + 1, 0);
+    pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+    {
+        size_t nb = 0;
+        for (size_t i = r.begin; i < r.end; i++)
+        {
+            if (isStart(i))
+                nb++;
+        }
+        firstCell[r.chunk + 1] = nb;
+    });
+    for (size_t c = 0; c < ranges.size(); c++)
+        firstCell[c + 1] += firstCell[c];
+    std::vector<size_t> starts(firstCell.back() + 1, n);
+    pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+    {
+        size_t cell = firstCell[r.chunk];
+        for (size_t i = r.begin; i < r.end; i++)
+        {
+            if (isStart(i))
+                starts[cell++] = i;
+        }
+    });
+    return starts;
+}
+
+bp::dict DgmOctree_cellTable_py(CCCoreLib::DgmOctree& self, unsigned char level)
+{
+    if (level < 1 || level > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL)
+    {
+        PyErr_SetString(PyExc_ValueError, "level out of range");
+        bp::throw_error_already_set();
+    }
+    const CCCoreLib::DgmOctree::cellsContainer& cells = self.pointsAndTheirCellCodes();
+    size_t n = cells.size();
+    std::vector<size_t> starts;
+    {
+        GILRelease_py noGIL;
+        starts = DgmOctree_cellStarts_py(self, level);
+    }
+    size_t nbCells = starts.size() - 1;
+    const unsigned char shift = CCCoreLib::DgmOctree::GET_BIT_SHIFT(level);
+    bnp::ndarray codes = bnp::empty(bp::make_tuple(nbCells), bnp::dtype::get_builtin<uint64_t>());
+    bnp::ndarray positions = bnp::empty(bp::make_tuple(nbCells, 3), bnp::dtype::get_builtin<int32_t>());
+    bnp::ndarray offsets = bnp::empty(bp::make_tuple(nbCells), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray counts = bnp::empty(bp::make_tuple(nbCells), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray indexes = bnp::empty(bp::make_tuple(n), bnp::dtype::get_builtin<uint32_t>());
+    uint64_t* pCode = reinterpret_cast<uint64_t*>(codes.get_data());
+    int32_t* pPos = reinterpret_cast<int32_t*>(positions.get_data());
+    int64_t* pOff = reinterpret_cast<int64_t*>(offsets.get_data());
+    int64_t* pCount = reinterpret_cast<int64_t*>(counts.get_data());
+    uint32_t* pIdx = reinterpret_cast<uint32_t*>(indexes.get_data());
+    {
+        GILRelease_py noGIL;
+        pyCC_ParallelFor(nbCells, [&](size_t begin, size_t end)
+        {
+            for (size_t c = begin; c < end; c++)
+            {
+                CCCoreLib::DgmOctree::CellCode code = cells[starts[c]].theCode >> shift;
+                Tuple3i pos;
+                CCCoreLib::DgmOctree::getCellPos(code, level, pos, true);
+                pCode[c] = code;
+                pPos[3 * c] = pos.x;
+                pPos[3 * c + 1] = pos.y;
+                pPos[3 * c + 2] = pos.z;
+                pOff[c] = starts[c];
+                pCount[c] = starts[c + 1] - starts[c];
+            }
+        });
+        pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                pIdx[i] = cells[i].theIndex;
+        });
+    }
+    CCTRACE("cellTable: level " << static_cast<int>(level) << ", " << nbCells << " cells");
+    bp::dict table;
+    table["codes"] = codes;
+    table["positions"] = positions;
+    table["offsets"] = offsets;
+    table["counts"] = counts;
+    table["indexes"] = indexes;
+    return table;
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_boxSearch_py_overloads, DgmOctree_boxSearch_py, 3, 4)
 BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_computeCellCenter_py_overloads, DgmOctree_computeCellCenter_py, 3, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_cylinderSearch_py_overloads, DgmOctree_cylinderSearch_py, 5, 6)
 BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_findPointNeighbourhood_py_overloads, DgmOctree_findPointNeighbourhood_py, 5, 6)
 BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_getCellCodes_py_overloads, DgmOctree_getCellCodes_py, 2, 3)
 BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_getCellCodesAndIndexes_py_overloads, DgmOctree_getCellCodesAndIndexes_py, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_knn_py_overloads, DgmOctree_knn_py, 3, 5)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_knnGraph_py_overloads, DgmOctree_knnGraph_py, 2, 5)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_knnGraphMemory_py_overloads, DgmOctree_knnGraphMemory_py, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_radiusSearch_py_overloads, DgmOctree_radiusSearch_py, 3, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_runCellKernel_py_overloads, DgmOctree_runCellKernel_py, 3, 6)
+BOOST_PYTHON_FUNCTION_OVERLOADS(DgmOctree_runPointKernel_py_overloads, DgmOctree_runPointKernel_py, 3, 6)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(getPointsInCellsWithSortedCellCodes_overloads,
                                        CCCoreLib::DgmOctree::getPointsInCellsWithSortedCellCodes, 3, 4)
@@ -419,9 +722,15 @@ void export_ccOctree()
         ;
 
     class_<CCCoreLib::DgmOctree>("DgmOctree", no_init)
+        .def("boxSearch", &DgmOctree_boxSearch_py,
+             DgmOctree_boxSearch_py_overloads(args("self", "queryPoints", "dimensions", "level"), DgmOctree_boxSearch_doc))
+        .def("cellTable", &DgmOctree_cellTable_py, DgmOctree_cellTable_doc)
         .def("computeCellCenter", &DgmOctree_computeCellCenter_py,
              DgmOctree_computeCellCenter_py_overloads(DgmOctree_computeCellCenter_py_doc))
         .def("computeCellCenter", &DgmOctree_computeCellCenter2_py,DgmOctree_computeCellCenter2_py_doc)
+        .def("cylinderSearch", &DgmOctree_cylinderSearch_py,
+             DgmOctree_cylinderSearch_py_overloads(args("self", "queryPoints", "dir", "radius", "halfLength", "level"),
+                                                   DgmOctree_cylinderSearch_doc))
         .def("findBestLevelForAGivenCellNumber",
              &CCCoreLib::DgmOctree::findBestLevelForAGivenCellNumber,
              DgmOctree_findBestLevelForAGivenCellNumber_doc)
@@ -483,6 +792,20 @@ void export_ccOctree()
              DgmOctree_getTheCellPosWhichIncludesThePointL_doc)
         .def("getTheCellPosWhichIncludesThePointInbBounds", &DgmOctree_getTheCellPosWhichIncludesThePointLI_py,
              DgmOctree_getTheCellPosWhichIncludesThePointLI_doc)
+        .def("knn", &DgmOctree_knn_py,
+             DgmOctree_knn_py_overloads(args("self", "queryPoints", "k", "maxDist", "level"), DgmOctree_knn_doc))
+        .def("knnGraph", &DgmOctree_knnGraph_py,
+             DgmOctree_knnGraph_py_overloads(args("self", "k", "symmetric", "weights", "maxMemory"), DgmOctree_knnGraph_doc))
+        .def("knnGraphMemory", &DgmOctree_knnGraphMemory_py,
+             DgmOctree_knnGraphMemory_py_overloads(args("self", "k", "symmetric"), DgmOctree_knnGraphMemory_doc))
+        .def("radiusSearch", &DgmOctree_radiusSearch_py,
+             DgmOctree_radiusSearch_py_overloads(args("self", "queryPoints", "radius", "level"), DgmOctree_radiusSearch_doc))
+        .def("runCellKernel", &DgmOctree_runCellKernel_py,
+             DgmOctree_runCellKernel_py_overloads(args("self", "level", "name", "outputs", "maxThreadCount", "overwrite"),
+                                                  DgmOctree_runCellKernel_doc))
+        .def("runPointKernel", &DgmOctree_runPointKernel_py,
+             DgmOctree_runPointKernel_py_overloads(args("self", "name", "radius", "inputs", "maxThreadCount", "overwrite"),
+                                                   DgmOctree_runPointKernel_doc))
         ;
 
     // TODO: missing methods in dgmOctree ?
@@ -19,9 +19,14 @@
 #ifndef CCOCTREEPY_HPP_
 #define CCOCTREEPY_HPP_
 
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
 #include <CCGeom.h>
 #include <DgmOctree.h>
 
+#include <vector>
+
 struct PointDescriptor_persistent_py
 {
     const CCVector3 point;
@@ -31,6 +36,29 @@ struct PointDescriptor_persistent_py
     PointDescriptor_persistent_py(const CCCoreLib::DgmOctree::PointDescriptor& pt);
 };
 
+//! k nearest neighbours of the query points (N,3): (indexes (N,k), squareDistances (N,k))
+boost::python::tuple DgmOctree_knn_py(CCCoreLib::DgmOctree& self,
+                                      boost::python::numpy::ndarray const& queryPoints,
+                                      unsigned k,
+                                      double maxDist = 0,
+                                      unsigned char level = 0);
+
+//! points within a radius of the query points (N,3), CSR arrays: (offsets, indexes, squareDistances)
+boost::python::tuple DgmOctree_radiusSearch_py(CCCoreLib::DgmOctree& self,
+                                               boost::python::numpy::ndarray const& queryPoints,
+                                               double radius,
+                                               unsigned char level = 0);
+
+//! order of the query points by octree cell code at a level: consecutive queries visit the same cells. Multithreaded.
+std::vector<unsigned> DgmOctree_queryOrder_py(const CCCoreLib::DgmOctree& octree,
+                                              const std::vector<CCVector3>& points,
+                                              unsigned char level);
+
+//! first point of each non empty cell of a level, in the octree sorted points, plus the number of points at the end
+/*! the points of the cell c are [starts[c], starts[c+1][ in pointsAndTheirCellCodes(). Multithreaded.
+ */
+std::vector<size_t> DgmOctree_cellStarts_py(const CCCoreLib::DgmOctree& self, unsigned char level);
+
 void export_ccOctree();
 
 #endif
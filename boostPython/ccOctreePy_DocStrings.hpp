@@ -54,6 +54,59 @@ Compares two IndexAndCode instances based on their code.
 :return: whether the code of 'a' is smaller than the code of 'b'
 :rtype: bool )";
 
+const char* DgmOctree_boxSearch_doc= R"(
+Finds the points in axis aligned boxes centered on a set of query points, in one call.
+
+Same as :py:meth:`radiusSearch`, with boxes (see :py:meth:`getPointsInBoxNeighbourhood`).
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the box centers
+:param tuple dimensions: box dimensions along X, Y, Z
+:param int,optional level: (default 0) the subdivision level of the octree, 0 for an automatic choice
+
+:return: tuple (offsets, indexes, squareDistances) of numpy arrays, in CSR layout:
+         the neighbours of the query i are indexes[offsets[i]:offsets[i+1]], sorted by increasing distance,
+         with their square distances to the query point. offsets is int64 of size N+1,
+         indexes (int64) and squareDistances (float64) have size offsets[N].
+:rtype: tuple )";
+
+const char* DgmOctree_cylinderSearch_doc= R"(
+Finds the points in cylinders centered on a set of query points, in one call.
+
+Same as :py:meth:`radiusSearch`, with cylinders of the same direction
+(see :py:meth:`getPointsInCylindricalNeighbourhood`).
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the cylinder centers
+:param tuple dir: direction of the cylinders axis
+:param float radius: radius of the cylinders
+:param float halfLength: half length of the cylinders
+:param int,optional level: (default 0) the subdivision level of the octree, 0 for an automatic choice
+
+:return: tuple (offsets, indexes, squareDistances) of numpy arrays, in CSR layout:
+         the neighbours of the query i are indexes[offsets[i]:offsets[i+1]], sorted by increasing distance,
+         with their square distances to the query point. offsets is int64 of size N+1,
+         indexes (int64) and squareDistances (float64) have size offsets[N].
+:rtype: tuple )";
+
+const char* DgmOctree_cellTable_doc= R"(
+Returns the table of the non empty cells of a level, in one call, for vectorized per cell processing.
+
+Replaces a loop on :py:meth:`getCellCodes` and :py:meth:`getPointsInCell`.
+The cells are sorted by code. The points of the cell i are
+``indexes[offsets[i]:offsets[i]+counts[i]]``, so per cell statistics on a point values array `v` are
+``np.add.reduceat(v[indexes], offsets)``.
+
+:param int level: the level of subdivision (1 to 21)
+
+:return: dictionary of numpy arrays:
+
+         - "codes": truncated cell codes, uint64 (nbCells)
+         - "positions": cell positions (i, j, k) at this level, int32 (nbCells, 3)
+         - "offsets": position of the first point of each cell in indexes, int64 (nbCells)
+         - "counts": number of points of each cell, int64 (nbCells)
+         - "indexes": the point indexes sorted by cell, uint32 (number of projected points)
+
+:rtype: dict )";
+
 const char* DgmOctree_computeCellCenter_py_doc= R"(
 Returns the cell center for a given level of subdivision of a cell designated by its code.
 
@@ -507,6 +560,137 @@ Compares two IndexAndCode instances based on their index.
 :return: whether the index of 'a' is smaller than the index of 'b'
 :rtype: bool )";
 
+const char* DgmOctree_knn_doc= R"(
+Finds the k nearest neighbours of a set of query points, in one call.
+
+The queries are sorted by octree cell, then processed in parallel on all the cores, with the Python GIL released.
+A query point belonging to the cloud is its own first neighbour.
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param int k: number of neighbours
+:param float,optional maxDist: (default 0) the maximum search distance (ignored if <= 0)
+:param int,optional level: (default 0) the subdivision level of the octree, 0 for an automatic choice
+
+:return: tuple (indexes, squareDistances) of numpy arrays of shape (N,k), int64 and float64,
+         sorted by increasing distance. When less than k neighbours are found,
+         the remaining indexes are -1 and the remaining distances are inf.
+:rtype: tuple )";
+
+const char* DgmOctree_knnGraph_doc= R"(
+Builds the k nearest neighbours graph of the points of the cloud, as a sparse matrix in CSR layout.
+
+The arrays are those expected by ``scipy.sparse.csr_matrix((data, indices, indptr), shape=(n, n))``,
+for graph based processing (spectral clustering, geodesic distances, label propagation...).
+The row i holds the edges of the point i to its k nearest neighbours, the point itself excluded
+(less if the cloud has less than k+1 points), with column indices sorted and without duplicates.
+With symmetric, the graph is undirected: the edge i-j exists if j is a neighbour of i or i a neighbour of j,
+so a row can have more than k edges.
+The neighbours are searched in parallel on all the cores, with the Python GIL released.
+The memory required can be estimated before with :py:meth:`knnGraphMemory`.
+
+:param int k: the number of neighbours per point
+:param bool,optional symmetric: (default True) union of the edges in both directions
+:param str,optional weights: (default "distance") the values of the edges: "distance", "squareDistance",
+       or "connectivity" (1.)
+:param float,optional maxMemory: (default 0) if not 0, a MemoryError is raised before any allocation
+       when the estimated peak memory, in bytes, is greater
+
+:return: tuple (indptr, indices, data) of numpy arrays: indptr int64 of size n+1, indices int64 and data float64
+         of size indptr[n]
+:rtype: tuple )";
+
+const char* DgmOctree_knnGraphMemory_doc= R"(
+Estimates the memory used by :py:meth:`knnGraph`, without any allocation.
+
+The estimates are upper bounds: the symmetric graph has at most twice the edges of the directed graph.
+
+:param int k: the number of neighbours per point
+:param bool,optional symmetric: (default True) union of the edges in both directions
+
+:return: dictionary {"peak": bytes used during the construction, "output": bytes of the returned arrays}
+:rtype: dict )";
+
+const char* DgmOctree_radiusSearch_doc= R"(
+Finds the points within a radius of a set of query points, in one call.
+
+Replaces a loop on :py:meth:`getPointsInSphericalNeighbourhood`, without creating Python objects per neighbour.
+The queries are sorted by octree cell, then processed in parallel on all the cores, with the Python GIL released.
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param float radius: the search radius
+:param int,optional level: (default 0) the subdivision level of the octree, 0 for an automatic choice
+
+:return: tuple (offsets, indexes, squareDistances) of numpy arrays, in CSR layout:
+         the neighbours of the query i are indexes[offsets[i]:offsets[i+1]], sorted by increasing distance,
+         with their square distances to the query point. offsets is int64 of size N+1,
+         indexes (int64) and squareDistances (float64) have size offsets[N].
+:rtype: tuple )";
+
+const char* DgmOctree_runCellKernel_doc= R"(
+Runs a native cell kernel on all the non empty cells of a level, and writes its outputs in scalar fields of the cloud.
+
+Replaces a Python loop on the cells (see :py:meth:`cellTable`) for the usual per cell analyses.
+The cells are processed in parallel by CloudCompare (``executeFunctionForAllCellsAtLevel``), with the Python GIL released.
+This CloudCompare function is not reentrant: the runs of :py:meth:`runCellKernel` and :py:meth:`runPointKernel`
+from several Python threads are serialized.
+Each output is a scalar field named after the output, created if needed.
+An existing scalar field with the same name is overwritten only with `overwrite=True`, a ValueError is raised otherwise.
+The value of the cell is given to all its points (for instance "planarity"), or a value per point
+relative to its cell (for instance "height" or "distance").
+
+The kernels are listed by :py:func:`cloudComPy.getCellKernels`:
+
+- "count": number of points of the cell (count)
+- "height": zmin, zmax, zmean, zrange of the cell, height of the points above the lowest point of the cell
+  (default: height, zrange)
+- "pca": eigenvalues of the covariance matrix of the cell points and shape features: eigenvalue1, eigenvalue2,
+  eigenvalue3, sum, omnivariance, eigenentropy, anisotropy, planarity, linearity, surfaceVariation, sphericity,
+  verticality (default: linearity, planarity, sphericity). NaN for cells of less than 3 points.
+- "plane": least squares plane of the cell: rms, nx, ny, nz (normal oriented upwards), dip (degrees),
+  signed distance of the points to the plane (default: distance, rms). NaN for cells of less than 3 points.
+- "sf": statistics of scalar fields, NaN values ignored: outputs "field_stat" with stat in mean, min, max, sum, std,
+  median (default: the mean of each scalar field). Packed and evicted fields are restored first.
+- "zpercentile": altitude percentiles: outputs "pXX" for the percentile XX, from 0 to 100 (default: p50)
+
+A KeyError is raised for an unknown kernel, a ValueError for an unknown or repeated output.
+
+:param int level: the level of subdivision (1 to 21)
+:param str name: the kernel name
+:param list,optional outputs: (default: the default outputs of the kernel) list of output names
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores
+:param bool,optional overwrite: (default False) replace the existing scalar fields named as outputs
+
+:return: dictionary {output name: scalar field index}
+:rtype: dict )";
+
+const char* DgmOctree_runPointKernel_doc= R"(
+Runs a point kernel plugin loaded by :py:func:`cloudComPy.loadKernel` on all the points of the cloud,
+and writes its outputs in scalar fields of the cloud.
+
+The kernel receives each point with its neighbours within the radius (the point included), their square distances,
+the coordinates of the cloud and the input scalar fields.
+The points are processed cell by cell at the octree level suited to the radius, in parallel
+(``executeFunctionForAllCellsAtLevel``, as the CloudCompare geometric features), with the Python GIL released.
+The runs from several Python threads are serialized, as for :py:meth:`runCellKernel`.
+Each output is a scalar field named after the output.
+An existing scalar field with the same name is overwritten only with `overwrite=True`, a ValueError is raised otherwise.
+
+Packed and evicted input fields are restored first. An input can't be an output of the kernel
+(the neighbour values would be read while they are written).
+
+A KeyError is raised for a kernel not loaded, a ValueError for a wrong number of inputs, an unknown scalar field
+an input named as an output or an existing output without `overwrite`,
+a RuntimeError if the kernel stops the computation.
+
+:param str name: the kernel name
+:param float radius: the radius of the neighbourhoods
+:param list,optional inputs: (default empty) names of the input scalar fields, as many as required by the kernel
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores
+:param bool,optional overwrite: (default False) replace the existing scalar fields named as outputs
+
+:return: dictionary {output name: scalar field index}
+:rtype: dict )";
+
 #define dgm_nnss_0 R"(
 Container of in/out parameters for nearest neighbour(s) search.
 
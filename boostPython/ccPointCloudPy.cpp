@@ -24,13 +24,29 @@
 #include <ccPointCloud.h>
 #include <ccPolyline.h>
 #include <ccScalarField.h>
+#include <ccGlobalShiftManager.h>
+#include <ccGLMatrix.h>
 #include <GenericProgressCallback.h>
 
 #include "PyScalarType.h"
+#include "arrowPy.hpp"
+#include "ccGenericCloudPy.hpp"
+#include "contentVersionPy.hpp"
+#include "dlpackPy.hpp"
+#include "gilPy.hpp"
+#include "kdTreePy.hpp"
+#include "octreeIOPy.hpp"
+#include "packedSFPy.hpp"
+#include "pyccExpression.h"
+#include "pyccParallel.h"
 #include "pyccTrace.h"
 #include "ccPointCloudPy_DocStrings.hpp"
 
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 
 namespace bp = boost::python;
 namespace bnp = boost::python::numpy;
@@ -74,6 +90,7 @@ void coordsFromNPArray_copy(ccPointCloud &self, bnp::ndarray const & array)
     PointCoordinateType *s = reinterpret_cast<PointCoordinateType*>(array.get_data());
     PointCoordinateType *d = (PointCoordinateType*)self.getPoint(0);
     memcpy(d, s, 3*nRows*sizeof(PointCoordinateType));
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
     CCTRACE("copied " << 3*nRows*sizeof(PointCoordinateType));
 }
 
@@ -98,7 +115,68 @@ CCCoreLib::ScalarField* getScalarFieldByName_py(ccPointCloud &self, const QStrin
             return self.getScalarField(i);
         }
     }
-    return nullptr;
+    // an evicted or packed field is materialised on first access
+    int sfIdx = materializeScalarField_py(self, name);
+    return (sfIdx >= 0) ? self.getScalarField(sfIdx) : nullptr;
+}
+
+bp::tuple gather_py(ccPointCloud &self, bnp::ndarray const& indexes, bp::list fields = bp::list())
+{
+    std::vector<unsigned> idx = indexesFromNpArray(indexes, self.size());
+    size_t n = idx.size();
+
+    std::vector<CCCoreLib::ScalarField*> sfs;
+    std::vector<bnp::ndarray> sfArrays;
+    bp::dict sfDic;
+    for (bp::ssize_t i = 0; i < bp::len(fields); i++)
+    {
+        QString name = bp::extract<QString>(fields[i]);
+        CCCoreLib::ScalarField* sf = getScalarFieldByName_py(self, name);
+        if (!sf)
+        {
+            PyErr_Format(PyExc_KeyError, "no scalar field named %s", name.toStdString().c_str());
+            bp::throw_error_already_set();
+        }
+        bnp::ndarray sfArray = bnp::empty(bp::make_tuple(n), bnp::dtype::get_builtin<PyScalarType>());
+        sfs.push_back(sf);
+        sfArrays.push_back(sfArray);
+        sfDic[fields[i]] = sfArray;
+    }
+    bnp::ndarray coords = bnp::empty(bp::make_tuple(n, 3), bnp::dtype::get_builtin<PointCoordinateType>());
+    if (n == 0)
+        return bp::make_tuple(coords, sfDic);
+
+    const PointCoordinateType* s = reinterpret_cast<const PointCoordinateType*>(self.getPoint(0));
+    PointCoordinateType* d = reinterpret_cast<PointCoordinateType*>(coords.get_data());
+    std::vector<const ScalarType*> sfSrc;
+    std::vector<PyScalarType*> sfDst;
+    for (size_t k = 0; k < sfs.size(); k++)
+    {
+        sfSrc.push_back(sfs[k]->data());
+        sfDst.push_back(reinterpret_cast<PyScalarType*>(sfArrays[k].get_data()));
+    }
+    const unsigned* pidx = idx.data();
+
+    // indexes are already checked: one pass, no per point test
+    pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const PointCoordinateType* p = s + 3 * static_cast<size_t>(pidx[i]);
+            d[3*i]   = p[0];
+            d[3*i+1] = p[1];
+            d[3*i+2] = p[2];
+        }
+        for (size_t k = 0; k < sfSrc.size(); k++)
+        {
+            const ScalarType* src = sfSrc[k];
+            PyScalarType* dst = sfDst[k];
+            for (size_t i = begin; i < end; i++)
+                dst[i] = src[pidx[i]];
+        }
+    });
+    CCTRACE("gather: " << n << " points, " << sfs.size() << " scalar fields");
+    return bp::make_tuple(coords, sfDic);
 }
 
 bnp::ndarray CoordsToNpArray_copy(ccPointCloud &self)
@@ -113,23 +191,182 @@ bnp::ndarray CoordsToNpArray_copy(ccPointCloud &self)
     return result.copy();
 }
 
-bnp::ndarray CoordsToNpArray_py(ccPointCloud &self)
+bnp::ndarray CoordsToNpArray_py(bp::object cloud)
 {
     CCTRACE("CoordsToNpArray without copy, ownership stays in C++");
+    ccPointCloud& self = bp::extract<ccPointCloud&>(cloud);
     bnp::dtype dt = bnp::dtype::get_builtin<PointCoordinateType>(); // coordinates always in simple precision
     size_t nRows = self.size();
     CCTRACE("nrows: " << nRows);
     bp::tuple shape = bp::make_tuple(nRows, 3);
     bp::tuple stride = bp::make_tuple(3*sizeof(PointCoordinateType), sizeof(PointCoordinateType));
     PointCoordinateType *s = (PointCoordinateType*)self.getPoint(0);
-    bnp::ndarray result = bnp::from_data(s, dt, shape, stride, bp::object());
+    bnp::ndarray result = bnp::from_data(s, dt, shape, stride, coordsViewOwner_py(cloud));
     return result;
 }
 
+bnp::ndarray CoordsToNpArrayGlobal_py(ccPointCloud &self)
+{
+    CCTRACE("CoordsToNpArrayGlobal, double precision with global shift and scale, ownership transfered to Python");
+    size_t nRows = self.size();
+    bnp::ndarray result = bnp::empty(bp::make_tuple(nRows, 3), bnp::dtype::get_builtin<double>());
+    if (nRows == 0)
+        return result;
+    const PointCoordinateType *s = reinterpret_cast<const PointCoordinateType*>(self.getPoint(0));
+    double *d = reinterpret_cast<double*>(result.get_data());
+    const CCVector3d shift = self.getGlobalShift();
+    const double invScale = 1.0 / self.getGlobalScale();
+
+    // Pglobal = Plocal/scale - shift, in one pass
+    pyCC_ParallelFor(nRows, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            d[3*i]   = s[3*i]   * invScale - shift.x;
+            d[3*i+1] = s[3*i+1] * invScale - shift.y;
+            d[3*i+2] = s[3*i+2] * invScale - shift.z;
+        }
+    });
+    return result;
+}
+
+void coordsFromNPArrayGlobal_py(ccPointCloud &self, bnp::ndarray const & array, bool autoShift = false)
+{
+    if (array.get_dtype() != bnp::dtype::get_builtin<double>())
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array data type, float64 required");
+        bp::throw_error_already_set();
+    }
+    if (array.get_nd() != 2)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array dimension");
+        bp::throw_error_already_set();
+    }
+    if (array.shape(1) != 3)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array, 3 coordinates required");
+        bp::throw_error_already_set();
+    }
+    if (!(array.get_flags() & bnp::ndarray::C_CONTIGUOUS))
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array, C contiguous array required");
+        bp::throw_error_already_set();
+    }
+    size_t nRows = array.shape(0);
+    const double *s = reinterpret_cast<const double*>(array.get_data());
+    if (autoShift && nRows > 0)
+    {
+        CCVector3d P(s[0], s[1], s[2]);
+        if (ccGlobalShiftManager::NeedShift(P))
+        {
+            self.setGlobalShift(ccGlobalShiftManager::BestShift(P));
+            CCTRACE("new global shift: " << self.getGlobalShift().x << " " << self.getGlobalShift().y << " " << self.getGlobalShift().z);
+        }
+    }
+    if (!self.reserve(nRows) || !self.resize(nRows))
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (nRows == 0)
+    {
+        ccGenericPointCloud_notifyGeometryUpdate_py(self);
+        return;
+    }
+    PointCoordinateType *d = (PointCoordinateType*)self.getPoint(0);
+    const CCVector3d shift = self.getGlobalShift();
+    const double scale = self.getGlobalScale();
+
+    // Plocal = (Pglobal + shift)*scale, in one pass
+    pyCC_ParallelFor(nRows, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            d[3*i]   = static_cast<PointCoordinateType>((s[3*i]   + shift.x) * scale);
+            d[3*i+1] = static_cast<PointCoordinateType>((s[3*i+1] + shift.y) * scale);
+            d[3*i+2] = static_cast<PointCoordinateType>((s[3*i+2] + shift.z) * scale);
+        }
+    });
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
+    CCTRACE("converted " << nRows << " global points");
+}
+
+bp::object CoordsToDLPack_py(bp::object self, bp::object stream = bp::object())
+{
+    ccPointCloud& cloud = bp::extract<ccPointCloud&>(self);
+    size_t nRows = cloud.size();
+    void *s = nRows ? (void*)cloud.getPoint(0) : nullptr;
+    return DLPack_wrap_py(coordsViewOwner_py(self), s, DLPack_dtype<PointCoordinateType>(), nRows, 3);
+}
+
+template<typename T> void DLPack_copyCoords(const DLTensor& t, PointCoordinateType* d)
+{
+    const T* s = reinterpret_cast<const T*>(static_cast<const char*>(t.data) + t.byte_offset);
+    size_t nRows = t.shape[0];
+    int64_t rowStride = t.strides ? t.strides[0] : 3;
+    int64_t colStride = t.strides ? t.strides[1] : 1;
+    if (std::is_same<T, PointCoordinateType>::value && rowStride == 3 && colStride == 1)
+    {
+        memcpy(d, s, 3*nRows*sizeof(PointCoordinateType));
+        return;
+    }
+    pyCC_ParallelFor(nRows, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const T* row = s + i*rowStride;
+            d[3*i]   = static_cast<PointCoordinateType>(row[0]);
+            d[3*i+1] = static_cast<PointCoordinateType>(row[colStride]);
+            d[3*i+2] = static_cast<PointCoordinateType>(row[2*colStride]);
+        }
+    });
+}
+
+ccPointCloud* fromDLPack_py(bp::object tensor, const QString& name = QString())
+{
+    DLPack_guard guard(DLPack_consume_py(tensor));
+    const DLTensor& t = guard.tensor->dl_tensor;
+    if (t.device.device_type != kDLCPU)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect tensor device, CPU required");
+        bp::throw_error_already_set();
+    }
+    if (t.ndim != 2 || t.shape[1] != 3)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect tensor, shape (nbPoints, 3) required");
+        bp::throw_error_already_set();
+    }
+    if (t.dtype.code != kDLFloat || t.dtype.lanes != 1 || (t.dtype.bits != 32 && t.dtype.bits != 64))
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect tensor data type, float32 or float64 required");
+        bp::throw_error_already_set();
+    }
+    size_t nRows = t.shape[0];
+    ccPointCloud* cloud = new ccPointCloud(name);
+    if (!cloud->reserve(nRows) || !cloud->resize(nRows))
+    {
+        delete cloud;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (nRows > 0)
+    {
+        PointCoordinateType *d = (PointCoordinateType*)cloud->getPoint(0);
+        if (t.dtype.bits == 32)
+            DLPack_copyCoords<float>(t, d);
+        else
+            DLPack_copyCoords<double>(t, d);
+    }
+    CCTRACE("fromDLPack: " << nRows << " points");
+    return cloud;
+}
+
 ccPointCloud* crop2D_py(ccPointCloud &self, const ccPolyline* poly, unsigned char orthoDim, bool inside = true)
 {
     ccPointCloud* croppedCloud = nullptr;
     CCTRACE("ortho dim " <<  orthoDim);
+    EvictedFieldsGuard_py evicted(&self, true);
+    evicted.check();
     CCCoreLib::ReferenceCloud* ref = self.crop2D(poly, orthoDim, inside);
     if (ref && (ref->size() != 0))
     {
@@ -140,24 +377,571 @@ ccPointCloud* crop2D_py(ccPointCloud &self, const ccPolyline* poly, unsigned cha
     return croppedCloud;
 }
 
+ccPointCloud* cloneThis_py(ccPointCloud &self, ccPointCloud* destCloud = nullptr, bool ignoreChildren = false)
+{
+    EvictedFieldsGuard_py evicted(&self);
+    evicted.check();
+    return self.cloneThis(destCloud, ignoreChildren);
+}
+
 void fuse_py(ccPointCloud &self, ccPointCloud* other)
 {
+    // evicted and packed fields keep the former number of points: restored first
+    materializeScalarFields_py(self);
+    EvictedFieldsGuard_py otherFields(other, true);
+    otherFields.check();
     self += other;
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
 }
 
 bp::tuple partialClone_py(ccPointCloud &self,
                           const CCCoreLib::ReferenceCloud* selection)
 {
+    EvictedFieldsGuard_py evicted(&self, true);
+    evicted.check();
     int warnings;
     ccPointCloud* cloud = self.partialClone(selection, &warnings);
     bp::tuple res = bp::make_tuple(cloud, warnings);
     return res;
 }
 
+bp::tuple partialCloneFromNpArray_py(ccPointCloud &self,
+                                     bnp::ndarray const& selection)
+{
+    std::vector<unsigned> indexes = indexesFromNpArray(selection, self.size());
+    CCCoreLib::ReferenceCloud ref(&self);
+    if (!ref.resize(static_cast<unsigned>(indexes.size())))
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    for (unsigned i = 0; i < indexes.size(); i++)
+        ref.setPointIndex(i, indexes[i]);
+    EvictedFieldsGuard_py evicted(&self, true);
+    evicted.check();
+    int warnings;
+    ccPointCloud* cloud = self.partialClone(&ref, &warnings);
+    bp::tuple res = bp::make_tuple(cloud, warnings);
+    return res;
+}
+
+//! boolean mask on a cloud, with the per chunk offsets of the kept and rejected points (prefix sums)
+struct CloudMask_py
+{
+    bnp::ndarray array;
+    const bool* mask;
+    std::vector<pyCC_Range> ranges;
+    std::vector<size_t> keptOffsets;
+    std::vector<size_t> rejectedOffsets;
+    size_t nbKept;
+    size_t nbRejected;
+
+    CloudMask_py(bnp::ndarray const& m) : array(m), mask(nullptr), nbKept(0), nbRejected(0) {}
+};
+
+CloudMask_py cloudMask_py(ccPointCloud &self, bnp::ndarray const& maskArray)
+{
+    if (maskArray.get_dtype() != bnp::dtype::get_builtin<bool>())
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array data type, bool required");
+        bp::throw_error_already_set();
+    }
+    if (maskArray.get_nd() != 1 || maskArray.shape(0) != self.size())
+    {
+        PyErr_SetString(PyExc_ValueError, "Incorrect mask, one dimension array of the cloud size required");
+        bp::throw_error_already_set();
+    }
+    CloudMask_py cm((maskArray.get_flags() & bnp::ndarray::C_CONTIGUOUS) ? maskArray : maskArray.copy());
+    cm.mask = reinterpret_cast<const bool*>(cm.array.get_data());
+    cm.ranges = pyCC_SplitRange(self.size());
+
+    // count the kept points per chunk, then prefix sums: each chunk knows where to write
+    std::vector<size_t> counts(cm.ranges.size(), 0);
+    const bool* m = cm.mask;
+    pyCC_ParallelForRanges(cm.ranges, [m, &counts](const pyCC_Range& r)
+    {
+        counts[r.chunk] = std::count(m + r.begin, m + r.end, true);
+    });
+    cm.keptOffsets.resize(cm.ranges.size());
+    cm.rejectedOffsets.resize(cm.ranges.size());
+    for (size_t c = 0; c < cm.ranges.size(); c++)
+    {
+        cm.keptOffsets[c] = cm.nbKept;
+        cm.rejectedOffsets[c] = cm.ranges[c].begin - cm.nbKept;
+        cm.nbKept += counts[c];
+    }
+    cm.nbRejected = self.size() - cm.nbKept;
+    return cm;
+}
+
+//! new cloud with the points where mask == value: coordinates, colors, normals and scalar fields in one parallel pass
+ccPointCloud* maskedClone_py(ccPointCloud &self, const CloudMask_py& cm, bool value)
+{
+    EvictedFieldsGuard_py evicted(&self, true);
+    evicted.check();
+    size_t nbPts = value ? cm.nbKept : cm.nbRejected;
+    const std::vector<size_t>& offsets = value ? cm.keptOffsets : cm.rejectedOffsets;
+    ccPointCloud* cloud = new ccPointCloud(self.getName() + (value ? QString(".extract") : QString(".remaining")));
+    cloud->setGlobalShift(self.getGlobalShift());
+    cloud->setGlobalScale(self.getGlobalScale());
+    bool withColors = self.hasColors();
+    bool withNormals = self.hasNormals();
+    unsigned nbSF = self.getNumberOfScalarFields();
+    bool ok = cloud->reserve(nbPts) && cloud->resize(nbPts);
+    if (ok && withColors)
+        ok = cloud->resizeTheRGBTable(false);
+    if (ok && withNormals)
+        ok = cloud->resizeTheNormsTable();
+    std::vector<const ScalarType*> sfSrc;
+    std::vector<ScalarType*> sfDst;
+    for (unsigned k = 0; ok && k < nbSF; k++)
+    {
+        int sfIdx = cloud->addScalarField(self.getScalarFieldName(k));
+        ok = (sfIdx >= 0);
+        if (ok)
+        {
+            sfSrc.push_back(self.getScalarField(k)->data());
+            sfDst.push_back(cloud->getScalarField(sfIdx)->data());
+        }
+    }
+    if (!ok)
+    {
+        delete cloud;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (nbPts == 0)
+        return cloud;
+
+    const bool* m = cm.mask;
+    const PointCoordinateType* s = reinterpret_cast<const PointCoordinateType*>(self.getPoint(0));
+    PointCoordinateType* d = reinterpret_cast<PointCoordinateType*>(cloud->point(0));
+    const ccColor::Rgba* cs = withColors ? self.rgbaColors()->data() : nullptr;
+    ccColor::Rgba* cd = withColors ? cloud->rgbaColors()->data() : nullptr;
+    const CompressedNormType* ns = withNormals ? self.normals()->data() : nullptr;
+    CompressedNormType* nd = withNormals ? cloud->normals()->data() : nullptr;
+    pyCC_ParallelForRanges(cm.ranges, [&](const pyCC_Range& r)
+    {
+        size_t j = offsets[r.chunk];
+        for (size_t i = r.begin; i < r.end; i++)
+        {
+            if (m[i] != value)
+                continue;
+            d[3*j]   = s[3*i];
+            d[3*j+1] = s[3*i+1];
+            d[3*j+2] = s[3*i+2];
+            if (cs)
+                cd[j] = cs[i];
+            if (ns)
+                nd[j] = ns[i];
+            for (size_t k = 0; k < sfSrc.size(); k++)
+                sfDst[k][j] = sfSrc[k][i];
+            j++;
+        }
+    });
+    cloud->invalidateBoundingBox();
+    for (unsigned k = 0; k < nbSF; k++)
+        cloud->getScalarField(k)->computeMinAndMax();
+    cloud->showColors(withColors && self.colorsShown());
+    cloud->showNormals(withNormals && self.normalsShown());
+    if (nbSF)
+    {
+        cloud->setCurrentDisplayedScalarField(self.getCurrentDisplayedScalarFieldIndex());
+        cloud->showSF(self.sfShown());
+    }
+    return cloud;
+}
+
+ccPointCloud* filterByMask_py(ccPointCloud &self, bnp::ndarray const& mask)
+{
+    CloudMask_py cm = cloudMask_py(self, mask);
+    CCTRACE("filterByMask: " << cm.nbKept << " points kept");
+    return maskedClone_py(self, cm, true);
+}
+
+bp::tuple split_py(ccPointCloud &self, bnp::ndarray const& mask)
+{
+    CloudMask_py cm = cloudMask_py(self, mask);
+    CCTRACE("split: " << cm.nbKept << " points kept, " << cm.nbRejected << " rejected");
+    ccPointCloud* kept = maskedClone_py(self, cm, true);
+    ccPointCloud* rejected = nullptr;
+    try
+    {
+        rejected = maskedClone_py(self, cm, false);
+    }
+    catch (bp::error_already_set&)
+    {
+        delete kept;
+        throw;
+    }
+    bp::tuple res = bp::make_tuple(kept, rejected);
+    return res;
+}
+
+int evalScalarField_py(ccPointCloud &self, const QString& name, const std::string& expression)
+{
+    std::unique_ptr<pyCC_Expression> expr;
+    try
+    {
+        expr.reset(new pyCC_Expression(expression));
+    }
+    catch (const std::invalid_argument& e)
+    {
+        PyErr_SetString(PyExc_ValueError, e.what());
+        bp::throw_error_already_set();
+    }
+
+    // --- one loader per variable: coordinates, normal components or scalar fields, read in place
+    std::vector<pyCC_Expression::Loader> loaders;
+    const PointCoordinateType* coords = self.size() ? reinterpret_cast<const PointCoordinateType*>(self.getPoint(0)) : nullptr;
+    for (const std::string& var : expr->variableNames())
+    {
+        static const char* coordNames[] = { "X", "Y", "Z" };
+        static const char* normalNames[] = { "Nx", "Ny", "Nz" };
+        bool found = false;
+        for (int k = 0; k < 3 && !found; k++)
+        {
+            if (var == coordNames[k])
+            {
+                loaders.push_back([coords, k](size_t begin, size_t count, double* out)
+                {
+                    for (size_t i = 0; i < count; i++)
+                        out[i] = coords[3 * (begin + i) + k];
+                });
+                found = true;
+            }
+            else if (var == normalNames[k])
+            {
+                if (!self.hasNormals())
+                {
+                    PyErr_SetString(PyExc_ValueError, "the expression uses normals, but the cloud has no normals");
+                    bp::throw_error_already_set();
+                }
+                ccPointCloud* cloud = &self;
+                loaders.push_back([cloud, k](size_t begin, size_t count, double* out)
+                {
+                    for (size_t i = 0; i < count; i++)
+                        out[i] = cloud->getPointNormal(static_cast<unsigned>(begin + i)).u[k];
+                });
+                found = true;
+            }
+        }
+        if (found)
+            continue;
+        CCCoreLib::ScalarField* sf = getScalarFieldByName_py(self, QString::fromStdString(var));
+        if (!sf)
+        {
+            PyErr_Format(PyExc_ValueError, "unknown variable in expression: %s", var.c_str());
+            bp::throw_error_already_set();
+        }
+        const ScalarType* v = sf->data();
+        loaders.push_back([v](size_t begin, size_t count, double* out)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = v[begin + i];
+        });
+    }
+
+    // --- result written in place: an existing field (even used in the expression) or a new one
+    int sfIdx = self.getScalarFieldIndexByName(qPrintable(name));
+    if (sfIdx < 0)
+        sfIdx = self.addScalarField(qPrintable(name));
+    if (sfIdx < 0)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    CCCoreLib::ScalarField* sf = self.getScalarField(sfIdx);
+    ScalarType* out = sf->data();
+    const pyCC_Expression* e = expr.get();
+    pyCC_ParallelFor(self.size(), [e, &loaders, out](size_t begin, size_t end)
+    {
+        e->evaluate(begin, end, loaders, out);
+    });
+    sf->computeMinAndMax();
+    CCTRACE("evalScalarField " << name.toStdString() << " = " << expression);
+    return sfIdx;
+}
+
+//! one term of a filter: a coordinate or a scalar field, compared to a range, a value or a set of values
+struct FilterPredicate_py
+{
+    enum Kind { RANGE, LT, LE, GT, GE, EQ, NE, IN, NOTIN };
+    const PointCoordinateType* coords = nullptr; // one coordinate, stride 3
+    const ScalarType* sf = nullptr;
+    Kind kind = RANGE;
+    double low = 0;
+    double high = 0;
+    std::vector<double> values; // sorted, for IN and NOTIN
+
+    inline double value(size_t i) const { return coords ? coords[3 * i] : sf[i]; }
+
+    inline bool test(double v) const
+    {
+        switch (kind)
+        {
+        case RANGE: return v >= low && v <= high;
+        case LT: return v < low;
+        case LE: return v <= low;
+        case GT: return v > low;
+        case GE: return v >= low;
+        case EQ: return v == low;
+        case NE: return v != low;
+        case IN: return std::binary_search(values.begin(), values.end(), v);
+        case NOTIN: return !std::binary_search(values.begin(), values.end(), v);
+        }
+        return false;
+    }
+};
+
+std::vector<FilterPredicate_py> filterPredicates_py(ccPointCloud &self, bp::list predicates)
+{
+    static const struct { const char* name; FilterPredicate_py::Kind kind; } operators[] =
+    {
+        { "lt", FilterPredicate_py::LT }, { "<", FilterPredicate_py::LT },
+        { "le", FilterPredicate_py::LE }, { "<=", FilterPredicate_py::LE },
+        { "gt", FilterPredicate_py::GT }, { ">", FilterPredicate_py::GT },
+        { "ge", FilterPredicate_py::GE }, { ">=", FilterPredicate_py::GE },
+        { "eq", FilterPredicate_py::EQ }, { "==", FilterPredicate_py::EQ },
+        { "ne", FilterPredicate_py::NE }, { "!=", FilterPredicate_py::NE },
+        { "in", FilterPredicate_py::IN }, { "notin", FilterPredicate_py::NOTIN }
+    };
+    std::vector<FilterPredicate_py> preds;
+    const PointCoordinateType* coords = self.size() ? reinterpret_cast<const PointCoordinateType*>(self.getPoint(0)) : nullptr;
+    for (bp::ssize_t p = 0; p < bp::len(predicates); p++)
+    {
+        bp::object t = predicates[p];
+        if (bp::len(t) != 3)
+        {
+            PyErr_SetString(PyExc_ValueError, "a filter predicate is a tuple of 3 elements: (field, min, max) or (field, operator, value)");
+            bp::throw_error_already_set();
+        }
+        FilterPredicate_py pred;
+        QString name = bp::extract<QString>(t[0]);
+        if (name == "X" || name == "Y" || name == "Z")
+            pred.coords = coords + (name == "X" ? 0 : (name == "Y" ? 1 : 2));
+        else
+        {
+            CCCoreLib::ScalarField* sf = getScalarFieldByName_py(self, name);
+            if (!sf)
+            {
+                PyErr_Format(PyExc_KeyError, "no scalar field named %s", qPrintable(name));
+                bp::throw_error_already_set();
+            }
+            pred.sf = sf->data();
+        }
+        bp::extract<std::string> op(t[1]);
+        if (!op.check())
+        {
+            pred.kind = FilterPredicate_py::RANGE;
+            pred.low = bp::extract<double>(t[1]);
+            pred.high = bp::extract<double>(t[2]);
+            preds.push_back(pred);
+            continue;
+        }
+        std::string opName = op();
+        bool found = false;
+        for (const auto& o : operators)
+        {
+            if (opName == o.name)
+            {
+                pred.kind = o.kind;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            PyErr_Format(PyExc_ValueError, "unknown filter operator %s", opName.c_str());
+            bp::throw_error_already_set();
+        }
+        if (pred.kind == FilterPredicate_py::IN || pred.kind == FilterPredicate_py::NOTIN)
+        {
+            bp::object vals = t[2];
+            for (bp::ssize_t k = 0; k < bp::len(vals); k++)
+                pred.values.push_back(bp::extract<double>(vals[k]));
+            std::sort(pred.values.begin(), pred.values.end());
+        }
+        else
+            pred.low = bp::extract<double>(t[2]);
+        preds.push_back(pred);
+    }
+    return preds;
+}
+
+//! combined predicate (logical and of all the terms), evaluated in one parallel pass
+bnp::ndarray filterMask_py(ccPointCloud &self, bp::list predicates)
+{
+    std::vector<FilterPredicate_py> preds = filterPredicates_py(self, predicates);
+    size_t n = self.size();
+    bnp::ndarray result = bnp::empty(bp::make_tuple(n), bnp::dtype::get_builtin<bool>());
+    bool* m = reinterpret_cast<bool*>(result.get_data());
+    pyCC_ParallelFor(n, [m, &preds](size_t begin, size_t end)
+    {
+        std::fill(m + begin, m + end, true);
+        for (const FilterPredicate_py& pred : preds)
+            for (size_t i = begin; i < end; i++)
+                m[i] = m[i] && pred.test(pred.value(i));
+    });
+    return result;
+}
+
+ccPointCloud* filter_py(ccPointCloud &self, bp::list predicates)
+{
+    bnp::ndarray mask = filterMask_py(self, predicates);
+    CloudMask_py cm = cloudMask_py(self, mask);
+    CCTRACE("filter: " << bp::len(predicates) << " predicates, " << cm.nbKept << " points kept");
+    return maskedClone_py(self, cm, true);
+}
+
+//! data[i] = data[perm[i]], through a temporary buffer allocated by the caller, in parallel
+template<typename T> static void permute_py(T* data, T* t, const std::vector<unsigned>& perm, int maxThreadCount)
+{
+    const unsigned* p = perm.data();
+    pyCC_ParallelFor(perm.size(), [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            t[i] = data[p[i]];
+    }, maxThreadCount);
+    pyCC_ParallelFor(perm.size(), [=](size_t begin, size_t end)
+    {
+        std::copy(t + begin, t + end, data + begin);
+    }, maxThreadCount);
+}
+
+//! permute_py with a raw buffer shared by the arrays of plain values
+template<typename T> static void permuteRaw_py(T* data, std::vector<char>& buffer, const std::vector<unsigned>& perm, int maxThreadCount)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "raw buffer for plain values only");
+    permute_py(data, reinterpret_cast<T*>(buffer.data()), perm, maxThreadCount);
+}
+
+bnp::ndarray reorderSpatially_py(ccPointCloud &self, int maxThreadCount=0)
+{
+    if (self.getParent() && self.getParent()->isKindOf(CC_TYPES::MESH))
+    {
+        PyErr_SetString(PyExc_ValueError, "the vertices of a mesh can't be reordered");
+        bp::throw_error_already_set();
+    }
+    // packed or evicted fields are stored in the original order
+    int nbMaterialized = materializeScalarFields_py(self);
+    std::vector<unsigned> perm;
+    {
+        GILRelease_py noGIL;
+        perm = ccGenericPointCloud_spatialOrder_py(self, maxThreadCount);
+    }
+    bool ok = !perm.empty() && (perm.size() == self.size());
+
+    // all the buffers are allocated before the first array is permuted: no partially reordered cloud
+    std::vector<char> buffer;
+    std::vector<ccWaveform> waveformsTmp;
+    if (ok)
+    {
+        size_t elementSize = sizeof(CCVector3);
+        if (self.hasColors())
+            elementSize = std::max(elementSize, sizeof(ccColor::Rgba));
+        if (self.hasNormals())
+            elementSize = std::max(elementSize, sizeof(CompressedNormType));
+        if (self.getNumberOfScalarFields() > 0)
+            elementSize = std::max(elementSize, sizeof(ScalarType));
+        try
+        {
+            buffer.resize(perm.size() * elementSize);
+            if (self.hasFWF())
+                waveformsTmp.resize(perm.size());
+        }
+        catch (const std::bad_alloc&)
+        {
+            ok = false;
+        }
+    }
+    if (!ok && self.size() > 0)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    if (ok)
+    {
+        GILRelease_py noGIL;
+        permuteRaw_py(self.point(0), buffer, perm, maxThreadCount);
+        if (self.hasColors())
+            permuteRaw_py(self.rgbaColors()->data(), buffer, perm, maxThreadCount);
+        if (self.hasNormals())
+            permuteRaw_py(self.normals()->data(), buffer, perm, maxThreadCount);
+        for (unsigned k = 0; k < self.getNumberOfScalarFields(); k++)
+            permuteRaw_py(self.getScalarField(k)->data(), buffer, perm, maxThreadCount);
+        if (self.isVisibilityTableInstantiated())
+            permuteRaw_py(self.getTheVisibilityArray().data(), buffer, perm, maxThreadCount);
+        if (self.hasFWF())
+            permute_py(self.waveforms().data(), waveformsTmp.data(), perm, maxThreadCount);
+    }
+    // structures built on the point indexes are no longer valid
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
+    self.removeGrids();
+    CCTRACE("reorderSpatially: " << self.size() << " points, " << nbMaterialized << " scalar fields materialized");
+
+    bnp::ndarray result = bnp::empty(bp::make_tuple(perm.size()), bnp::dtype::get_builtin<uint32_t>());
+    std::copy(perm.begin(), perm.end(), reinterpret_cast<uint32_t*>(result.get_data()));
+    return result;
+}
+
+void translate_py(ccPointCloud &self, const CCVector3& T)
+{
+    transformCoordinates_py(self, [&]() { self.translate(T); }, [&](ccOctree& octree)
+    {
+        octree.translateBoundingBox(T);
+        return true;
+    });
+}
+
+void scale_py(ccPointCloud &self, PointCoordinateType fx, PointCoordinateType fy, PointCoordinateType fz,
+              CCVector3 center = CCVector3(0, 0, 0))
+{
+    transformCoordinates_py(self, [&]() { self.scale(fx, fy, fz, center); }, [&](ccOctree& octree)
+    {
+        // P' = fx.P + (1 - fx).center: same cells, when the scale is uniform
+        if (fx != fy || fx != fz || !(fx > 0))
+            return false;
+        octree.multiplyBoundingBox(fx);
+        octree.translateBoundingBox(center * (1 - fx));
+        return true;
+    });
+}
+
+void applyRigidTransformation_py(ccPointCloud &self, const ccGLMatrix& trans)
+{
+    transformCoordinates_py(self, [&]() { self.applyRigidTransformation(trans); }, [&](ccOctree& octree)
+    {
+        // the cells are aligned on the axes: only a translation keeps the octree structure
+        const float* m = trans.data();
+        if (m[0] != 1 || m[1] != 0 || m[2] != 0 || m[4] != 0 || m[5] != 1 || m[6] != 0 || m[8] != 0 || m[9] != 0 || m[10] != 1)
+            return false;
+        octree.translateBoundingBox(CCVector3(m[12], m[13], m[14]));
+        return true;
+    });
+}
+
+bool resize_py(ccPointCloud &self, unsigned numberOfPoints)
+{
+    if (numberOfPoints == self.size())
+        return true;
+    materializeScalarFields_py(self);
+    bool ok = self.resize(numberOfPoints);
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
+    return ok;
+}
+
 int (ccPointCloud::*addScalarFieldt)(const char*) = &ccPointCloud::addScalarField;
 
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ccPointCloud_scale_overloads, scale, 3, 4)
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ccPointCloud_cloneThis_overloads, cloneThis, 0, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccPointCloud_arrow_c_array_py_overloads, ccPointCloud_arrow_c_array_py, 1, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(CoordsToDLPack_py_overloads, CoordsToDLPack_py, 1, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(gather_py_overloads, gather_py, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(fromDLPack_py_overloads, fromDLPack_py, 1, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(packScalarField_py_overloads, packScalarField_py, 3, 5)
+BOOST_PYTHON_FUNCTION_OVERLOADS(reorderSpatially_py_overloads, reorderSpatially_py, 1, 2)
+BOOST_PYTHON_FUNCTION_OVERLOADS(scale_py_overloads, scale_py, 4, 5)
+BOOST_PYTHON_FUNCTION_OVERLOADS(coordsFromNPArrayGlobal_py_overloads, coordsFromNPArrayGlobal_py, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(cloneThis_py_overloads, cloneThis_py, 1, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(evictScalarFields_py_overloads, evictScalarFields_py, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(filterPointsByScalarValue_overloads, ccPointCloud::filterPointsByScalarValue, 2,3)
 
 void export_ccPointCloud()
@@ -172,21 +956,38 @@ void export_ccPointCloud()
     class_<ccPointCloud, bases<CCCoreLib::PointCloudTpl<ccGenericPointCloud, QString> > >("ccPointCloud",
                                                                                           ccPointCloudPy_ccPointCloud_doc,
                                                                                           init< optional<QString, unsigned> >())
+        .def("__arrow_c_array__", &ccPointCloud_arrow_c_array_py,
+             ccPointCloud_arrow_c_array_py_overloads(args("self", "requested_schema"), ccPointCloudPy_arrow_c_array_doc))
+        .def("__dlpack__", &CoordsToDLPack_py, CoordsToDLPack_py_overloads(args("self", "stream"), ccPointCloudPy_dlpack_doc))
+        .def("__dlpack_device__", &DLPack_device_py, ccPointCloudPy_dlpack_device_doc)
         .def("addScalarField", addScalarFieldt, ccPointCloudPy_addScalarField_doc)
-        .def("applyRigidTransformation", &ccPointCloud::applyRigidTransformation, ccPointCloudPy_applyRigidTransformation_doc)
-        .def("cloneThis", &ccPointCloud::cloneThis,
-             ccPointCloud_cloneThis_overloads(ccPointCloudPy_cloneThis_doc)[return_value_policy<reference_existing_object>()])
+        .def("applyRigidTransformation", &applyRigidTransformation_py, ccPointCloudPy_applyRigidTransformation_doc)
+        .def("cloneThis", &cloneThis_py,
+             cloneThis_py_overloads(ccPointCloudPy_cloneThis_doc)[return_value_policy<reference_existing_object>()])
         .def("computeGravityCenter", &ccPointCloud::computeGravityCenter, ccPointCloudPy_computeGravityCenter_doc)
         .def("coordsFromNPArray_copy", &coordsFromNPArray_copy, ccPointCloudPy_coordsFromNPArray_copy_doc)
+        .def("fromDLPack", &fromDLPack_py,
+             fromDLPack_py_overloads(args("tensor", "name"), ccPointCloudPy_fromDLPack_doc)[return_value_policy<reference_existing_object>()])
+            .staticmethod("fromDLPack")
+        .def("fromNpArrayGlobal", &coordsFromNPArrayGlobal_py,
+             coordsFromNPArrayGlobal_py_overloads(ccPointCloudPy_fromNpArrayGlobal_doc))
         .def("crop2D", &crop2D_py, return_value_policy<reference_existing_object>(), ccPointCloudPy_crop2D_doc)
         .def("deleteAllScalarFields", &ccPointCloud::deleteAllScalarFields, ccPointCloudPy_deleteAllScalarFields_doc)
         .def("deleteScalarField", &ccPointCloud::deleteScalarField, ccPointCloudPy_deleteScalarField_doc)
+        .def("evalScalarField", &evalScalarField_py, ccPointCloudPy_evalScalarField_doc)
+        .def("evictScalarField", &evictScalarField_py, ccPointCloudPy_evictScalarField_doc)
+        .def("evictScalarFields", &evictScalarFields_py,
+             evictScalarFields_py_overloads(args("self", "maxBytes"), ccPointCloudPy_evictScalarFields_doc))
         .def("exportCoordToSF", &exportCoordToSF_py, ccPointCloudPy_exportCoordToSF_doc)
         .def("exportNormalToSF", &exportNormalToSF_py, ccPointCloudPy_exportNormalToSF_doc)
+        .def("filter", &filter_py, return_value_policy<reference_existing_object>(), ccPointCloudPy_filter_doc)
+        .def("filterByMask", &filterByMask_py, return_value_policy<reference_existing_object>(), ccPointCloudPy_filterByMask_doc)
+        .def("filterMask", &filterMask_py, ccPointCloudPy_filterMask_doc)
         .def("filterPointsByScalarValue", &ccPointCloud::filterPointsByScalarValue,
              filterPointsByScalarValue_overloads(ccPointCloudPy_filterPointsByScalarValue_doc)
              [return_value_policy<reference_existing_object>()])
         .def("fuse", &fuse_py, ccPointCloudPy_fuse_doc)
+        .def("gather", &gather_py, gather_py_overloads(args("self", "indexes", "fields"), ccPointCloudPy_gather_doc))
         .def("getCurrentDisplayedScalarField", &ccPointCloud::getCurrentDisplayedScalarField,
              return_value_policy<reference_existing_object>(), ccPointCloudPy_getCurrentDisplayedScalarField_doc)
         .def("getCurrentDisplayedScalarFieldIndex", &ccPointCloud::getCurrentDisplayedScalarFieldIndex,
@@ -195,7 +996,10 @@ void export_ccPointCloud()
              return_value_policy<reference_existing_object>(), ccPointCloudPy_getCurrentInScalarField_doc)
         .def("getCurrentOutScalarField", &ccPointCloud::getCurrentOutScalarField,
              return_value_policy<reference_existing_object>(), ccPointCloudPy_getCurrentOutScalarField_doc)
+        .def("getEvictedScalarFieldNames", &getEvictedScalarFieldNames_py, ccPointCloudPy_getEvictedScalarFieldNames_doc)
         .def("getNumberOfScalarFields", &ccPointCloud::getNumberOfScalarFields, ccPointCloudPy_getNumberOfScalarFields_doc)
+        .def("getPackedScalarField", &getPackedScalarField_py, ccPointCloudPy_getPackedScalarField_doc)
+        .def("getPackedScalarFieldNames", &getPackedScalarFieldNames_py, ccPointCloudPy_getPackedScalarFieldNames_doc)
         .def("getScalarField", &ccPointCloud::getScalarField,
              return_value_policy<reference_existing_object>(), ccPointCloudPy_getScalarField_doc)
         .def("getScalarField", &getScalarFieldByName_py,
@@ -203,20 +1007,31 @@ void export_ccPointCloud()
         .def("getScalarFieldDic", &getScalarFieldDic_py, ccPointCloudPy_getScalarFieldDic_doc)
         .def("getScalarFieldName", &ccPointCloud::getScalarFieldName, ccPointCloudPy_getScalarFieldName_doc)
         .def("hasScalarFields", &ccPointCloud::hasScalarFields, ccPointCloudPy_hasScalarFields_doc)
+        .def("notifyGeometryUpdate", &ccGenericPointCloud_notifyGeometryUpdate_py, ccPointCloudPy_notifyGeometryUpdate_doc)
+        .def("packScalarField", &packScalarField_py,
+             packScalarField_py_overloads(args("self", "name", "type", "scale", "offset"), ccPointCloudPy_packScalarField_doc))
         .def("partialClone", &partialClone_py, ccPointCloudPy_partialClone_doc)
+        .def("partialClone", &partialCloneFromNpArray_py, ccPointCloudPy_partialClone_doc)
         .def("renameScalarField", &ccPointCloud::renameScalarField, ccPointCloudPy_renameScalarField_doc)
+        .def("reorderSpatially", &reorderSpatially_py,
+             reorderSpatially_py_overloads(args("self", "maxThreadCount"), ccPointCloudPy_reorderSpatially_doc))
         .def("reserve", &ccPointCloud::reserve, ccPointCloudPy_reserve_doc)
-        .def("resize", &ccPointCloud::resize, ccPointCloudPy_resize_doc)
-        .def("scale", &ccPointCloud::scale, ccPointCloud_scale_overloads(ccPointCloudPy_scale_doc))
+        .def("resize", &resize_py, ccPointCloudPy_resize_doc)
+        .def("restoreScalarField", &restoreScalarField_py, ccPointCloudPy_restoreScalarField_doc)
+        .def("scale", &scale_py, scale_py_overloads(args("self", "x", "y", "z", "center"), ccPointCloudPy_scale_doc))
         .def("setCurrentDisplayedScalarField", &ccPointCloud::setCurrentDisplayedScalarField,
              ccPointCloudPy_setCurrentDisplayedScalarField_doc)
         .def("setCurrentScalarField", &ccPointCloud::setCurrentScalarField, ccPointCloudPy_setCurrentScalarField_doc)
         .def("setCurrentInScalarField", &ccPointCloud::setCurrentInScalarField, ccPointCloudPy_setCurrentInScalarField_doc)
         .def("setCurrentOutScalarField", &ccPointCloud::setCurrentOutScalarField, ccPointCloudPy_setCurrentOutScalarField_doc)
         .def("size", &ccPointCloud::size, ccPointCloudPy_size_doc)
+        .def("split", &split_py, ccPointCloudPy_split_doc)
+        .def("toArrow", &ccPointCloud_toArrow_py, ccPointCloudPy_toArrow_doc)
         .def("toNpArray", &CoordsToNpArray_py, ccPointCloudPy_toNpArray_doc)
         .def("toNpArrayCopy", &CoordsToNpArray_copy, ccPointCloudPy_toNpArrayCopy_doc)
-        .def("translate", &ccPointCloud::translate, ccPointCloudPy_translate_doc)
+        .def("toNpArrayGlobal", &CoordsToNpArrayGlobal_py, ccPointCloudPy_toNpArrayGlobal_doc)
+        .def("translate", &translate_py, ccPointCloudPy_translate_doc)
+        .def("unpackScalarField", &unpackScalarField_py, ccPointCloudPy_unpackScalarField_doc)
        ;
 }
 
@@ -19,6 +19,18 @@
 #ifndef CCPOINTCLOUDPY_HPP_
 #define CCPOINTCLOUDPY_HPP_
 
+#include <QString>
+
+class ccPointCloud;
+
+namespace CCCoreLib
+{
+    class ScalarField;
+}
+
+//! scalar field by name, an evicted or packed field is materialised, null if there is no such field
+CCCoreLib::ScalarField* getScalarFieldByName_py(ccPointCloud &self, const QString& name);
+
 void export_ccPointCloud();
 
 #endif
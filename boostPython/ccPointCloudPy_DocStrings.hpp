@@ -29,6 +29,39 @@ A point cloud can have multiple features:
 - an octree structure
 - other children objects (meshes, calibrated pictures, etc.) (TODO) )";
 
+const char* ccPointCloudPy_arrow_c_array_doc= R"(
+Export the cloud as an Arrow record batch (Arrow PyCapsule interface), see :py:meth:`toArrow`.
+
+Used by the Arrow implementations, for instance ``pyarrow.record_batch(cloud)``.
+
+:param requested_schema: ignored, default None
+
+:return: a tuple of PyCapsules ('arrow_schema', 'arrow_array')
+:rtype: tuple
+)";
+
+const char* ccPointCloudPy_dlpack_doc= R"(
+Export the PointCloud coordinates as a DLPack tensor, without copy (DLPack protocol).
+
+Used by the tensor libraries, for instance ``torch.from_dlpack(cloud)`` or ``numpy.from_dlpack(cloud)``.
+The tensor has the shape (number of Points, 3), and the type of the coordinates (float32).
+As with :py:meth:`toNpArray`, data is not copied and stays owned by the cloud:
+the tensor must not be used after the destruction of the cloud, or after a resize of the cloud.
+Modifications done through the tensor are recorded at its release, as with :py:meth:`toNpArray`.
+
+:param stream: not used (CPU only), default None
+
+:return: a PyCapsule 'dltensor'
+:rtype: PyCapsule
+)";
+
+const char* ccPointCloudPy_dlpack_device_doc= R"(
+Return the device of the tensor exported by :py:meth:`__dlpack__` (DLPack protocol).
+
+:return: (1, 0) (kDLCPU, device 0)
+:rtype: tuple
+)";
+
 const char* ccPointCloudPy_addScalarField_doc= R"(
 Creates a new scalar field and registers it.
 
@@ -48,6 +81,10 @@ Applies a GL transformation to the entity::
 
   this = rotMat*(this-rotCenter)+(rotCenter+trans)
 
+The content version of the cloud is incremented (see :py:meth:`getContentVersion`).
+For a pure translation, the octree is kept and its bounding box translated,
+otherwise it is dropped and rebuilt when needed (see :py:meth:`updateOctree`).
+
 :param ccGLMatrix trans: a ccGLMatrix structure)";
 
 const char* ccPointCloudPy_cloneThis_doc= R"(
@@ -97,6 +134,65 @@ However current IN & OUT scalar fields will stay up-to-date
 
 :param int index: index of scalar field to be deleted)";
 
+const char* ccPointCloudPy_evalScalarField_doc= R"(
+Computes a scalar field with an arithmetic expression, multithreaded, without temporary arrays.
+
+The expression is parsed once, then evaluated by blocks of points, directly on the scalar fields storage.
+The result is written in the scalar field `name`, created if it does not exist.
+It can be one of the scalar fields used in the expression.
+
+The variables are:
+
+- X, Y, Z: point coordinates,
+- Nx, Ny, Nz: normal components (the cloud must have normals),
+- scalar field names: names with spaces or special characters are written between brackets, e.g. `[Coord. Z]`.
+
+The operators are `+ - * / ^`, comparisons `< <= > >= == !=` (1 or 0), `&& || !`.
+The functions are `abs sqrt exp log log10 sin cos tan asin acos atan floor ceil isnan`,
+`atan2(y, x) pow(x, y) min(a, b) max(a, b)`, `clip(x, low, high)`, `if(condition, a, b)`, and the constant `pi`.
+
+Example: `cloud.evalScalarField("ratio", "clip(([a] - [b]) / [c], 0, 1)")`
+
+A ValueError is raised on syntax error or unknown variable.
+
+:param str name: name of the scalar field receiving the result
+:param str expression: the expression
+
+:return: index of the scalar field
+:rtype: int
+)";
+
+const char* ccPointCloudPy_evictScalarField_doc= R"(
+Releases the memory of a scalar field not in use: its values are written to a temporary file,
+and the scalar field is deleted from the cloud.
+
+The field is read back on first access by name (:py:meth:`getScalarField` with a name,
+:py:meth:`gather`, :py:meth:`filter`, :py:meth:`evalScalarField`), or with :py:meth:`restoreScalarField`.
+The temporary files are removed at the end of the Python session.
+Evicted fields are read back for the time of a save (:py:func:`cloudComPy.SavePointCloud`) or a clone
+(:py:meth:`cloneThis`, :py:meth:`partialClone`, :py:meth:`filterByMask`, :py:meth:`split`...):
+the file and the clones get the field, the cloud keeps it evicted.
+
+:param str name: name of the scalar field
+
+:return: size of the memory released, in bytes
+:rtype: int
+)";
+
+const char* ccPointCloudPy_evictScalarFields_doc= R"(
+Evicts the scalar fields of the cloud (see :py:meth:`evictScalarField`),
+for instance just after loading an attribute-heavy file.
+
+Eviction is explicit, there is no automatic eviction: under memory pressure, the script gives a budget,
+and the scalar fields are evicted until their memory is below the budget: the last added fields first,
+the displayed field last.
+
+:param float,optional maxBytes: (default 0) memory budget of the scalar fields in bytes, 0 to evict all the fields
+
+:return: number of evicted scalar fields
+:rtype: int
+)";
+
 const char* ccPointCloudPy_exportCoordToSF_doc= R"(
 Export coordinates to ScalarFields.
 
@@ -119,6 +215,51 @@ Export normals to ScalarFields.
 :rtype: bool
 )";
 
+const char* ccPointCloudPy_filter_doc= R"(
+Creates a new cloud with the points satisfying all the predicates, on several fields and ranges.
+
+Replaces a cascade of :py:meth:`filterPointsByScalarValue` calls: the combined predicate is evaluated
+in one parallel pass, then the new cloud is built once (see :py:meth:`filterByMask`).
+
+Each predicate is a tuple of 3 elements, the first one is a scalar field name or a coordinate ('X', 'Y', 'Z'):
+
+- `(field, min, max)`: min <= value <= max,
+- `(field, operator, value)`, operator in 'lt', 'le', 'gt', 'ge', 'eq', 'ne' (or '<', '<=', '>', '>=', '==', '!='),
+- `(field, 'in', values)` or `(field, 'notin', values)`: value in (not in) a list of values.
+
+Example: `cloud.filter([("Intensity", 10, 200), ("Classification", "in", [2, 6]), ("Z", "lt", 300)])`
+
+NaN values never satisfy a predicate, except 'ne' and 'notin'.
+A KeyError is raised for an unknown field, a ValueError for a malformed predicate.
+
+:param list predicates: list of predicates (tuples)
+
+:return: a new cloud with the selected points
+:rtype: ccPointCloud
+)";
+
+const char* ccPointCloudPy_filterByMask_doc= R"(
+Creates a new cloud with the points selected by a boolean mask, for instance a numpy predicate on coordinates
+or scalar fields.
+
+The coordinates, colors, normals and all the scalar fields are copied in one parallel pass,
+without temporary scalar field or ReferenceCloud. The global shift and scale are kept.
+
+:param ndarray mask: one dimension numpy array of bool, of the cloud size
+
+:return: a new cloud with the points where mask is `True`
+:rtype: ccPointCloud
+)";
+
+const char* ccPointCloudPy_filterMask_doc= R"(
+Evaluates the predicates of :py:meth:`filter` and returns the mask only, without creating a cloud.
+
+:param list predicates: list of predicates (tuples)
+
+:return: one dimension numpy array of bool, of the cloud size
+:rtype: ndarray
+)";
+
 const char* ccPointCloudPy_filterPointsByScalarValue_doc= R"(
 Filters out points whose scalar values falls into an interval.
 
@@ -133,13 +274,64 @@ See :py:meth:`setCurrentDisplayedScalarField` method.
 :rtype: ccPointCloud
 )";
 
+const char* ccPointCloudPy_fromDLPack_doc= R"(
+Create a new point cloud from a DLPack tensor of shape (nbPoints, 3).
+
+The tensor can be given as a DLPack capsule or as any object implementing the DLPack protocol
+(for instance a torch tensor or a numpy array). It must be on CPU, of type float32 or float64.
+Strided tensors are accepted. The coordinates are copied into the cloud storage
+(directly with memcpy when the tensor is contiguous and of the same type), and the tensor is released.
+
+:param tensor: a DLPack capsule or an object with a __dlpack__ method
+:param str,optional name: name of the new cloud, default empty
+
+:return: a new cloud
+:rtype: ccPointCloud
+)";
+
+const char* ccPointCloudPy_fromNpArrayGlobal_doc= R"(
+Set cloud coordinates from a Numpy array (nbPoints,3) of global coordinates, in double precision.
+
+The array must be of type float64 and C contiguous. Each point is converted to the local
+coordinates of the cloud, in a single multithreaded pass::
+
+  Plocal = (Pglobal + globalShift) * globalScale
+
+The current global shift and scale of the cloud are used (see :py:meth:`setGlobalShift`),
+unless autoShift is `True` and the coordinates are too large to be stored in simple precision:
+a suitable global shift is then computed from the first point.
+
+Cloud memory is reserved /resized automatically.
+
+:param ndarray array: global coordinates, shape (nbPoints, 3), float64
+:param bool,optional autoShift: default `False`, compute a new global shift if required
+)";
+
 const char* ccPointCloudPy_fuse_doc= R"(
 Append in place another cloud.
 
+The evicted and packed scalar fields of this cloud are restored first (they keep the former number of points),
+the evicted fields of the other cloud are read for the time of the fusion.
+
 No return.
 
 :param ccPointCloud other: cloud to fuse with this one, modification in place.
 )";
+const char* ccPointCloudPy_gather_doc= R"(
+Gets the coordinates and the scalar field values of a set of points, given by their indexes, in one call.
+
+Replaces a loop on :py:meth:`getPoint`: the copy is done in parallel, in new numpy arrays owned by Python.
+
+The indexes are a one dimension numpy array of integers (any integer type), or a boolean mask of the cloud size.
+An IndexError is raised if an index is out of range, a KeyError if a scalar field name is unknown.
+
+:param ndarray indexes: integer indexes or boolean mask
+:param list fields: *optional* list of scalar field names, default empty
+
+:return: a tuple (coordinates, dictionary): coordinates array of shape (n,3),
+         dictionary {scalar field name: array of shape (n,)}
+:rtype: tuple
+)";
 const char* ccPointCloudPy_getCurrentDisplayedScalarField_doc= R"(
 Returns the currently displayed scalar (or None if none)
 
@@ -172,12 +364,37 @@ Return the current 'out' ScalarField if there is one, otherwise None.
 :rtype: ScalarField or None
 )";
 
+const char* ccPointCloudPy_getEvictedScalarFieldNames_doc= R"(
+Gets the names of the evicted scalar fields of the cloud (see :py:meth:`evictScalarField`).
+
+:return: names of the evicted scalar fields
+:rtype: list
+)";
+
 const char* ccPointCloudPy_getNumberOfScalarFields_doc= R"(
 Return the number of scalar fields associated to the cloud.
 
 :return: number of scalar fields
 :rtype: int )";
 
+const char* ccPointCloudPy_getPackedScalarField_doc= R"(
+Gets a copy of a packed scalar field (see :py:meth:`packScalarField`), in its native type.
+
+The values are `code * scale + offset`. For integer types, the largest code stands for NaN.
+
+:param str name: name of the packed scalar field
+
+:return: a tuple (array, scale, offset): numpy array of the packed type (uint8, int16, uint16, int32 or float16)
+:rtype: tuple
+)";
+
+const char* ccPointCloudPy_getPackedScalarFieldNames_doc= R"(
+Gets the names of the packed scalar fields of the cloud (see :py:meth:`packScalarField`).
+
+:return: names of the packed scalar fields
+:rtype: list
+)";
+
 const char* ccPointCloudPy_getScalarField_doc= R"(
 Find by index: return a ScalarField if index is valid, otherwise None.
 
@@ -190,6 +407,9 @@ Find by index: return a ScalarField if index is valid, otherwise None.
 const char* ccPointCloudPy_getScalarFieldByName_doc= R"(
 Find by name: return a ScalarField if there is one with this name, otherwise None.
 
+An evicted or packed scalar field (see :py:meth:`evictScalarField`, :py:meth:`packScalarField`)
+is materialised on this first access.
+
 :param str name: name of the ScalarField
 
 :return: ScalarField
@@ -219,6 +439,39 @@ Return whether the cloud has ScalarFields.
 :rtype: bool
 )";
 
+const char* ccPointCloudPy_notifyGeometryUpdate_doc= R"(
+Records a modification of the coordinates done outside of the cloud methods
+(for instance, through the array given by :py:meth:`toNpArray`, while it is still in use).
+
+The content version of the cloud is incremented (see :py:meth:`getContentVersion`),
+the bounding box is invalidated, the octree and the KD-tree are dropped: they are rebuilt when needed
+(see :py:meth:`updateOctree`).
+)";
+
+const char* ccPointCloudPy_packScalarField_doc= R"(
+Packs a scalar field in a compact type, to save memory on fields not in use (classification, return number...).
+
+CloudCompare scalar fields always store one float (or double) per point: the packed field is removed
+from the cloud scalar fields, and kept with the cloud (in its metadata) until :py:meth:`unpackScalarField`.
+The encoding is multithreaded: `code = round((value - offset) / scale)`, clamped to the type range.
+
+The types are 'uint8', 'int16', 'uint16', 'int32' and 'float16'.
+For integer types the largest code is reserved for NaN.
+For 'float16', `(value - offset) / scale` is stored in half precision.
+The packed data is limited to 2 GiB (for instance 536 million points in 'int32'): a ValueError is raised beyond.
+The packed fields stay packed in a full clone (:py:meth:`cloneThis`) and in a BIN file. The clones on a subset
+of the points (:py:meth:`partialClone`, :py:meth:`crop2D`, :py:meth:`filterByMask`, :py:meth:`split`) get them
+unpacked, the cloud keeps them packed. :py:meth:`fuse` and :py:meth:`resize` unpack them first.
+
+:param str name: name of the scalar field
+:param str type: packed type
+:param float,optional scale: quantization step, default 1.
+:param float,optional offset: value of the code 0, default 0.
+
+:return: size of the packed data in bytes
+:rtype: int
+)";
+
 const char* ccPointCloudPy_partialClone_doc= R"(
 Creates a new point cloud object from a ReferenceCloud (selection)
 
@@ -229,6 +482,10 @@ See CClib documentation for more information about ReferenceClouds.
 
 :param ReferenceCloud selection: a ReferenceCloud structure (pointing to source)
 
+The selection can also be given as a numpy array: global indexes of the points (any integer type),
+or a boolean mask of the cloud size (see :py:meth:`ReferenceCloud.fromIndices`).
+An IndexError is raised if an index is out of range.
+
 :return: a tuple(ccPointCloud, warning) warning status, if not 0, 
          indicate out of memory errors (see CLONE_WARNINGS)
 :rtype: tuple
@@ -247,6 +504,27 @@ TODO: check the names in use.
 :rtype: bool
 )";
 
+const char* ccPointCloudPy_reorderSpatially_doc= R"(
+Reorders the points of the cloud in place, in Morton order (sorted by octree cell code at the deepest level).
+
+Neighbour points become close in memory, which speeds up the neighbourhood queries
+(curvature, distances...) on clouds stored in scan or file order.
+Coordinates, colors, normals, scalar fields, visibility and waveforms are permuted.
+The points with NaN coordinates, not in the octree, are moved at the end.
+Packed and evicted scalar fields (see :py:meth:`packScalarField`, :py:meth:`evictScalarField`)
+are restored first. The octree, the KD-tree and the scan grids, built on the point indexes, are deleted.
+The vertices of a mesh can't be reordered (ValueError).
+
+The returned permutation gives, for each new point index, the original index:
+``newValues = originalValues[perm]``, and to map back results computed after reordering:
+``originalValues[perm] = newValues``.
+
+:param int,optional maxThreadCount: (default 0) maximum number of threads, 0 for all the cores
+
+:return: the permutation
+:rtype: ndarray of uint32
+)";
+
 const char* ccPointCloudPy_reserve_doc= R"(
 Reserves memory for all the active features.
 
@@ -265,14 +543,30 @@ Resizes all the active features arrays.
 This method is meant to be called after having increased the cloud population
 (if the final number of insterted point is lower than the reserved size).
 Otherwise, it fills all new elements with blank values.
+The evicted and packed scalar fields are restored first (they keep the former number of points).
 
 :return: `True` if ok, `False` if there's not enough memory
 :rtype: bool
 )";
 
+const char* ccPointCloudPy_restoreScalarField_doc= R"(
+Reads back an evicted scalar field (see :py:meth:`evictScalarField`).
+
+The temporary file is kept until the end of the Python session: clones of the cloud may share it.
+
+:param str name: name of the evicted scalar field
+
+:return: index of the new scalar field
+:rtype: int
+)";
+
 const char* ccPointCloudPy_scale_doc= R"(
 Scale the cloud with separate factors along the 3 directions x,y,z and an optional center (default: (0,0,0)).
 
+The content version of the cloud is incremented (see :py:meth:`getContentVersion`).
+With a uniform positive factor, the octree is kept and its bounding box scaled,
+otherwise it is dropped and rebuilt when needed (see :py:meth:`updateOctree`).
+
 :param float x: scale x
 :param float y: scale y
 :param float z: scale z
@@ -309,12 +603,51 @@ Return the number of points in the cloud.
 :return: number of points in the cloud
 :rtype: int)";
 
+const char* ccPointCloudPy_split_doc= R"(
+Splits the cloud in two new clouds, with a boolean mask.
+
+Same as :py:meth:`filterByMask`, but returns also the rejected points.
+
+:param ndarray mask: one dimension numpy array of bool, of the cloud size
+
+:return: a tuple (kept, rejected): new clouds with the points where mask is `True` and `False`
+:rtype: tuple
+)";
+
+const char* ccPointCloudPy_toArrow_doc= R"(
+Export the cloud as an Arrow record batch, following the Arrow C Data Interface.
+
+The columns are, in order:
+
+- X, Y, Z: float32, converted from the interleaved coordinates (copy, multithreaded),
+- one column per scalar field, with the scalar field name: no copy, data stays owned by the cloud,
+- R, G, B, A: uint8, if the cloud has colors (copy, multithreaded),
+- Nx, Ny, Nz: float32, if the cloud has normals (decompressed, multithreaded).
+
+The evicted and packed scalar fields are restored first, and stay restored (their columns are not copied).
+As with :py:meth:`toNpArray`, the scalar field columns must not be used after the destruction of the cloud,
+or after a modification of its scalar fields.
+The result can be imported without copy in pyarrow, and then in Polars or DuckDB::
+
+  schema, array = cloud.toArrow()
+  batch = pyarrow.RecordBatch._import_from_c_capsule(schema, array)
+
+:return: a tuple of PyCapsules ('arrow_schema', 'arrow_array')
+:rtype: tuple
+)";
+
 const char* ccPointCloudPy_toNpArray_doc= R"(
 Wrap the PointCloud coordinates into a numpy Array, without copy.
 
 Returns a numpy Array of shape (number of Points, 3).
 Data is not copied, the numpy Array object does not own the data.
 
+The array is writable: when it is released (with all the arrays derived from it), the coordinates are
+compared with their state at the creation of the array (content hash, computed in parallel), and a modification
+increments the content version of the cloud and drops its octree and KD-tree (see :py:meth:`getContentVersion`).
+A read-only use keeps them, even if they are built while the array is in use.
+Call :py:meth:`notifyGeometryUpdate` to record a modification while the array is still in use.
+
 :return: numpy Array of shape (number of Points, 3)
 :rtype: ndarray
 )";
@@ -331,9 +664,37 @@ the numpy Array object and its data will be handled by the Python Garbage Collec
 :rtype: ndarray
 )";
 
+const char* ccPointCloudPy_toNpArrayGlobal_doc= R"(
+Get the PointCloud global coordinates into a new numpy Array, in double precision.
+
+The global coordinates are computed from the local ones stored in the cloud,
+in a single multithreaded pass::
+
+  Pglobal = Plocal / globalScale - globalShift
+
+Data is copied, the numpy Array object owns its data.
+
+:return: numpy Array of shape (number of Points, 3), float64
+:rtype: ndarray
+)";
+
 const char* ccPointCloudPy_translate_doc= R"(
 translate the cloud of (x,y,z).
 
+The content version of the cloud is incremented (see :py:meth:`getContentVersion`),
+the octree is kept and its bounding box translated.
+
 :param tuple translation: tuple: (x,y,z))";
 
+const char* ccPointCloudPy_unpackScalarField_doc= R"(
+Restores a packed scalar field (see :py:meth:`packScalarField`) as a regular scalar field, multithreaded.
+
+The packed data is removed. A ValueError is raised if a scalar field with the same name exists.
+
+:param str name: name of the packed scalar field
+
+:return: index of the new scalar field
+:rtype: int
+)";
+
 #endif /* CCPOINTCLOUDPY_DOCSTRINGS_HPP_ */
@@ -0,0 +1,266 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "cellKernelsPy.hpp"
+
+#include <ccPointCloud.h>
+#include <DgmOctree.h>
+#include <ScalarField.h>
+
+#include "ccPointCloudPy.hpp"
+#include "gilPy.hpp"
+#include "packedSFPy.hpp"
+#include "pyccCellKernels.h"
+#include "pyccKernelPlugins.h"
+#include "pyccTrace.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace bp = boost::python;
+
+bp::dict DgmOctree_runCellKernel_py(CCCoreLib::DgmOctree& self,
+                                    int level,
+                                    const std::string& name,
+                                    bp::list outputs,
+                                    int maxThreadCount,
+                                    bool overwrite)
+{
+    if (level < 1 || level > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL)
+    {
+        PyErr_SetString(PyExc_ValueError, "level out of range");
+        bp::throw_error_already_set();
+    }
+    std::unique_ptr<pyCC_CellKernel> kernel = pyCC_CreateCellKernel(name);
+    if (!kernel)
+    {
+        PyErr_Format(PyExc_KeyError, "unknown cell kernel '%s', see getCellKernels()", name.c_str());
+        bp::throw_error_already_set();
+    }
+    ccPointCloud* cloud = dynamic_cast<ccPointCloud*>(self.associatedCloud());
+    if (!cloud)
+    {
+        PyErr_SetString(PyExc_ValueError, "the octree is not associated to a ccPointCloud");
+        bp::throw_error_already_set();
+    }
+    std::vector<std::string> names;
+    for (int i = 0; i < bp::len(outputs); i++)
+        names.push_back(bp::extract<std::string>(outputs[i]));
+    if (name == "sf")
+    {
+        // the inputs are named by the outputs "field_stat": restore the packed and evicted fields first
+        if (names.empty())
+            materializeScalarFields_py(*cloud);
+        for (const std::string& output : names)
+        {
+            size_t sep = output.rfind('_');
+            if (sep != std::string::npos)
+                getScalarFieldByName_py(*cloud, QString::fromStdString(output.substr(0, sep)));
+        }
+    }
+    std::string error;
+    if (!kernel->setOutputs(names, *cloud, error))
+    {
+        PyErr_SetString(PyExc_ValueError, error.c_str());
+        bp::throw_error_already_set();
+    }
+    std::set<std::string> distinct;
+    for (const std::string& output : names)
+    {
+        if (!distinct.insert(output).second)
+        {
+            PyErr_Format(PyExc_ValueError, "duplicate output '%s'", output.c_str());
+            bp::throw_error_already_set();
+        }
+        if (!overwrite && cloud->getScalarFieldIndexByName(output.c_str()) >= 0)
+        {
+            PyErr_Format(PyExc_ValueError, "the cloud already has a scalar field '%s', use overwrite=True to replace it",
+                         output.c_str());
+            bp::throw_error_already_set();
+        }
+    }
+
+    bp::dict result;
+    std::vector<CCCoreLib::ScalarField*> fields;
+    std::vector<ScalarType*> data;
+    for (const std::string& output : names)
+    {
+        int sfIdx = cloud->getScalarFieldIndexByName(output.c_str());
+        if (sfIdx < 0)
+            sfIdx = cloud->addScalarField(output.c_str());
+        if (sfIdx < 0)
+        {
+            PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+            bp::throw_error_already_set();
+        }
+        CCCoreLib::ScalarField* sf = cloud->getScalarField(sfIdx);
+        fields.push_back(sf);
+        data.push_back(sf->data());
+        result[output] = sfIdx;
+    }
+
+    bool ok = false;
+    {
+        GILRelease_py noGIL;
+        ok = pyCC_RunCellKernel(self, static_cast<unsigned char>(level), *kernel, data, maxThreadCount);
+        for (CCCoreLib::ScalarField* sf : fields)
+            sf->computeMinAndMax();
+    }
+    CCTRACE("runCellKernel " << name << ": " << names.size() << " outputs, ok: " << ok);
+    if (!ok)
+    {
+        PyErr_SetString(PyExc_MemoryError, "the cell kernel failed, or not enough memory");
+        bp::throw_error_already_set();
+    }
+    return result;
+}
+
+bp::dict getCellKernels_py()
+{
+    bp::dict kernels;
+    for (const auto& kernel : pyCC_CellKernelDescriptions())
+        kernels[kernel.first] = kernel.second;
+    return kernels;
+}
+
+bp::dict loadKernel_py(const QString& path)
+{
+    std::string error;
+    const pyCC_KernelPlugin* plugin = pyCC_LoadKernelPlugin(path, error);
+    if (!plugin)
+    {
+        PyErr_SetString(PyExc_ValueError, error.c_str());
+        bp::throw_error_already_set();
+    }
+    CCTRACE("loadKernel " << plugin->name << " from " << path.toStdString());
+    bp::list outputs;
+    for (const std::string& output : plugin->outputs)
+        outputs.append(output);
+    bp::dict info;
+    info["name"] = plugin->name;
+    info["description"] = plugin->description;
+    info["path"] = plugin->path;
+    info["inputCount"] = plugin->inputCount;
+    info["outputs"] = outputs;
+    return info;
+}
+
+bp::dict getLoadedKernels_py()
+{
+    bp::dict kernels;
+    for (const auto& kernel : pyCC_KernelPluginDescriptions())
+        kernels[kernel.first] = kernel.second;
+    return kernels;
+}
+
+bp::dict DgmOctree_runPointKernel_py(CCCoreLib::DgmOctree& self,
+                                     const std::string& name,
+                                     double radius,
+                                     bp::list inputs,
+                                     int maxThreadCount,
+                                     bool overwrite)
+{
+    const pyCC_KernelPlugin* plugin = pyCC_GetKernelPlugin(name);
+    if (!plugin)
+    {
+        PyErr_Format(PyExc_KeyError, "unknown point kernel '%s', see loadKernel()", name.c_str());
+        bp::throw_error_already_set();
+    }
+    if (!(radius > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "radius must be positive");
+        bp::throw_error_already_set();
+    }
+    ccPointCloud* cloud = dynamic_cast<ccPointCloud*>(self.associatedCloud());
+    if (!cloud || cloud->size() == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "the octree is not associated to a non empty ccPointCloud");
+        bp::throw_error_already_set();
+    }
+    if (bp::len(inputs) != plugin->inputCount)
+    {
+        PyErr_Format(PyExc_ValueError, "the kernel '%s' requires %u input scalar fields", name.c_str(), plugin->inputCount);
+        bp::throw_error_already_set();
+    }
+    std::vector<const ScalarType*> in;
+    for (int i = 0; i < bp::len(inputs); i++)
+    {
+        std::string input = bp::extract<std::string>(inputs[i]);
+        // the kernel reads the inputs of the neighbours while the outputs are written: no field in both
+        if (std::find(plugin->outputs.begin(), plugin->outputs.end(), input) != plugin->outputs.end())
+        {
+            PyErr_Format(PyExc_ValueError, "the input scalar field '%s' is also an output of the kernel '%s'",
+                         input.c_str(), name.c_str());
+            bp::throw_error_already_set();
+        }
+        CCCoreLib::ScalarField* sf = getScalarFieldByName_py(*cloud, QString::fromStdString(input));
+        if (!sf)
+        {
+            PyErr_Format(PyExc_ValueError, "unknown scalar field '%s'", input.c_str());
+            bp::throw_error_already_set();
+        }
+        in.push_back(sf->data());
+    }
+    if (!overwrite)
+    {
+        for (const std::string& output : plugin->outputs)
+        {
+            if (cloud->getScalarFieldIndexByName(output.c_str()) >= 0)
+            {
+                PyErr_Format(PyExc_ValueError, "the cloud already has a scalar field '%s', use overwrite=True to replace it",
+                             output.c_str());
+                bp::throw_error_already_set();
+            }
+        }
+    }
+
+    bp::dict result;
+    std::vector<CCCoreLib::ScalarField*> fields;
+    std::vector<ScalarType*> out;
+    for (const std::string& output : plugin->outputs)
+    {
+        int sfIdx = cloud->getScalarFieldIndexByName(output.c_str());
+        if (sfIdx < 0)
+            sfIdx = cloud->addScalarField(output.c_str());
+        if (sfIdx < 0)
+        {
+            PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+            bp::throw_error_already_set();
+        }
+        CCCoreLib::ScalarField* sf = cloud->getScalarField(sfIdx);
+        fields.push_back(sf);
+        out.push_back(sf->data());
+        result[output] = sfIdx;
+    }
+
+    bool ok = false;
+    {
+        GILRelease_py noGIL;
+        ok = pyCC_RunPointKernel(self, radius, *plugin, in, out, maxThreadCount);
+        for (CCCoreLib::ScalarField* sf : fields)
+            sf->computeMinAndMax();
+    }
+    CCTRACE("runPointKernel " << name << " radius " << radius << ", ok: " << ok);
+    if (!ok)
+    {
+        PyErr_Format(PyExc_RuntimeError, "the point kernel '%s' stopped the computation, or not enough memory", name.c_str());
+        bp::throw_error_already_set();
+    }
+    return result;
+}
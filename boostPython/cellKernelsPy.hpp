@@ -0,0 +1,70 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CELLKERNELSPY_HPP_
+#define CELLKERNELSPY_HPP_
+
+#include <boost/python.hpp>
+
+#include <QString>
+
+#include <string>
+
+namespace CCCoreLib
+{
+    class DgmOctree;
+}
+
+//! run a registered cell kernel on all the cells of a level, writing its outputs in scalar fields of the cloud
+/*! The scalar fields are named after the outputs, created if needed.
+ *  An existing scalar field is overwritten only with overwrite, ValueError otherwise.
+ *  Multithreaded (DgmOctree::executeFunctionForAllCellsAtLevel), GIL released.
+ *  \return {output name: scalar field index}
+ */
+boost::python::dict DgmOctree_runCellKernel_py(CCCoreLib::DgmOctree& self,
+                                               int level,
+                                               const std::string& name,
+                                               boost::python::list outputs = boost::python::list(),
+                                               int maxThreadCount = 0,
+                                               bool overwrite = false);
+
+//! the registered cell kernels: {name: description}
+boost::python::dict getCellKernels_py();
+
+//! load a point kernel plugin (shared library, see pyccKernelABI.h)
+/*! \return {"name", "description", "path", "inputCount", "outputs"}
+ */
+boost::python::dict loadKernel_py(const QString& path);
+
+//! the loaded point kernel plugins: {name: description}
+boost::python::dict getLoadedKernels_py();
+
+//! run a point kernel plugin on all the points, with their neighbours within the radius
+/*! The scalar fields are named after the outputs.
+ *  An existing scalar field is overwritten only with overwrite, ValueError otherwise.
+ *  Multithreaded (DgmOctree::executeFunctionForAllCellsAtLevel), GIL released.
+ *  \return {output name: scalar field index}
+ */
+boost::python::dict DgmOctree_runPointKernel_py(CCCoreLib::DgmOctree& self,
+                                                const std::string& name,
+                                                double radius,
+                                                boost::python::list inputs = boost::python::list(),
+                                                int maxThreadCount = 0,
+                                                bool overwrite = false);
+
+#endif /* CELLKERNELSPY_HPP_ */
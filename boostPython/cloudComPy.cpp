@@ -24,6 +24,7 @@
 #include "ScalarFieldPy.hpp"
 #include "ccGenericCloudPy.hpp"
 #include "ccOctreePy.hpp"
+#include "kdTreePy.hpp"
 #include "ccPointCloudPy.hpp"
 #include "ccMeshPy.hpp"
 #include "ccPrimitivesPy.hpp"
@@ -32,6 +33,11 @@
 #include "geometricalAnalysisToolsPy.hpp"
 #include "registrationToolsPy.hpp"
 #include "cloudSamplingToolsPy.hpp"
+#include "arrowPy.hpp"
+#include "cellKernelsPy.hpp"
+#include "corridorPy.hpp"
+#include "packedSFPy.hpp"
+#include "voxelAggregatePy.hpp"
 
 #include "initCC.h"
 #include "pyCC.h"
@@ -43,6 +49,7 @@
 #include <ccNormalVectors.h>
 
 #include <QString>
+#include <memory>
 #include <vector>
 
 #include "pyccTrace.h"
@@ -71,6 +78,25 @@ const char* getScalarType()
     return CC_NPY_FLOAT_STRING;
 }
 
+//! the evicted scalar fields are read back for the time of the save, see EvictedFieldsGuard_py
+CC_FILE_ERROR SavePointCloud_py(ccPointCloud* cloud, const QString& filename)
+{
+    EvictedFieldsGuard_py evicted(cloud);
+    evicted.check();
+    return SavePointCloud(cloud, filename);
+}
+
+CC_FILE_ERROR SaveEntities_py(std::vector<ccHObject*> entities, const QString& filename)
+{
+    std::vector<std::unique_ptr<EvictedFieldsGuard_py>> evicted;
+    for (ccHObject* entity : entities)
+    {
+        evicted.emplace_back(new EvictedFieldsGuard_py(entity));
+        evicted.back()->check();
+    }
+    return SaveEntities(entities, filename);
+}
+
 struct ICPres
 {
     ccPointCloud* aligned;
@@ -122,6 +148,9 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(loadPolyline_overloads, loadPolyline, 1, 6);
 BOOST_PYTHON_FUNCTION_OVERLOADS(GetPointCloudRadius_overloads, GetPointCloudRadius, 1, 2);
 BOOST_PYTHON_FUNCTION_OVERLOADS(ICP_py_overloads, ICP_py, 8, 13);
 BOOST_PYTHON_FUNCTION_OVERLOADS(computeNormals_overloads, computeNormals, 1, 12);
+BOOST_PYTHON_FUNCTION_OVERLOADS(extractCorridor_py_overloads, extractCorridor_py, 3, 4);
+BOOST_PYTHON_FUNCTION_OVERLOADS(fromArrow_py_overloads, fromArrow_py, 1, 2);
+BOOST_PYTHON_FUNCTION_OVERLOADS(voxelAggregate_py_overloads, voxelAggregate_py, 1, 4);
 
 BOOST_PYTHON_MODULE(cloudComPy)
 {
@@ -134,6 +163,7 @@ BOOST_PYTHON_MODULE(cloudComPy)
     export_ccGenericCloud();
     export_ccPolyline();
     export_ccOctree();
+    export_ccKDTree();
     export_ccPointCloud();
     export_ccMesh();
     export_ccPrimitives();
@@ -216,9 +246,9 @@ BOOST_PYTHON_MODULE(cloudComPy)
                                cloudComPy_loadPolyline_doc)
         [return_value_policy<reference_existing_object>()]);
 
-    def("SavePointCloud", SavePointCloud, cloudComPy_SavePointCloud_doc);
+    def("SavePointCloud", SavePointCloud_py, cloudComPy_SavePointCloud_doc);
 
-    def("SaveEntities", SaveEntities, cloudComPy_SaveEntities_doc);
+    def("SaveEntities", SaveEntities_py, cloudComPy_SaveEntities_doc);
 
     def("initCC", &initCC_py, cloudComPy_initCC_doc);
 
@@ -245,4 +275,21 @@ BOOST_PYTHON_MODULE(cloudComPy)
     def("ICP", ICP_py, ICP_py_overloads(cloudComPy_ICP_doc));
 
     def("computeNormals", computeNormals, computeNormals_overloads(cloudComPy_computeNormals_doc));
+
+    def("extractCorridor", extractCorridor_py,
+        extractCorridor_py_overloads(args("cloud", "polyline", "radius", "step"), cloudComPy_extractCorridor_doc));
+
+    def("fromArrow", fromArrow_py,
+        fromArrow_py_overloads(args("batch", "name"), cloudComPy_fromArrow_doc)
+        [return_value_policy<reference_existing_object>()]);
+
+    def("getCellKernels", getCellKernels_py, cloudComPy_getCellKernels_doc);
+
+    def("getLoadedKernels", getLoadedKernels_py, cloudComPy_getLoadedKernels_doc);
+
+    def("loadKernel", loadKernel_py, args("path"), cloudComPy_loadKernel_doc);
+
+    def("voxelAggregate", voxelAggregate_py,
+        voxelAggregate_py_overloads(args("cloud", "level", "cellSize", "aggregates"), cloudComPy_voxelAggregate_doc)
+        [return_value_policy<reference_existing_object>()]);
 }
@@ -124,6 +124,9 @@ Usage: see ccPolyline doc.)";
 const char* cloudComPy_SavePointCloud_doc= R"(
 Save a 3D cloud in a file.
 
+The evicted scalar fields (see :py:meth:`ccPointCloud.evictScalarField`) are read back for the save,
+and evicted again after.
+
 :param ccPointCloud cloud: the cloud to save.
 :param str filename: The cloud file.
 
@@ -133,6 +136,8 @@ Save a 3D cloud in a file.
 const char* cloudComPy_SaveEntities_doc= R"(
 Save a list of entities (cloud, meshes, primitives...) in a file: use bin format!
 
+The evicted scalar fields of the clouds are saved, as with :py:func:`SavePointCloud`.
+
 :param entities: list of entities
 :type entities: list of :py:class:`ccHObject`
 :param str filename: The entities file.
@@ -192,4 +197,114 @@ Compute normals on a list of clouds and meshes.
 :param int,optional mstNeighbors: default 6, for Minimum Spanning Tree
 :param bool,optional computePerVertexNormals: default `True`, apply on mesh, if `True`, compute on vertices, if `False`, compute on triangles)";
 
+const char* cloudComPy_extractCorridor_doc= R"(
+Extracts the points of a cloud within a radius of each segment of a polyline (road, powerline corridors, profiles).
+
+Each segment is walked natively with the progressive cylindrical neighbourhood of the octree
+(see :py:meth:`ccOctree.getPointsInCylindricalNeighbourhoodProgressive`): the cylinder grows by one octree cell
+at each step, keeping the candidates found ahead for the next step. The segments are processed in parallel.
+The octree of the cloud is computed if needed. The polyline and the cloud must share the same coordinate system.
+A point near a vertex may belong to two consecutive segments, on the inner side of a bend.
+On the outer side of a bend, the points within the radius of the vertex but beyond both segments
+go to the segment they overshoot the least (the next one if equal), at the along position and distance of the vertex.
+
+:param ccGenericPointCloud cloud: the cloud
+:param ccPolyline polyline: the corridor axis, closed or not
+:param float radius: the corridor radius
+:param float,optional step: default 0, the growth step of the cylinders (octree cell size),
+                            0 for an automatic choice from the radius, at least radius/16 (smaller values are raised)
+
+:return: dictionary of numpy arrays, in CSR layout by segment, the points of the segment s being
+         in [offsets[s], offsets[s+1][, sorted by along:
+
+         - "offsets": int64 (number of segments + 1)
+         - "indexes": point indexes, int64
+         - "along": along-track coordinate, curvilinear abscissa from the start of the polyline, float64
+         - "across": cross-track coordinate, signed horizontal offset from the segment, positive on the left, float64
+         - "distance": distance from the segment axis (from the vertex, beyond the segment ends), float64
+
+:rtype: dict )";
+
+const char* cloudComPy_fromArrow_doc= R"(
+Create a new point cloud from an Arrow record batch, following the Arrow C Data Interface.
+
+The record batch is given by an object implementing the Arrow PyCapsule interface (``__arrow_c_array__``),
+for instance a ``pyarrow.RecordBatch``, or directly by a tuple of PyCapsules ('arrow_schema', 'arrow_array').
+
+- X, Y, Z (or x, y, z) numeric columns are required, for the coordinates,
+- R, G, B and optional A uint8 columns give the colors,
+- Nx, Ny, Nz columns give the normals,
+- all the other numeric columns become scalar fields, null values are set to NaN
+  (a column without name becomes the scalar field "column j", j being the column index).
+
+A ValueError is raised for null values in the coordinates, colors or normals, or for two scalar field columns
+with the same name, a MemoryError if the cloud can't be allocated.
+Non numeric columns are ignored. Data is copied into the cloud, each column conversion is multithreaded.
+
+:param batch: the record batch
+:param str,optional name: name of the new cloud, default empty
+
+:return: a new cloud
+:rtype: ccPointCloud )";
+
+const char* cloudComPy_getCellKernels_doc= R"(
+Returns the native cell kernels available for :py:meth:`~.DgmOctree.runCellKernel`.
+
+:return: dictionary {kernel name: description of the kernel and its outputs}
+:rtype: dict )";
+
+const char* cloudComPy_getLoadedKernels_doc= R"(
+Returns the point kernel plugins loaded by :py:func:`loadKernel`.
+
+:return: dictionary {kernel name: description}
+:rtype: dict )";
+
+const char* cloudComPy_loadKernel_doc= R"(
+Loads a point kernel plugin: a shared library compiled by the user, run by :py:meth:`~.DgmOctree.runPointKernel`.
+
+A point kernel computes, for each point, outputs from its neighbours within a radius: custom local features
+run at native speed, in parallel, without a Python loop on the points.
+The plugin is written in C or C++ against the C header ``pyccKernelABI.h`` only (no CloudCompare, Qt or Python
+dependency), and exports the functions described there. It must be thread safe.
+``tests/pyccKernelExample.c`` is an example.
+
+The library stays loaded until the end of the process. Loading again the same file returns the same kernel.
+A ValueError is raised if the file is not a plugin, if its ABI version differs from the one of CloudComPy,
+if its output names are empty or repeated, or if a kernel of the same name is already loaded from another file.
+
+:param str path: the path of the shared library (.so, .dll, .dylib)
+
+:return: dictionary {"name": kernel name, "description": str, "path": str, "inputCount": number of input scalar fields,
+         "outputs": list of output names}
+:rtype: dict )";
+
+const char* cloudComPy_voxelAggregate_doc= R"(
+Create a new point cloud with one point per non empty octree cell (voxel) and per cell statistics.
+
+Beyond :py:meth:`CloudSamplingTools.resampleCloudWithOctreeAtLevel`, any scalar field, the coordinates,
+the colors and the normals can be aggregated, in one parallel pass over the octree cells.
+The point of each cell is the centroid of its points.
+The octree of the cloud is computed if needed. The octree cells are cubes, subdivided by 2 at each level:
+with a cell size instead of a level, the first level with a cell size lower or equal is used.
+
+The aggregates are given by a dictionary ``{field: stat or [stats]}``:
+
+- field: "X", "Y", "Z" for the coordinates, or a scalar field name,
+  stat: "mean", "min", "max", "sum", "std" or "median". NaN values are ignored.
+  The new scalar fields are named field_stat, for instance "Z_max".
+  A statistic given twice for a field raises a ValueError.
+- "count": `True` adds a scalar field "count" with the number of points in the cell,
+- "color": "mean" gives the mean color of the cell,
+- "normal": "mean" gives the normalized mean normal of the cell.
+
+Example: ``cc.voxelAggregate(cloud, 8, 0., {"Intensity": "mean", "Z": ["min", "max"], "count": True})``
+
+:param ccPointCloud cloud: the cloud
+:param int,optional level: default 0, octree level, 0 to use cellSize
+:param float,optional cellSize: default 0, maximum size of a cell, used when level is 0
+:param dict,optional aggregates: default empty, the statistics to compute
+
+:return: a new cloud named cloudName.voxels
+:rtype: ccPointCloud )";
+
 #endif /* CLOUDCOMPY_DOCSTRINGS_HPP_ */
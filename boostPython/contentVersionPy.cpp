@@ -0,0 +1,81 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "contentVersionPy.hpp"
+
+#include <ccPointCloud.h>
+
+#include "kdTreePy.hpp"
+#include "octreeIOPy.hpp"
+#include "pyccTrace.h"
+
+namespace bp = boost::python;
+
+//! metadata key of the content version
+static const char* CONTENT_VERSION_KEY = "PYCC_ContentVersion";
+
+//! state of a view on the coordinates, owned by a PyCapsule
+struct CoordsViewGuard_py
+{
+    PyObject* cloud;
+    uint64_t hash;
+};
+
+uint64_t ccGenericPointCloud_getContentVersion_py(const ccGenericPointCloud& self)
+{
+    return self.getMetaData(CONTENT_VERSION_KEY).toULongLong(); // 0 if not set
+}
+
+void ccGenericPointCloud_notifyGeometryUpdate_py(ccGenericPointCloud& self)
+{
+    uint64_t version = ccGenericPointCloud_getContentVersion_py(self) + 1;
+    self.setMetaData(CONTENT_VERSION_KEY, QVariant(static_cast<qulonglong>(version)));
+    ccPointCloud* pc = dynamic_cast<ccPointCloud*>(&self);
+    if (pc)
+        pc->invalidateBoundingBox();
+    self.notifyGeometryUpdate();
+    self.deleteOctree();
+    ccGenericPointCloud_deleteKDTree_py(self);
+    CCTRACE("content version: " << version);
+}
+
+static void CoordsView_capsuleDestructor(PyObject* capsule)
+{
+    CoordsViewGuard_py* guard = static_cast<CoordsViewGuard_py*>(PyCapsule_GetPointer(capsule, "pycc_coords_view"));
+    if (guard == nullptr)
+    {
+        PyErr_WriteUnraisable(capsule);
+        return;
+    }
+    bp::extract<ccGenericPointCloud*> cloud(guard->cloud);
+    if (cloud.check() && cloud() && ccGenericPointCloud_contentHash_py(*cloud()) != guard->hash)
+        ccGenericPointCloud_notifyGeometryUpdate_py(*cloud());
+    Py_DECREF(guard->cloud);
+    delete guard;
+}
+
+bp::object coordsViewOwner_py(bp::object cloud)
+{
+    ccGenericPointCloud& self = bp::extract<ccGenericPointCloud&>(cloud);
+    CoordsViewGuard_py* guard = new CoordsViewGuard_py;
+    guard->cloud = cloud.ptr();
+    Py_INCREF(guard->cloud);
+    // always hashed: an octree or a KD-tree may be built while the view is in use, a parallel hash costs much less
+    guard->hash = ccGenericPointCloud_contentHash_py(self);
+    return bp::object(bp::handle<>(PyCapsule_New(guard, "pycc_coords_view", &CoordsView_capsuleDestructor)));
+}
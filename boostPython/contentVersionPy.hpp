@@ -0,0 +1,63 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CONTENTVERSIONPY_HPP_
+#define CONTENTVERSIONPY_HPP_
+
+#include <boost/python.hpp>
+
+#include <cstdint>
+
+#include <ccGenericPointCloud.h>
+#include <ccOctree.h>
+
+//! content version of the cloud, incremented at each modification of the coordinates done through the Python API
+/*! 0 for a cloud never modified. Stored in the cloud metadata: saved with it in BIN files, and restored on load.
+ */
+uint64_t ccGenericPointCloud_getContentVersion_py(const ccGenericPointCloud& self);
+
+//! record a modification of the coordinates
+/*! Increments the content version, invalidates the bounding box and the display buffers,
+ *  and drops the structures built on the coordinates (octree, KD-tree): they are rebuilt when needed.
+ */
+void ccGenericPointCloud_notifyGeometryUpdate_py(ccGenericPointCloud& self);
+
+//! owner of a writable view on the coordinates (numpy array or DLPack tensor), keeping the cloud wrapper alive
+/*! When the last view is released, the modification is recorded if the coordinates have changed
+ *  (comparison of the content hashes taken at the creation and at the release of the view):
+ *  a read-only use keeps the octree and the KD-tree, even when they are built while the view is in use.
+ */
+boost::python::object coordsViewOwner_py(boost::python::object cloud);
+
+//! apply transform() to the coordinates, then keep the octree if keepOctree(octree) can update its bounds
+/*! keepOctree returns false when the octree structure is not preserved (the octree is then rebuilt when needed).
+ */
+template<typename Transform, typename KeepOctree>
+void transformCoordinates_py(ccGenericPointCloud& self, Transform transform, KeepOctree keepOctree)
+{
+    ccOctree::Shared octree = self.getOctree();
+    bool withProxy = (self.getOctreeProxy() != nullptr);
+    if (octree)
+        self.deleteOctree(); // detached, not destroyed: the cloud methods must not update it a second time
+    transform();
+    ccGenericPointCloud_notifyGeometryUpdate_py(self);
+    if (octree && keepOctree(*octree))
+        self.setOctree(octree, withProxy);
+}
+
+#endif /* CONTENTVERSIONPY_HPP_ */
@@ -0,0 +1,259 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "corridorPy.hpp"
+
+#include <boost/python/numpy.hpp>
+
+#include <ccGenericPointCloud.h>
+#include <ccOctree.h>
+#include <ccPolyline.h>
+#include <DgmOctree.h>
+
+#include "gilPy.hpp"
+#include "octreeIOPy.hpp"
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
+
+namespace
+{
+    //! a point of a corridor: coordinates in the frame of the segment
+    struct CorridorPoint_py
+    {
+        double along;       //!< curvilinear abscissa from the start of the polyline
+        double across;      //!< signed horizontal offset from the axis, positive on the left
+        double distance;    //!< distance from the axis
+        unsigned index;
+    };
+
+    //! a segment of the polyline, in double precision
+    struct CorridorSegment_py
+    {
+        CCVector3d A;
+        CCVector3d dir;     //!< unit direction, null for a segment of length 0
+        CCVector3d left;    //!< horizontal normal, on the left
+        double length = 0;
+
+        //! abscissa of the projection of P on the segment line, from A
+        double abscissa(const CCVector3& P) const { return (CCVector3d(P.x, P.y, P.z) - A).dot(dir); }
+    };
+
+    //! below, the number of steps grows without reducing the candidates much
+    const double minStepOverRadius = 1. / 16;
+}
+
+bp::dict extractCorridor_py(ccGenericPointCloud* cloud, ccPolyline* polyline, double radius, double step)
+{
+    if (!cloud || !polyline)
+    {
+        PyErr_SetString(PyExc_ValueError, "a cloud and a polyline are required");
+        bp::throw_error_already_set();
+    }
+    if (!(radius > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "the radius must be strictly positive");
+        bp::throw_error_already_set();
+    }
+    ccOctree::Shared octree = ccGenericPointCloud_updateOctree_py(*cloud);
+    if (!octree)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory, or empty cloud");
+        bp::throw_error_already_set();
+    }
+    // the cylinders grow by one cell at each step
+    unsigned char sphereLevel = octree->findBestLevelForAGivenNeighbourhoodSizeExtraction(static_cast<PointCoordinateType>(radius));
+    unsigned char level = sphereLevel;
+    if (step > 0 && step < radius * minStepOverRadius)
+    {
+        CCTRACE("extractCorridor: step " << step << " too small for the radius, set to " << radius * minStepOverRadius);
+        step = radius * minStepOverRadius;
+    }
+    if (step > 0)
+    {
+        level = CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL;
+        for (unsigned char l = 1; l < CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL; l++)
+        {
+            if (octree->getCellSize(l) <= step)
+            {
+                level = l;
+                break;
+            }
+        }
+    }
+
+    unsigned nbVertices = polyline->size();
+    unsigned nbSegments = (nbVertices < 2) ? 0 : (polyline->isClosed() ? nbVertices : nbVertices - 1);
+    std::vector<double> startAlong(nbSegments + 1, 0.);
+    std::vector<CorridorSegment_py> geometry(nbSegments);
+    for (unsigned s = 0; s < nbSegments; s++)
+    {
+        const CCVector3* A = polyline->getPoint(s);
+        const CCVector3* B = polyline->getPoint((s + 1) % nbVertices);
+        CorridorSegment_py& seg = geometry[s];
+        seg.A = CCVector3d(A->x, A->y, A->z);
+        seg.dir = CCVector3d(B->x, B->y, B->z) - seg.A;
+        seg.length = seg.dir.norm();
+        if (seg.length > 0)
+            seg.dir /= seg.length;
+        seg.left = CCVector3d(-seg.dir.y, seg.dir.x, 0);
+        if (seg.left.norm2() < 1.e-12)
+            seg.left = CCVector3d(1, 0, 0);
+        seg.left.normalize();
+        startAlong[s + 1] = startAlong[s] + seg.length;
+    }
+    // segments meeting at an interior vertex, -1 at the ends of an open polyline
+    auto previousSegment = [&](size_t s) { return (s > 0) ? static_cast<long>(s) - 1 : (polyline->isClosed() ? static_cast<long>(nbSegments) - 1 : -1); };
+    auto nextSegment = [&](size_t s) { return (s + 1 < nbSegments) ? static_cast<long>(s) + 1 : (polyline->isClosed() ? 0L : -1L); };
+
+    std::vector<std::vector<CorridorPoint_py>> segments(nbSegments);
+    {
+        GILRelease_py noGIL;
+        std::vector<pyCC_Range> tasks;
+        for (size_t s = 0; s < nbSegments; s++)
+            tasks.push_back({ s, s, s + 1 });
+        pyCC_ParallelForRanges(tasks, [&](const pyCC_Range& r)
+        {
+            const CorridorSegment_py& seg = geometry[r.chunk];
+            const CCVector3 A = *polyline->getPoint(static_cast<unsigned>(r.chunk));
+            const CCVector3 B = *polyline->getPoint(static_cast<unsigned>((r.chunk + 1) % nbVertices));
+            const double length = seg.length;
+            if (length == 0)
+                return;
+            const CCVector3 dir = (B - A) / static_cast<PointCoordinateType>(length);
+            const CCVector3d& dirD = seg.dir;
+            const CCVector3d& left = seg.left;
+
+            CCCoreLib::DgmOctree::ProgressiveCylindricalNeighbourhood cyl;
+            cyl.center = (A + B) / 2;
+            cyl.dir = dir;
+            cyl.radius = static_cast<PointCoordinateType>(radius);
+            cyl.maxHalfLength = static_cast<PointCoordinateType>(length / 2);
+            cyl.level = level;
+            std::vector<CorridorPoint_py>& found = segments[r.chunk];
+            // each step returns the points of the new slices, the candidates found ahead are kept in the state
+            const size_t maxSteps = static_cast<size_t>(std::ceil(cyl.maxHalfLength / octree->getCellSize(level))) + 2;
+            for (size_t k = 0; k < maxSteps && cyl.currentHalfLength < cyl.maxHalfLength; k++)
+            {
+                octree->getPointsInCylindricalNeighbourhoodProgressive(cyl);
+                for (const CCCoreLib::DgmOctree::PointDescriptor& p : cyl.neighbours)
+                {
+                    const CCVector3 d = *p.point - A;
+                    const CCVector3d AP(d.x, d.y, d.z);
+                    double t = AP.dot(dirD);
+                    if (t < 0 || t > length)
+                        continue;
+                    double distance = std::sqrt(std::max(0., AP.norm2() - t * t));
+                    if (distance > radius)
+                        continue;
+                    found.push_back({ startAlong[r.chunk] + t, AP.dot(left), distance, p.pointIndex });
+                }
+                cyl.neighbours.clear();
+            }
+
+            // on the outer side of a bend, the points near the vertex are beyond both segments:
+            // they go to the segment they overshoot the least (the next one if equal), at the distance of the vertex
+            for (int end = 0; end < 2; end++)
+            {
+                const long other = (end == 0) ? previousSegment(r.chunk) : nextSegment(r.chunk);
+                if (other < 0 || geometry[other].length == 0)
+                    continue;
+                const CorridorSegment_py& otherSeg = geometry[other];
+                const CCVector3 V = (end == 0) ? A : B;
+                CCCoreLib::DgmOctree::NeighboursSet inSphere;
+                octree->getPointsInSphericalNeighbourhood(V, static_cast<PointCoordinateType>(radius), inSphere, sphereLevel);
+                for (const CCCoreLib::DgmOctree::PointDescriptor& p : inSphere)
+                {
+                    const double t = seg.abscissa(*p.point);
+                    const double tOther = otherSeg.abscissa(*p.point);
+                    double overshoot = 0;
+                    double overshootOther = 0;
+                    if (end == 0)
+                    {
+                        overshoot = -t;
+                        overshootOther = tOther - otherSeg.length;
+                        if (overshoot <= 0 || overshootOther <= 0 || overshoot > overshootOther)
+                            continue;
+                    }
+                    else
+                    {
+                        overshoot = t - length;
+                        overshootOther = -tOther;
+                        if (overshoot <= 0 || overshootOther <= 0 || overshoot >= overshootOther)
+                            continue;
+                    }
+                    const CCVector3 d = *p.point - A;
+                    const CCVector3d AP(d.x, d.y, d.z);
+                    found.push_back({ startAlong[r.chunk] + (end == 0 ? 0. : length), AP.dot(left),
+                                      std::sqrt(p.squareDistd), p.pointIndex });
+                }
+            }
+
+            std::sort(found.begin(), found.end(),
+                      [](const CorridorPoint_py& a, const CorridorPoint_py& b) { return a.index < b.index; });
+            found.erase(std::unique(found.begin(), found.end(),
+                                    [](const CorridorPoint_py& a, const CorridorPoint_py& b) { return a.index == b.index; }),
+                        found.end());
+            std::sort(found.begin(), found.end(),
+                      [](const CorridorPoint_py& a, const CorridorPoint_py& b) { return a.along < b.along; });
+        });
+    }
+
+    size_t total = 0;
+    for (const auto& found : segments)
+        total += found.size();
+    bnp::ndarray offsets = bnp::empty(bp::make_tuple(nbSegments + 1), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray indexes = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray along = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<double>());
+    bnp::ndarray across = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<double>());
+    bnp::ndarray distance = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<double>());
+    int64_t* pOff = reinterpret_cast<int64_t*>(offsets.get_data());
+    int64_t* pIdx = reinterpret_cast<int64_t*>(indexes.get_data());
+    double* pAlong = reinterpret_cast<double*>(along.get_data());
+    double* pAcross = reinterpret_cast<double*>(across.get_data());
+    double* pDist = reinterpret_cast<double*>(distance.get_data());
+    size_t pos = 0;
+    pOff[0] = 0;
+    for (unsigned s = 0; s < nbSegments; s++)
+    {
+        for (const CorridorPoint_py& p : segments[s])
+        {
+            pIdx[pos] = p.index;
+            pAlong[pos] = p.along;
+            pAcross[pos] = p.across;
+            pDist[pos] = p.distance;
+            pos++;
+        }
+        pOff[s + 1] = pos;
+    }
+    CCTRACE("extractCorridor: " << nbSegments << " segments, " << total << " points, level " << static_cast<int>(level));
+    bp::dict result;
+    result["offsets"] = offsets;
+    result["indexes"] = indexes;
+    result["along"] = along;
+    result["across"] = across;
+    result["distance"] = distance;
+    return result;
+}
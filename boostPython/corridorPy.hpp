@@ -0,0 +1,34 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CORRIDORPY_HPP_
+#define CORRIDORPY_HPP_
+
+#include <boost/python.hpp>
+
+class ccGenericPointCloud;
+class ccPolyline;
+
+//! points of the cloud within a radius of each segment of the polyline, with along-track and cross-track coordinates
+/*! Each segment is walked with a progressive cylindrical neighbourhood of the octree, growing by step
+ *  (the octree cell size), the segments are processed in parallel, GIL released.
+ *  \return dict of numpy arrays, CSR layout by segment: offsets, indexes, along, across, distance
+ */
+boost::python::dict extractCorridor_py(ccGenericPointCloud* cloud, ccPolyline* polyline, double radius, double step = 0);
+
+#endif /* CORRIDORPY_HPP_ */
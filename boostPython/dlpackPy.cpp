@@ -0,0 +1,119 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "dlpackPy.hpp"
+
+#include <boost/python.hpp>
+#include <Python.h>
+
+#include "pyccTrace.h"
+
+namespace bp = boost::python;
+
+//! what is allocated with the DLManagedTensor: shape, strides and a reference on the owner
+struct DLPackContext_py
+{
+    PyObject* owner;
+    int64_t shape[2];
+    int64_t strides[2];
+};
+
+static void DLPack_deleter(DLManagedTensor* self)
+{
+    CCTRACE("DLPack_deleter");
+    DLPackContext_py* ctx = static_cast<DLPackContext_py*>(self->manager_ctx);
+    // the consumer may release the tensor from any thread, without the GIL
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_XDECREF(ctx->owner);
+    PyGILState_Release(state);
+    delete ctx;
+    delete self;
+}
+
+static void DLPack_capsuleDestructor(PyObject* capsule)
+{
+    if (PyCapsule_IsValid(capsule, "used_dltensor"))
+        return; // the consumer is in charge of the tensor
+    DLManagedTensor* tensor = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+    if (tensor == nullptr)
+    {
+        PyErr_WriteUnraisable(capsule);
+        return;
+    }
+    if (tensor->deleter)
+        tensor->deleter(tensor);
+}
+
+bp::object DLPack_wrap_py(bp::object owner, void* data, DLDataType dtype, int64_t nRows, int64_t nCols)
+{
+    CCTRACE("DLPack_wrap, without copy, ownership stays in C++");
+    DLPackContext_py* ctx = new DLPackContext_py;
+    ctx->owner = owner.ptr();
+    Py_INCREF(ctx->owner);
+    ctx->shape[0] = nRows;
+    ctx->shape[1] = nCols;
+    ctx->strides[0] = (nCols > 0) ? nCols : 1;
+    ctx->strides[1] = 1;
+
+    DLManagedTensor* tensor = new DLManagedTensor;
+    tensor->dl_tensor.data = data;
+    tensor->dl_tensor.device.device_type = kDLCPU;
+    tensor->dl_tensor.device.device_id = 0;
+    tensor->dl_tensor.ndim = (nCols > 0) ? 2 : 1;
+    tensor->dl_tensor.dtype = dtype;
+    tensor->dl_tensor.shape = ctx->shape;
+    tensor->dl_tensor.strides = ctx->strides;
+    tensor->dl_tensor.byte_offset = 0;
+    tensor->manager_ctx = ctx;
+    tensor->deleter = &DLPack_deleter;
+
+    PyObject* capsule = PyCapsule_New(tensor, "dltensor", &DLPack_capsuleDestructor);
+    if (!capsule)
+    {
+        DLPack_deleter(tensor);
+        bp::throw_error_already_set();
+    }
+    return bp::object(bp::handle<>(capsule));
+}
+
+bp::tuple DLPack_device_py(bp::object self)
+{
+    return bp::make_tuple(static_cast<int>(kDLCPU), 0);
+}
+
+DLManagedTensor* DLPack_consume_py(bp::object obj)
+{
+    bp::object capsule = obj;
+    if (!PyCapsule_CheckExact(obj.ptr()))
+    {
+        if (!PyObject_HasAttrString(obj.ptr(), "__dlpack__"))
+        {
+            PyErr_SetString(PyExc_TypeError, "a DLPack capsule or an object with a __dlpack__ method is required");
+            bp::throw_error_already_set();
+        }
+        capsule = obj.attr("__dlpack__")();
+    }
+    if (!PyCapsule_IsValid(capsule.ptr(), "dltensor"))
+    {
+        PyErr_SetString(PyExc_ValueError, "invalid DLPack capsule, or capsule already consumed");
+        bp::throw_error_already_set();
+    }
+    DLManagedTensor* tensor = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+    return tensor;
+}
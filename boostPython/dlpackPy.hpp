@@ -0,0 +1,121 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef DLPACKPY_HPP_
+#define DLPACKPY_HPP_
+
+#include <boost/python.hpp>
+#include <cstdint>
+#include <type_traits>
+
+// --- DLPack ABI (https://github.com/dmlc/dlpack, dlpack.h v0.8), only the parts used by CloudComPy.
+// The layout of these structures must not be modified: they are shared with the other tensor libraries.
+
+extern "C"
+{
+    typedef enum
+    {
+        kDLCPU = 1,
+    } DLDeviceType;
+
+    typedef struct
+    {
+        DLDeviceType device_type;
+        int32_t device_id;
+    } DLDevice;
+
+    typedef enum
+    {
+        kDLInt = 0U,
+        kDLUInt = 1U,
+        kDLFloat = 2U,
+    } DLDataTypeCode;
+
+    typedef struct
+    {
+        uint8_t code;
+        uint8_t bits;
+        uint16_t lanes;
+    } DLDataType;
+
+    typedef struct
+    {
+        void* data;
+        DLDevice device;
+        int32_t ndim;
+        DLDataType dtype;
+        int64_t* shape;
+        int64_t* strides;
+        uint64_t byte_offset;
+    } DLTensor;
+
+    typedef struct DLManagedTensor
+    {
+        DLTensor dl_tensor;
+        void* manager_ctx;
+        void (*deleter)(struct DLManagedTensor* self);
+    } DLManagedTensor;
+}
+
+//! DLPack data type corresponding to a C++ type
+template<typename T> DLDataType DLPack_dtype()
+{
+    DLDataType dt;
+    dt.code = std::is_floating_point<T>::value ? kDLFloat : (std::is_signed<T>::value ? kDLInt : kDLUInt);
+    dt.bits = 8 * sizeof(T);
+    dt.lanes = 1;
+    return dt;
+}
+
+//! wrap C++ owned data in a DLPack capsule, without copy
+/*! The data stays owned by C++, as for the numpy arrays obtained with toNpArray:
+ *  the tensor must not be used after the destruction of the C++ object.
+ *  A reference on the Python owner object is kept as long as the tensor is alive.
+ *  \param owner the Python object wrapping the data owner
+ *  \param data pointer to the first element
+ *  \param dtype DLPack data type
+ *  \param nRows first dimension
+ *  \param nCols second dimension, 0 for a one dimension tensor
+ *  \return a PyCapsule named "dltensor"
+ */
+boost::python::object DLPack_wrap_py(boost::python::object owner, void* data, DLDataType dtype, int64_t nRows, int64_t nCols = 0);
+
+//! the device of the tensors exported by CloudComPy: (kDLCPU, 0)
+boost::python::tuple DLPack_device_py(boost::python::object self);
+
+//! take the ownership of a DLPack tensor given as a capsule or as an object with a __dlpack__ method
+/*! The capsule is renamed "used_dltensor", the caller must release the tensor with its deleter,
+ *  see DLPack_guard.
+ */
+DLManagedTensor* DLPack_consume_py(boost::python::object obj);
+
+//! release a consumed DLPack tensor at the end of the scope (also on errors)
+struct DLPack_guard
+{
+    DLManagedTensor* tensor;
+    DLPack_guard(DLManagedTensor* t) : tensor(t) {}
+    ~DLPack_guard()
+    {
+        if (tensor && tensor->deleter)
+            tensor->deleter(tensor);
+    }
+private:
+    DLPack_guard(const DLPack_guard&);
+};
+
+#endif
@@ -0,0 +1,40 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef GILPY_HPP_
+#define GILPY_HPP_
+
+#include <Python.h>
+
+//! release the Python GIL during the lifetime of the object (long computations without Python objects)
+/*! All the Python objects (numpy arrays...) must be accessed before, or through raw pointers
+ *  kept alive by the caller. Exceptions must not be raised with PyErr_* while the GIL is released.
+ */
+class GILRelease_py
+{
+public:
+    GILRelease_py() : m_state(PyEval_SaveThread()) {}
+    ~GILRelease_py() { PyEval_RestoreThread(m_state); }
+    GILRelease_py(const GILRelease_py&) = delete;
+    GILRelease_py& operator=(const GILRelease_py&) = delete;
+
+private:
+    PyThreadState* m_state;
+};
+
+#endif /* GILPY_HPP_ */
@@ -0,0 +1,237 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "kdTreePy.hpp"
+
+#include <ccGenericPointCloud.h>
+#include <ccOctree.h>
+
+#include "ccOctreePy.hpp"
+#include "gilPy.hpp"
+#include "neighboursPy.hpp"
+#include "octreeIOPy.hpp"
+#include "pyccTrace.h"
+#include "kdTreePy_DocStrings.hpp"
+
+#include <numeric>
+
+namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
+
+using namespace boost::python;
+
+//! the child holding the KD-tree of the cloud, if any
+static ccKDTree_py* kdTreeChild(ccGenericPointCloud& self)
+{
+    for (unsigned i = 0; i < self.getChildrenNumber(); i++)
+    {
+        ccKDTree_py* child = dynamic_cast<ccKDTree_py*>(self.getChild(i));
+        if (child)
+            return child;
+    }
+    return nullptr;
+}
+
+ccKDTree_py::Shared ccGenericPointCloud_getKDTree_py(ccGenericPointCloud& self)
+{
+    ccKDTree_py* child = kdTreeChild(self);
+    if (!child)
+        return ccKDTree_py::Shared();
+    if (child->tree->size() != self.size())
+    {
+        self.removeChild(child); // built before a change of the number of points
+        return ccKDTree_py::Shared();
+    }
+    return child->tree;
+}
+
+void ccGenericPointCloud_deleteKDTree_py(ccGenericPointCloud& self)
+{
+    ccKDTree_py* child = kdTreeChild(self);
+    if (child)
+        self.removeChild(child);
+}
+
+ccKDTree_py::Shared ccGenericPointCloud_computeKDTree_py(ccGenericPointCloud& self, unsigned leafSize, int maxThreadCount)
+{
+    ccGenericPointCloud_deleteKDTree_py(self);
+    ccKDTree_py::Shared kdTree;
+    try
+    {
+        kdTree = std::make_shared<pyCC_KDTree>(leafSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return ccKDTree_py::Shared();
+    }
+    bool ok = false;
+    {
+        GILRelease_py noGIL;
+        ok = kdTree->build(&self, maxThreadCount);
+    }
+    if (!ok)
+        return ccKDTree_py::Shared();
+    CCTRACE("computeKDTree: " << kdTree->nodeCount() << " nodes, " << kdTree->memoryUsed() << " bytes");
+    self.addChild(new ccKDTree_py(kdTree));
+    return kdTree;
+}
+
+bp::tuple ccKDTree_knn_py(const pyCC_KDTree& tree, bnp::ndarray const& queryPoints, unsigned k, double maxDist = 0,
+                          double epsilon = 0)
+{
+    if (k == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "k must be at least 1");
+        bp::throw_error_already_set();
+    }
+    if (epsilon < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "epsilon must be positive or zero");
+        bp::throw_error_already_set();
+    }
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    std::vector<unsigned> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    const double maxSquareDist = (maxDist > 0) ? maxDist * maxDist : 0;
+    bp::tuple res = knnArrays_py(points.size(), k, order, [&]()
+    {
+        return [&tree, &points, k, maxSquareDist, epsilon](size_t i, std::vector<Neighbour_py>& neighbours)
+        {
+            tree.knn(points[i], k, maxSquareDist, neighbours, epsilon);
+        };
+    });
+    CCTRACE("knn (KD-tree): " << points.size() << " queries, k=" << k << ", epsilon " << epsilon);
+    return res;
+}
+
+bp::tuple ccKDTree_radiusSearch_py(const pyCC_KDTree& tree, bnp::ndarray const& queryPoints, double radius)
+{
+    if (!(radius > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "search size must be strictly positive");
+        bp::throw_error_already_set();
+    }
+    std::vector<CCVector3> points = queryPoints_py(queryPoints);
+    std::vector<unsigned> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    bp::tuple res = csrArrays_py(points.size(), order, [&]()
+    {
+        return [&tree, &points, radius](size_t i, std::vector<Neighbour_py>& neighbours)
+        {
+            tree.radius(points[i], radius, neighbours);
+        };
+    });
+    CCTRACE("radius search (KD-tree): " << points.size() << " queries");
+    return res;
+}
+
+//! the KD-tree to use for a query, null to use the octree (computed if needed)
+/*! approximate: only the KD-tree provides approximate searches, with "auto" it is computed if needed
+ */
+static ccKDTree_py::Shared searchBackend(ccGenericPointCloud& self, const std::string& backend, ccOctree::Shared& octree,
+                                  bool approximate = false)
+{
+    if (backend != "auto" && backend != "octree" && backend != "kdtree")
+    {
+        PyErr_Format(PyExc_ValueError, "unknown backend '%s', use 'auto', 'octree' or 'kdtree'", backend.c_str());
+        bp::throw_error_already_set();
+    }
+    if (approximate && backend == "octree")
+    {
+        PyErr_SetString(PyExc_ValueError, "approximate search (epsilon > 0) requires the 'kdtree' or 'auto' backend");
+        bp::throw_error_already_set();
+    }
+    ccKDTree_py::Shared kdTree;
+    if (backend != "octree")
+        kdTree = ccGenericPointCloud_getKDTree_py(self);
+    if (!kdTree && (backend == "kdtree" || approximate))
+        kdTree = ccGenericPointCloud_computeKDTree_py(self);
+    if (kdTree)
+        return kdTree;
+    if (backend != "kdtree")
+    {
+        octree = ccGenericPointCloud_updateOctree_py(self);
+        if (octree)
+            return ccKDTree_py::Shared();
+    }
+    PyErr_SetString(PyExc_MemoryError, "Not enough memory, or empty cloud");
+    bp::throw_error_already_set();
+    return ccKDTree_py::Shared();
+}
+
+bp::tuple ccGenericPointCloud_knn_py(ccGenericPointCloud& self,
+                                     bnp::ndarray const& queryPoints,
+                                     unsigned k,
+                                     double maxDist,
+                                     const std::string& backend,
+                                     double epsilon)
+{
+    ccOctree::Shared octree;
+    ccKDTree_py::Shared kdTree = searchBackend(self, backend, octree, epsilon > 0);
+    if (kdTree)
+        return ccKDTree_knn_py(*kdTree, queryPoints, k, maxDist, epsilon);
+    return DgmOctree_knn_py(*octree, queryPoints, k, maxDist);
+}
+
+bp::tuple ccGenericPointCloud_radiusSearch_py(ccGenericPointCloud& self,
+                                              bnp::ndarray const& queryPoints,
+                                              double radius,
+                                              const std::string& backend)
+{
+    ccOctree::Shared octree;
+    ccKDTree_py::Shared kdTree = searchBackend(self, backend, octree);
+    if (kdTree)
+        return ccKDTree_radiusSearch_py(*kdTree, queryPoints, radius);
+    return DgmOctree_radiusSearch_py(*octree, queryPoints, radius);
+}
+
+size_t ccKDTree_getSize_py(const pyCC_KDTree& self)
+{
+    return self.size();
+}
+
+unsigned ccKDTree_getLeafSize_py(const pyCC_KDTree& self)
+{
+    return self.leafSize();
+}
+
+size_t ccKDTree_getNodeCount_py(const pyCC_KDTree& self)
+{
+    return self.nodeCount();
+}
+
+size_t ccKDTree_getMemoryUsed_py(const pyCC_KDTree& self)
+{
+    return self.memoryUsed();
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(ccKDTree_knn_py_overloads, ccKDTree_knn_py, 3, 5)
+
+void export_ccKDTree()
+{
+    // held by a shared pointer: Python keeps the tree alive after the cloud drops it
+    class_<pyCC_KDTree, ccKDTree_py::Shared, boost::noncopyable>("ccKDTree", ccKDTree_doc, no_init)
+        .def("getLeafSize", &ccKDTree_getLeafSize_py, ccKDTree_getLeafSize_doc)
+        .def("getMemoryUsed", &ccKDTree_getMemoryUsed_py, ccKDTree_getMemoryUsed_doc)
+        .def("getNodeCount", &ccKDTree_getNodeCount_py, ccKDTree_getNodeCount_doc)
+        .def("knn", &ccKDTree_knn_py,
+             ccKDTree_knn_py_overloads(args("self", "queryPoints", "k", "maxDist", "epsilon"), ccKDTree_knn_doc))
+        .def("radiusSearch", &ccKDTree_radiusSearch_py, ccKDTree_radiusSearch_doc)
+        .def("size", &ccKDTree_getSize_py, ccKDTree_size_doc)
+        ;
+}
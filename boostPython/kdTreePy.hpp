@@ -0,0 +1,80 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef KDTREEPY_HPP_
+#define KDTREEPY_HPP_
+
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+#include <memory>
+#include <string>
+
+#include <ccCustomObject.h>
+
+#include "pyccKDTree.h"
+
+class ccGenericPointCloud;
+
+//! KD-tree index of a cloud, attached as a child of the cloud, next to its octree
+/*! The tree keeps a copy of the coordinates: it is dropped at each modification of the points (content version).
+ *  The tree is shared, as the octree (ccOctree::Shared): a tree held by Python or by a running query
+ *  stays valid when the cloud drops its child.
+ */
+class ccKDTree_py : public ccCustomHObject
+{
+public:
+    typedef std::shared_ptr<pyCC_KDTree> Shared;
+
+    explicit ccKDTree_py(Shared kdTree) : ccCustomHObject("KD-tree"), tree(std::move(kdTree)) {}
+
+    //! not saved with the cloud
+    bool isSerializable() const override { return false; }
+
+    Shared tree;
+};
+
+//! the KD-tree attached to the cloud, null if none or if it no longer matches the number of points
+ccKDTree_py::Shared ccGenericPointCloud_getKDTree_py(ccGenericPointCloud& self);
+
+//! build a KD-tree on the cloud and attach it, in place of a previous one
+/*! \return the tree, null if the cloud is empty or if there is not enough memory
+ */
+ccKDTree_py::Shared ccGenericPointCloud_computeKDTree_py(ccGenericPointCloud& self, unsigned leafSize = 16, int maxThreadCount = 0);
+
+//! delete the KD-tree attached to the cloud, if any
+void ccGenericPointCloud_deleteKDTree_py(ccGenericPointCloud& self);
+
+//! k nearest neighbours with the backend chosen per call: "auto", "octree" or "kdtree"
+/*! epsilon > 0: approximate search, on the KD-tree only
+ */
+boost::python::tuple ccGenericPointCloud_knn_py(ccGenericPointCloud& self,
+                                                boost::python::numpy::ndarray const& queryPoints,
+                                                unsigned k,
+                                                double maxDist = 0,
+                                                const std::string& backend = "auto",
+                                                double epsilon = 0);
+
+//! radius search with the backend chosen per call: "auto", "octree" or "kdtree"
+boost::python::tuple ccGenericPointCloud_radiusSearch_py(ccGenericPointCloud& self,
+                                                         boost::python::numpy::ndarray const& queryPoints,
+                                                         double radius,
+                                                         const std::string& backend = "auto");
+
+void export_ccKDTree();
+
+#endif /* KDTREEPY_HPP_ */
@@ -0,0 +1,93 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef KDTREEPY_DOCSTRINGS_HPP_
+#define KDTREEPY_DOCSTRINGS_HPP_
+
+const char* ccKDTree_doc= R"(
+KD-tree index of a cloud, an alternative to the octree for kNN queries.
+
+Built with :py:meth:`ccGenericPointCloud.computeKDTree`, attached to the cloud as a child, next to its octree.
+The tree stores a copy of the coordinates in flat arrays, the points of a leaf being contiguous in memory.
+Nodes split the widest side of their points bounding box at the median,
+so the tree adapts to highly varying densities, where the octree has to widen its search cell by cell.
+The tree must be rebuilt if the points are modified.
+A tree kept in Python remains usable after the cloud drops it (modification of the points,
+:py:meth:`ccGenericPointCloud.deleteKDTree`): it then indexes the points as they were when it was built.)";
+
+const char* ccKDTree_getLeafSize_doc= R"(
+Gets the maximum number of points in a leaf (points at the same location may exceed this size).
+
+:return: the leaf size
+:rtype: int )";
+
+const char* ccKDTree_getMemoryUsed_doc= R"(
+Gets the memory used by the tree, copy of the coordinates included.
+
+:return: the memory used, in bytes
+:rtype: int )";
+
+const char* ccKDTree_getNodeCount_doc= R"(
+Gets the number of nodes of the tree, leaves included.
+
+:return: the number of nodes
+:rtype: int )";
+
+const char* ccKDTree_knn_doc= R"(
+Finds the k nearest neighbours of a set of query points, in one call.
+
+The queries are processed in parallel on all the cores, with the Python GIL released.
+Queries in spatial order (see :py:meth:`ccPointCloud.reorderSpatially`) are faster.
+The results have the same layout as :py:meth:`ccOctree.knn`.
+
+With epsilon > 0, the search is approximate, for processings tolerating small errors
+(pre-alignment, coarse density, preview subsampling): the tree branches that cannot hold a neighbour
+closer than the current k-th one divided by (1 + epsilon) are skipped. The i-th neighbour found is at most
+(1 + epsilon) times farther than the exact i-th neighbour. Larger values visit less leaves: faster, lower recall.
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param int k: number of neighbours
+:param float,optional maxDist: (default 0) the maximum search distance (ignored if <= 0)
+:param float,optional epsilon: (default 0) the approximation factor, 0 for an exact search
+
+:return: tuple (indexes, squareDistances) of numpy arrays of shape (N,k), int64 and float64,
+         sorted by increasing distance. When less than k neighbours are found,
+         the remaining indexes are -1 and the remaining distances are inf.
+:rtype: tuple )";
+
+const char* ccKDTree_radiusSearch_doc= R"(
+Finds the points within a radius of a set of query points, in one call.
+
+The queries are processed in parallel on all the cores, with the Python GIL released.
+The results have the same layout as :py:meth:`ccOctree.radiusSearch`.
+
+:param ndarray queryPoints: numpy array (N,3) of float32 or float64, the query points
+:param float radius: the search radius
+
+:return: tuple (offsets, indexes, squareDistances) of numpy arrays: the neighbours of query i
+         are in [offsets[i], offsets[i+1][, sorted by increasing distance.
+         offsets is int64 of size N+1, indexes int64 and squareDistances float64.
+:rtype: tuple )";
+
+const char* ccKDTree_size_doc= R"(
+Gets the number of points in the tree.
+
+:return: the number of points
+:rtype: int )";
+
+#endif /* KDTREEPY_DOCSTRINGS_HPP_ */
@@ -0,0 +1,252 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "knnGraphPy.hpp"
+
+#include <boost/python/numpy.hpp>
+
+#include <DgmOctree.h>
+#include <GenericIndexedCloudPersist.h>
+#include <ReferenceCloud.h>
+
+#include "ccOctreePy.hpp"
+#include "gilPy.hpp"
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
+
+namespace
+{
+    enum class GraphWeights_py { distance, squareDistance, connectivity };
+
+    //! an edge of a row: (column, weight)
+    typedef std::pair<unsigned, double> Edge_py;
+
+    //! number of neighbours per point: k, at most all the other points
+    size_t neighboursPerPoint(size_t n, unsigned k)
+    {
+        return (n > 1) ? std::min(static_cast<size_t>(k), n - 1) : 0;
+    }
+
+    //! sort the edges of a row by column and merge the duplicates (same weight both ways), return the new size
+    size_t sortRow(Edge_py* edges, size_t count)
+    {
+        std::sort(edges, edges + count, [](const Edge_py& a, const Edge_py& b) { return a.first < b.first; });
+        return std::unique(edges, edges + count, [](const Edge_py& a, const Edge_py& b) { return a.first == b.first; })
+               - edges;
+    }
+}
+
+std::pair<size_t, size_t> knnGraphMemory(size_t n, unsigned k, bool symmetric)
+{
+    size_t nnz = n * neighboursPerPoint(n, k);
+    size_t maxEdges = symmetric ? 2 * nnz : nnz;
+    // directed edges, counts, points and their query order
+    size_t search = nnz * sizeof(Edge_py) + n * (sizeof(size_t) + sizeof(unsigned) + sizeof(CCVector3));
+    // edges of both directions, counts, offsets and cursors
+    size_t merge = symmetric ? maxEdges * sizeof(Edge_py) + 3 * n * sizeof(size_t) : 0;
+    size_t output = (n + 1) * sizeof(int64_t) + maxEdges * (sizeof(int64_t) + sizeof(double));
+    return std::make_pair(search + merge + output, output);
+}
+
+bp::dict DgmOctree_knnGraphMemory_py(CCCoreLib::DgmOctree& self, unsigned k, bool symmetric)
+{
+    std::pair<size_t, size_t> memory = knnGraphMemory(self.associatedCloud()->size(), k, symmetric);
+    bp::dict res;
+    res["peak"] = memory.first;
+    res["output"] = memory.second;
+    return res;
+}
+
+bp::tuple DgmOctree_knnGraph_py(CCCoreLib::DgmOctree& self,
+                                unsigned k,
+                                bool symmetric,
+                                const std::string& weights,
+                                double maxMemory)
+{
+    if (k == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "k must be at least 1");
+        bp::throw_error_already_set();
+    }
+    GraphWeights_py weighting = GraphWeights_py::distance;
+    if (weights == "squareDistance")
+        weighting = GraphWeights_py::squareDistance;
+    else if (weights == "connectivity")
+        weighting = GraphWeights_py::connectivity;
+    else if (weights != "distance")
+    {
+        PyErr_SetString(PyExc_ValueError, "weights must be 'distance', 'squareDistance' or 'connectivity'");
+        bp::throw_error_already_set();
+    }
+    CCCoreLib::GenericIndexedCloudPersist* cloud = self.associatedCloud();
+    size_t n = cloud->size();
+    size_t kk = neighboursPerPoint(n, k);
+    std::pair<size_t, size_t> memory = knnGraphMemory(n, k, symmetric);
+    if (maxMemory > 0 && memory.first > maxMemory)
+    {
+        PyErr_Format(PyExc_MemoryError, "the kNN graph requires up to %zu bytes, more than maxMemory", memory.first);
+        bp::throw_error_already_set();
+    }
+
+    std::vector<size_t> offsets;    // CSR offsets of the rows in edges
+    std::vector<size_t> counts;     // number of edges per row
+    std::vector<Edge_py> edges;
+    bool memoryError = false;
+    {
+        GILRelease_py noGIL;
+        try
+        {
+            // --- k nearest neighbours of each point, the point itself excluded, rows of kk edges
+            std::vector<Edge_py> directed(n * kk);
+            std::vector<size_t> found(n, 0);
+            std::vector<CCVector3> points(n);
+            for (size_t i = 0; i < n; i++)
+                points[i] = *cloud->getPoint(static_cast<unsigned>(i));
+            unsigned char level = self.findBestLevelForAGivenPopulationPerCell(std::max(static_cast<unsigned>(kk) + 1, 3u));
+            std::vector<unsigned> order = DgmOctree_queryOrder_py(self, points, level);
+            std::vector<CCVector3>().swap(points);
+            pyCC_ParallelFor(kk ? n : 0, [&](size_t begin, size_t end)
+            {
+                CCCoreLib::ReferenceCloud Yk(cloud);
+                for (size_t o = begin; o < end; o++)
+                {
+                    unsigned i = order[o];
+                    const CCVector3* P = cloud->getPoint(i);
+                    Yk.clear(false);
+                    double maxSquareDist = 0;
+                    int nb = self.findPointNeighbourhood(P, &Yk, static_cast<unsigned>(kk) + 1, level, maxSquareDist);
+                    unsigned available = std::min(static_cast<unsigned>(std::max(nb, 0)), Yk.size());
+                    Edge_py* row = directed.data() + i * kk;
+                    size_t c = 0;
+                    for (unsigned j = 0; j < available && c < kk; j++)
+                    {
+                        unsigned index = Yk.getPointGlobalIndex(j);
+                        if (index == i)
+                            continue;
+                        row[c++] = Edge_py(index, (*cloud->getPoint(index) - *P).norm2d());
+                    }
+                    found[i] = c;
+                }
+            });
+            pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    Edge_py* row = directed.data() + i * kk;
+                    for (size_t j = 0; j < found[i]; j++)
+                    {
+                        if (weighting == GraphWeights_py::distance)
+                            row[j].second = std::sqrt(row[j].second);
+                        else if (weighting == GraphWeights_py::connectivity)
+                            row[j].second = 1.;
+                    }
+                }
+            });
+
+            if (!symmetric)
+            {
+                offsets.resize(n + 1);
+                for (size_t i = 0; i <= n; i++)
+                    offsets[i] = i * kk;
+                counts.swap(found);
+                edges.swap(directed);
+            }
+            else
+            {
+                // --- union of both directions: row i receives its edges i->j and the edges j->i
+                counts.assign(n, 0);
+                for (size_t i = 0; i < n; i++)
+                {
+                    counts[i] += found[i];
+                    for (size_t j = 0; j < found[i]; j++)
+                        counts[directed[i * kk + j].first]++;
+                }
+                offsets.resize(n + 1);
+                offsets[0] = 0;
+                for (size_t i = 0; i < n; i++)
+                    offsets[i + 1] = offsets[i] + counts[i];
+                edges.resize(offsets[n]);
+                std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+                for (size_t i = 0; i < n; i++)
+                {
+                    for (size_t j = 0; j < found[i]; j++)
+                    {
+                        const Edge_py& e = directed[i * kk + j];
+                        edges[cursor[i]++] = e;
+                        edges[cursor[e.first]++] = Edge_py(static_cast<unsigned>(i), e.second);
+                    }
+                }
+            }
+            std::vector<Edge_py>().swap(directed);
+            pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                    counts[i] = sortRow(edges.data() + offsets[i], counts[i]);
+            });
+        }
+        catch (const std::bad_alloc&)
+        {
+            memoryError = true;
+        }
+    }
+    if (memoryError)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+
+    size_t nnz = 0;
+    for (size_t i = 0; i < n; i++)
+        nnz += counts[i];
+    bnp::ndarray indptr = bnp::empty(bp::make_tuple(n + 1), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray indices = bnp::empty(bp::make_tuple(nnz), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray data = bnp::empty(bp::make_tuple(nnz), bnp::dtype::get_builtin<double>());
+    int64_t* pPtr = reinterpret_cast<int64_t*>(indptr.get_data());
+    int64_t* pIdx = reinterpret_cast<int64_t*>(indices.get_data());
+    double* pData = reinterpret_cast<double*>(data.get_data());
+    {
+        GILRelease_py noGIL;
+        pPtr[0] = 0;
+        for (size_t i = 0; i < n; i++)
+            pPtr[i + 1] = pPtr[i] + counts[i];
+        pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const Edge_py* row = edges.data() + offsets[i];
+                for (size_t j = 0; j < counts[i]; j++)
+                {
+                    pIdx[pPtr[i] + j] = row[j].first;
+                    pData[pPtr[i] + j] = row[j].second;
+                }
+            }
+        });
+    }
+    CCTRACE("knnGraph: " << n << " points, k=" << k << ", symmetric " << symmetric << ", " << nnz << " edges");
+    return bp::make_tuple(indptr, indices, data);
+}
@@ -0,0 +1,51 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef KNNGRAPHPY_HPP_
+#define KNNGRAPHPY_HPP_
+
+#include <boost/python.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace CCCoreLib
+{
+    class DgmOctree;
+}
+
+//! upper bound of the memory used to build the kNN graph of n points, in bytes: (peak, output arrays)
+std::pair<size_t, size_t> knnGraphMemory(size_t n, unsigned k, bool symmetric);
+
+//! kNN graph of the points of the octree cloud, in CSR arrays (indptr, indices, data), as scipy.sparse.csr_matrix
+/*! The k nearest neighbours of each point (the point itself excluded) are searched in parallel, GIL released.
+ *  symmetric: union of the edges i->j and j->i. weights: "distance", "squareDistance" or "connectivity".
+ *  maxMemory: if not 0, MemoryError before any allocation when the estimated peak memory exceeds it.
+ *  The column indices of each row are sorted, without duplicates.
+ */
+boost::python::tuple DgmOctree_knnGraph_py(CCCoreLib::DgmOctree& self,
+                                           unsigned k,
+                                           bool symmetric = true,
+                                           const std::string& weights = "distance",
+                                           double maxMemory = 0);
+
+//! estimated memory of DgmOctree_knnGraph_py: {"peak": bytes, "output": bytes}
+boost::python::dict DgmOctree_knnGraphMemory_py(CCCoreLib::DgmOctree& self, unsigned k, bool symmetric = true);
+
+#endif /* KNNGRAPHPY_HPP_ */
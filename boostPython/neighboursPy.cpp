@@ -0,0 +1,58 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "neighboursPy.hpp"
+
+#include <string>
+
+namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
+
+std::vector<CCVector3> queryPoints_py(bnp::ndarray const& array)
+{
+    if (array.get_nd() != 2 || array.shape(1) != 3)
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array dimension, (N,3) required");
+        bp::throw_error_already_set();
+    }
+    std::string kind = bp::extract<std::string>(array.get_dtype().attr("kind"));
+    if (kind != "f")
+    {
+        PyErr_SetString(PyExc_TypeError, "Incorrect array data type, float32 or float64 required");
+        bp::throw_error_already_set();
+    }
+    // any memory layout (Fortran order, slices): read with the strides, float32 and float64 without conversion
+    bnp::ndarray a = (array.get_dtype() == bnp::dtype::get_builtin<float>()
+                      || array.get_dtype() == bnp::dtype::get_builtin<double>())
+                     ? array : array.astype(bnp::dtype::get_builtin<double>());
+    bool isFloat = (a.get_dtype() == bnp::dtype::get_builtin<float>());
+    size_t n = a.shape(0);
+    const char* data = a.get_data();
+    const Py_intptr_t* strides = a.get_strides();
+    std::vector<CCVector3> points(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            const char* p = data + static_cast<Py_intptr_t>(i) * strides[0] + d * strides[1];
+            points[i].u[d] = isFloat ? *reinterpret_cast<const float*>(p)
+                                     : static_cast<PointCoordinateType>(*reinterpret_cast<const double*>(p));
+        }
+    }
+    return points;
+}
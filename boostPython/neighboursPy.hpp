@@ -0,0 +1,146 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef NEIGHBOURSPY_HPP_
+#define NEIGHBOURSPY_HPP_
+
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
+#include <CCGeom.h>
+
+#include "gilPy.hpp"
+#include "pyccParallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// --- Batch neighbourhood queries: the queries are run in parallel, GIL released, by a search object
+// created once per chunk of queries (it keeps its own work buffers): search(i, neighbours) fills the
+// neighbours of the query i, as (square distance, point index) sorted by increasing distance.
+// The order of the queries (octree cell order...) keeps the successive searches of a thread local.
+
+//! a neighbour: (square distance, point index)
+typedef std::pair<double, unsigned> Neighbour_py;
+
+//! query points given by a numpy array (N,3) of float32 or float64, copied (usable without the GIL)
+std::vector<CCVector3> queryPoints_py(boost::python::numpy::ndarray const& array);
+
+//! k nearest neighbours of n queries: (indexes int64 (n,k), squareDistances float64 (n,k)), padded with -1 and inf
+template<typename MakeSearch> boost::python::tuple knnArrays_py(size_t n,
+                                                              unsigned k,
+                                                              const std::vector<unsigned>& order,
+                                                              MakeSearch makeSearch)
+{
+    namespace bp = boost::python;
+    namespace bnp = boost::python::numpy;
+    bnp::ndarray indexes = bnp::empty(bp::make_tuple(n, k), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray sqDists = bnp::empty(bp::make_tuple(n, k), bnp::dtype::get_builtin<double>());
+    int64_t* pIdx = reinterpret_cast<int64_t*>(indexes.get_data());
+    double* pDist = reinterpret_cast<double*>(sqDists.get_data());
+    {
+        GILRelease_py noGIL;
+        pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+        {
+            auto search = makeSearch();
+            std::vector<Neighbour_py> neighbours;
+            for (size_t o = begin; o < end; o++)
+            {
+                size_t i = order[o];
+                neighbours.clear();
+                search(i, neighbours);
+                size_t nbFound = std::min(neighbours.size(), static_cast<size_t>(k));
+                for (size_t j = 0; j < k; j++)
+                {
+                    pIdx[i * k + j] = (j < nbFound) ? static_cast<int64_t>(neighbours[j].second) : -1;
+                    pDist[i * k + j] = (j < nbFound) ? neighbours[j].first : std::numeric_limits<double>::infinity();
+                }
+            }
+        });
+    }
+    return bp::make_tuple(indexes, sqDists);
+}
+
+//! neighbours of n queries in CSR arrays: (offsets int64 (n+1), indexes int64, squareDistances float64)
+/*! the neighbours of query i are in [offsets[i], offsets[i+1][
+ */
+template<typename MakeSearch> boost::python::tuple csrArrays_py(size_t n,
+                                                              const std::vector<unsigned>& order,
+                                                              MakeSearch makeSearch)
+{
+    namespace bp = boost::python;
+    namespace bnp = boost::python::numpy;
+    std::vector<size_t> counts(n, 0);
+    std::vector<size_t> localPos(n, 0);
+    std::vector<size_t> chunkOf(n, 0);
+    std::vector<std::vector<Neighbour_py>> chunkNeighbours;
+    std::vector<size_t> offsetsVec(n + 1, 0);
+    {
+        GILRelease_py noGIL;
+        std::vector<pyCC_Range> ranges = pyCC_SplitRange(n);
+        chunkNeighbours.resize(ranges.size());
+        pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+        {
+            auto search = makeSearch();
+            std::vector<Neighbour_py> neighbours;
+            std::vector<Neighbour_py>& found = chunkNeighbours[r.chunk];
+            for (size_t o = r.begin; o < r.end; o++)
+            {
+                size_t i = order[o];
+                neighbours.clear();
+                search(i, neighbours);
+                chunkOf[i] = r.chunk;
+                localPos[i] = found.size();
+                counts[i] = neighbours.size();
+                found.insert(found.end(), neighbours.begin(), neighbours.end());
+            }
+        });
+        for (size_t i = 0; i < n; i++)
+            offsetsVec[i + 1] = offsetsVec[i] + counts[i];
+    }
+    size_t total = offsetsVec[n];
+    bnp::ndarray offsets = bnp::empty(bp::make_tuple(n + 1), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray indexes = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<int64_t>());
+    bnp::ndarray sqDists = bnp::empty(bp::make_tuple(total), bnp::dtype::get_builtin<double>());
+    int64_t* pOff = reinterpret_cast<int64_t*>(offsets.get_data());
+    int64_t* pIdx = reinterpret_cast<int64_t*>(indexes.get_data());
+    double* pDist = reinterpret_cast<double*>(sqDists.get_data());
+    {
+        GILRelease_py noGIL;
+        pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const Neighbour_py* src = chunkNeighbours[chunkOf[i]].data() + localPos[i];
+                for (size_t j = 0; j < counts[i]; j++)
+                {
+                    pIdx[offsetsVec[i] + j] = src[j].second;
+                    pDist[offsetsVec[i] + j] = src[j].first;
+                }
+            }
+        });
+        for (size_t i = 0; i <= n; i++)
+            pOff[i] = offsetsVec[i];
+    }
+    return bp::make_tuple(offsets, indexes, sqDists);
+}
+
+#endif /* NEIGHBOURSPY_HPP_ */
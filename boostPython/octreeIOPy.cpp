@@ -0,0 +1,489 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "octreeIOPy.hpp"
+
+#include <boost/python.hpp>
+
+#include <ccGenericPointCloud.h>
+#include <ccOctree.h>
+#include <CCMiscTools.h>
+#include <DgmOctree.h>
+
+#include "gilPy.hpp"
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <QFile>
+#include <QVariant>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace bp = boost::python;
+
+//! number of points hashed by each task: fixed, for a hash independent of the number of threads
+static const size_t HASH_CHUNK = 65536;
+
+static const char OCTREE_MAGIC[8] = { 'P', 'Y', 'C', 'C', 'O', 'C', 'T', '1' };
+
+//! fixed part of an octree file, followed by the cell codes array
+struct OctreeFileHeader_py
+{
+    char magic[8];
+    uint32_t coordSize;         //!< sizeof(PointCoordinateType)
+    uint32_t indexAndCodeSize;  //!< sizeof(IndexAndCode)
+    uint64_t nbPoints;
+    uint64_t contentHash;
+    uint64_t nbCodes;
+    uint64_t nbProjectedPoints;
+    PointCoordinateType dimMin[3];
+    PointCoordinateType dimMax[3];
+    PointCoordinateType pointsMin[3];
+    PointCoordinateType pointsMax[3];
+};
+
+//! access to the protected members of the octree, to set its structure without the sequential build
+class ccOctreeBuilder_py : public ccOctree
+{
+public:
+    explicit ccOctreeBuilder_py(ccGenericPointCloud* cloud) : ccOctree(cloud), m_cloud(cloud) {}
+
+    //! set a saved structure
+    void restore(const OctreeFileHeader_py& header, cellsContainer& codes)
+    {
+        m_dimMin = CCVector3(header.dimMin[0], header.dimMin[1], header.dimMin[2]);
+        m_dimMax = CCVector3(header.dimMax[0], header.dimMax[1], header.dimMax[2]);
+        m_pointsMin = CCVector3(header.pointsMin[0], header.pointsMin[1], header.pointsMin[2]);
+        m_pointsMax = CCVector3(header.pointsMax[0], header.pointsMax[1], header.pointsMax[2]);
+        m_numberOfProjectedPoints = static_cast<unsigned>(header.nbProjectedPoints);
+        m_thePointsAndTheirCellCodes.swap(codes);
+        // same derived tables as at the end of a build
+        updateMinAndMaxTables();
+        updateCellSizeTable();
+        updateCellCountTable();
+    }
+
+    //! same structure as DgmOctree::build, codes and sort multithreaded
+    /*! as in DgmOctree::genericBuild, the points out of the box (NaN coordinates) are not projected
+     *  and the cell positions are clamped to the last cell (points on the upper faces of the box)
+     */
+    bool parallelBuild(int maxThreadCount)
+    {
+        size_t n = m_cloud->size();
+        if (n == 0)
+            return false;
+        static_cast<CCCoreLib::GenericCloud*>(m_cloud)->getBoundingBox(m_pointsMin, m_pointsMax);
+        m_dimMin = m_pointsMin;
+        m_dimMax = m_pointsMax;
+        CCCoreLib::CCMiscTools::MakeMinAndMaxCubical(m_dimMin, m_dimMax);
+        updateCellSizeTable();
+
+        try
+        {
+            m_thePointsAndTheirCellCodes.resize(n);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return false;
+        }
+        // same cell position as the sequential build, thread safe (const)
+        const ccOctreeBuilder_py* self = this;
+        ccGenericPointCloud* cloud = m_cloud;
+        const CCVector3 dimMin = m_dimMin;
+        const CCVector3 dimMax = m_dimMax;
+        auto inBox = [=](const CCVector3* P)
+        {
+            return P->x >= dimMin.x && P->x <= dimMax.x
+                && P->y >= dimMin.y && P->y <= dimMax.y
+                && P->z >= dimMin.z && P->z <= dimMax.z;
+        };
+
+        // projected points per chunk, then each chunk writes its codes at its offset, in the point order
+        std::vector<pyCC_Range> ranges = pyCC_SplitRange(n, maxThreadCount);
+        std::vector<size_t> offsets(ranges.size() + 1, 0);
+        pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+        {
+            size_t count = 0;
+            for (size_t i = r.begin; i < r.end; i++)
+                if (inBox(cloud->getPoint(static_cast<unsigned>(i))))
+                    count++;
+            offsets[r.chunk + 1] = count;
+        }, maxThreadCount);
+        for (size_t c = 0; c < ranges.size(); c++)
+            offsets[c + 1] += offsets[c];
+        const size_t nbProjected = offsets.back();
+        if (nbProjected == 0)
+            return false;
+
+        const int maxCellPos = static_cast<int>(OCTREE_LENGTH(MAX_OCTREE_LEVEL)) - 1;
+        IndexAndCode* codes = m_thePointsAndTheirCellCodes.data();
+        pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+        {
+            Tuple3i cellPos;
+            IndexAndCode* out = codes + offsets[r.chunk];
+            for (size_t i = r.begin; i < r.end; i++)
+            {
+                const CCVector3* P = cloud->getPoint(static_cast<unsigned>(i));
+                if (!inBox(P))
+                    continue;
+                self->getTheCellPosWhichIncludesThePoint(P, cellPos);
+                cellPos.x = std::max(0, std::min(maxCellPos, cellPos.x));
+                cellPos.y = std::max(0, std::min(maxCellPos, cellPos.y));
+                cellPos.z = std::max(0, std::min(maxCellPos, cellPos.z));
+                out->theIndex = static_cast<unsigned>(i);
+                out->theCode = GenerateTruncatedCellCode(cellPos, MAX_OCTREE_LEVEL);
+                ++out;
+            }
+        }, maxThreadCount);
+        m_thePointsAndTheirCellCodes.resize(nbProjected);
+        if (!radixSort(m_thePointsAndTheirCellCodes, maxThreadCount))
+            return false;
+
+        m_numberOfProjectedPoints = static_cast<unsigned>(nbProjected);
+        updateMinAndMaxTables();
+        updateCellCountTable();
+        return true;
+    }
+
+    //! point indexes in the order of the built octree
+    bool sortedIndexes(std::vector<unsigned>& indexes, int maxThreadCount) const
+    {
+        try
+        {
+            indexes.resize(m_thePointsAndTheirCellCodes.size());
+        }
+        catch (const std::bad_alloc&)
+        {
+            return false;
+        }
+        const IndexAndCode* codes = m_thePointsAndTheirCellCodes.data();
+        unsigned* idx = indexes.data();
+        pyCC_ParallelFor(indexes.size(), [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                idx[i] = codes[i].theIndex;
+        }, maxThreadCount);
+        return true;
+    }
+
+protected:
+    //! stable LSD radix sort on the codes, 8 bits per pass: per chunk histograms, then parallel scatter
+    static bool radixSort(cellsContainer& a, int maxThreadCount)
+    {
+        const size_t n = a.size();
+        cellsContainer tmp;
+        try
+        {
+            tmp.resize(n);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return false;
+        }
+        std::vector<pyCC_Range> ranges = pyCC_SplitRange(n, maxThreadCount);
+        std::vector<std::array<size_t, 256>> offsets(ranges.size());
+        const int nbBits = 3 * MAX_OCTREE_LEVEL;
+        for (int shift = 0; shift < nbBits; shift += 8)
+        {
+            const IndexAndCode* src = a.data();
+            IndexAndCode* dst = tmp.data();
+            pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+            {
+                std::array<size_t, 256>& h = offsets[r.chunk];
+                h.fill(0);
+                for (size_t i = r.begin; i < r.end; i++)
+                    h[(src[i].theCode >> shift) & 0xff]++;
+            }, maxThreadCount);
+
+            // digit major, chunk minor offsets; a pass where all the codes share the digit is skipped
+            size_t running = 0;
+            bool trivial = false;
+            for (int d = 0; d < 256; d++)
+            {
+                size_t digitCount = 0;
+                for (auto& h : offsets)
+                {
+                    size_t count = h[d];
+                    h[d] = running;
+                    running += count;
+                    digitCount += count;
+                }
+                trivial = trivial || (digitCount == n);
+            }
+            if (trivial)
+                continue;
+            pyCC_ParallelForRanges(ranges, [&](const pyCC_Range& r)
+            {
+                std::array<size_t, 256>& h = offsets[r.chunk];
+                for (size_t i = r.begin; i < r.end; i++)
+                    dst[h[(src[i].theCode >> shift) & 0xff]++] = src[i];
+            }, maxThreadCount);
+            a.swap(tmp);
+        }
+        return true;
+    }
+
+    ccGenericPointCloud* m_cloud;
+};
+
+uint64_t ccGenericPointCloud_contentHash_py(ccGenericPointCloud& self)
+{
+    size_t n = self.size();
+    std::vector<pyCC_Range> ranges;
+    for (size_t begin = 0, chunk = 0; begin < n; begin += HASH_CHUNK, chunk++)
+        ranges.push_back({ chunk, begin, std::min(begin + HASH_CHUNK, n) });
+    std::vector<uint64_t> hashes(ranges.size());
+    pyCC_ParallelForRanges(ranges, [&self, &hashes](const pyCC_Range& r)
+    {
+        uint64_t h = 0xcbf29ce484222325ULL ^ r.chunk; // FNV-1a on the coordinate words
+        for (size_t i = r.begin; i < r.end; i++)
+        {
+            const CCVector3* P = self.getPoint(static_cast<unsigned>(i));
+            for (int d = 0; d < 3; d++)
+            {
+                uint64_t bits = 0;
+                memcpy(&bits, &P->u[d], sizeof(PointCoordinateType));
+                h = (h ^ bits) * 0x100000001b3ULL;
+            }
+        }
+        hashes[r.chunk] = h;
+    });
+    uint64_t hash = n;
+    for (size_t c = 0; c < hashes.size(); c++)
+        hash = (hash ^ hashes[c]) * 0x9e3779b97f4a7c15ULL + c;
+    return hash;
+}
+
+bool ccGenericPointCloud_saveOctree_py(ccGenericPointCloud& self, const QString& filename)
+{
+    ccOctree::Shared octree = self.getOctree();
+    if (!octree)
+    {
+        PyErr_SetString(PyExc_ValueError, "the cloud has no octree, use computeOctree first");
+        bp::throw_error_already_set();
+    }
+    const CCCoreLib::DgmOctree::cellsContainer& codes = octree->pointsAndTheirCellCodes();
+    OctreeFileHeader_py header;
+    memcpy(header.magic, OCTREE_MAGIC, sizeof(OCTREE_MAGIC));
+    header.coordSize = sizeof(PointCoordinateType);
+    header.indexAndCodeSize = sizeof(CCCoreLib::DgmOctree::IndexAndCode);
+    header.nbPoints = self.size();
+    header.contentHash = ccGenericPointCloud_contentHash_py(self);
+    header.nbCodes = codes.size();
+    header.nbProjectedPoints = octree->getNumberOfProjectedPoints();
+    CCVector3 bbMin, bbMax;
+    octree->getBoundingBox(bbMin, bbMax);
+    for (int d = 0; d < 3; d++)
+    {
+        header.dimMin[d] = octree->getOctreeMins().u[d];
+        header.dimMax[d] = octree->getOctreeMaxs().u[d];
+        header.pointsMin[d] = bbMin.u[d];
+        header.pointsMax[d] = bbMax.u[d];
+    }
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        CCTRACE("saveOctree: cannot open " << filename.toStdString());
+        return false;
+    }
+    qint64 dataSize = static_cast<qint64>(codes.size() * sizeof(CCCoreLib::DgmOctree::IndexAndCode));
+    bool ok = (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header))
+           && (file.write(reinterpret_cast<const char*>(codes.data()), dataSize) == dataSize);
+    CCTRACE("saveOctree: " << codes.size() << " cell codes, ok: " << ok);
+    return ok;
+}
+
+//! the restored structure is used without bounds checks by the queries: check a file that may be corrupted
+/*! finite bounding boxes, point indexes within the cloud, each point once, cell codes sorted
+ */
+static bool validCellCodes(const OctreeFileHeader_py& header,
+                           const CCCoreLib::DgmOctree::cellsContainer& codes,
+                           size_t cloudSize)
+{
+    for (int d = 0; d < 3; d++)
+    {
+        if (!std::isfinite(header.dimMin[d]) || !std::isfinite(header.dimMax[d]) || !(header.dimMin[d] <= header.dimMax[d])
+            || !std::isfinite(header.pointsMin[d]) || !std::isfinite(header.pointsMax[d]))
+            return false;
+    }
+    size_t n = codes.size();
+    std::atomic<bool> ok(true);
+    pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end && ok; i++)
+        {
+            if (codes[i].theIndex >= cloudSize || (i > 0 && codes[i].theCode < codes[i - 1].theCode))
+                ok = false;
+        }
+    });
+    if (!ok)
+        return false;
+    std::vector<bool> seen(cloudSize, false);
+    for (const auto& code : codes)
+    {
+        if (seen[code.theIndex])
+            return false;
+        seen[code.theIndex] = true;
+    }
+    return true;
+}
+
+//! dynamic property of the octree (QObject): number of points of the cloud when the octree was built
+/*! The points with NaN coordinates are not projected: the projected points can't tell a stale octree.
+ */
+static const char* OCTREE_CLOUD_SIZE = "pyccCloudSize";
+
+static void setOctreeCloudSize(ccOctree& octree, const ccGenericPointCloud& cloud)
+{
+    octree.setProperty(OCTREE_CLOUD_SIZE, QVariant(static_cast<qulonglong>(cloud.size())));
+}
+
+bool ccGenericPointCloud_loadOctree_py(ccGenericPointCloud& self, const QString& filename, bool autoAddChild)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        CCTRACE("loadOctree: cannot open " << filename.toStdString());
+        return false;
+    }
+    OctreeFileHeader_py header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+        || memcmp(header.magic, OCTREE_MAGIC, sizeof(OCTREE_MAGIC)) != 0
+        || header.coordSize != sizeof(PointCoordinateType)
+        || header.indexAndCodeSize != sizeof(CCCoreLib::DgmOctree::IndexAndCode)
+        || header.nbPoints != self.size()
+        || header.nbCodes > header.nbPoints
+        || header.nbProjectedPoints != header.nbCodes
+        || file.size() != static_cast<qint64>(sizeof(header) + header.nbCodes * sizeof(CCCoreLib::DgmOctree::IndexAndCode)))
+    {
+        CCTRACE("loadOctree: bad header or cloud size in " << filename.toStdString());
+        return false;
+    }
+    if (header.contentHash != ccGenericPointCloud_contentHash_py(self))
+    {
+        CCTRACE("loadOctree: the cloud content has changed since the octree was saved");
+        return false;
+    }
+    CCCoreLib::DgmOctree::cellsContainer codes;
+    try
+    {
+        codes.resize(header.nbCodes);
+    }
+    catch (const std::bad_alloc&)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    qint64 dataSize = static_cast<qint64>(codes.size() * sizeof(CCCoreLib::DgmOctree::IndexAndCode));
+    if (file.read(reinterpret_cast<char*>(codes.data()), dataSize) != dataSize)
+    {
+        CCTRACE("loadOctree: truncated file " << filename.toStdString());
+        return false;
+    }
+    if (!validCellCodes(header, codes, self.size()))
+    {
+        CCTRACE("loadOctree: inconsistent octree data in " << filename.toStdString());
+        return false;
+    }
+    ccOctreeBuilder_py* octree = new ccOctreeBuilder_py(&self);
+    octree->restore(header, codes);
+    setOctreeCloudSize(*octree, self);
+    self.setOctree(ccOctree::Shared(octree), autoAddChild);
+    CCTRACE("loadOctree: " << header.nbCodes << " cell codes restored");
+    return true;
+}
+
+ccOctree::Shared ccGenericPointCloud_computeOctree_py(ccGenericPointCloud& self,
+                                                     CCCoreLib::GenericProgressCallback* progressCb,
+                                                     bool autoAddChild,
+                                                     int maxThreadCount)
+{
+    // the parallel build has no progress notification
+    if (maxThreadCount == 1 || progressCb)
+    {
+        ccOctree::Shared octree = self.computeOctree(progressCb, autoAddChild);
+        if (octree)
+            setOctreeCloudSize(*octree, self);
+        return octree;
+    }
+
+    self.deleteOctree();
+    QSharedPointer<ccOctreeBuilder_py> octree(new ccOctreeBuilder_py(&self));
+    bool ok = false;
+    {
+        GILRelease_py noGIL;
+        ok = octree->parallelBuild(maxThreadCount);
+    }
+    CCTRACE("computeOctree, parallel build: " << ok << " max threads: " << maxThreadCount);
+    if (!ok)
+        return ccOctree::Shared();
+    setOctreeCloudSize(*octree, self);
+    self.setOctree(octree, autoAddChild);
+    return octree;
+}
+
+ccOctree::Shared ccGenericPointCloud_updateOctree_py(ccGenericPointCloud& self,
+                                                    CCCoreLib::GenericProgressCallback* progressCb,
+                                                    bool autoAddChild,
+                                                    int maxThreadCount)
+{
+    ccOctree::Shared octree = self.getOctree();
+    if (octree)
+    {
+        // an octree built out of CloudComPy has no recorded size: its projected points are compared
+        QVariant builtSize = octree->property(OCTREE_CLOUD_SIZE);
+        size_t size = builtSize.isValid() ? builtSize.toULongLong() : octree->getNumberOfProjectedPoints();
+        if (size == self.size())
+            return octree;
+    }
+    return ccGenericPointCloud_computeOctree_py(self, progressCb, autoAddChild, maxThreadCount);
+}
+
+std::vector<unsigned> ccGenericPointCloud_spatialOrder_py(ccGenericPointCloud& self, int maxThreadCount)
+{
+    std::vector<unsigned> indexes;
+    ccOctreeBuilder_py octree(&self);
+    if (!octree.parallelBuild(maxThreadCount) || !octree.sortedIndexes(indexes, maxThreadCount))
+    {
+        indexes.clear();
+        return indexes;
+    }
+    // the points not projected in the octree (NaN coordinates) go at the end, in their order
+    if (indexes.size() < self.size())
+    {
+        try
+        {
+            std::vector<bool> projected(self.size(), false);
+            for (unsigned i : indexes)
+                projected[i] = true;
+            for (unsigned i = 0; i < self.size(); i++)
+                if (!projected[i])
+                    indexes.push_back(i);
+        }
+        catch (const std::bad_alloc&)
+        {
+            indexes.clear();
+        }
+    }
+    return indexes;
+}
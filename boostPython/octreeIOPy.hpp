@@ -0,0 +1,76 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef OCTREEIOPY_HPP_
+#define OCTREEIOPY_HPP_
+
+#include <cstdint>
+
+#include <QString>
+
+#include <vector>
+
+#include <ccOctree.h>
+
+class ccGenericPointCloud;
+
+namespace CCCoreLib
+{
+    class GenericProgressCallback;
+}
+
+//! hash of the cloud coordinates, computed in parallel, independent of the number of threads
+uint64_t ccGenericPointCloud_contentHash_py(ccGenericPointCloud& self);
+
+//! save the octree of the cloud in a file: bounds, cell codes and index mapping, with the cloud content hash
+/*! \return false if the file cannot be written. Raises a ValueError if the cloud has no octree.
+ */
+bool ccGenericPointCloud_saveOctree_py(ccGenericPointCloud& self, const QString& filename);
+
+//! load an octree saved by ccGenericPointCloud_saveOctree_py, if it matches the cloud content
+/*! The cell codes are not recomputed nor sorted. The octree replaces the current octree of the cloud.
+ *  \return false if the file cannot be read or does not match the cloud (the cloud is not modified)
+ */
+bool ccGenericPointCloud_loadOctree_py(ccGenericPointCloud& self, const QString& filename, bool autoAddChild = true);
+
+//! compute the octree of the cloud with a multithreaded build: parallel cell codes, parallel radix sort
+/*! maxThreadCount: 0 for all the cores, 1 for the CloudCompare sequential build (with progress callback).
+ *  \return the octree, null if the build failed
+ */
+ccOctree::Shared ccGenericPointCloud_computeOctree_py(ccGenericPointCloud& self,
+                                                     CCCoreLib::GenericProgressCallback* progressCb = nullptr,
+                                                     bool autoAddChild = true,
+                                                     int maxThreadCount = 0);
+
+//! the octree of the cloud, computed only if it is missing or does not match the number of points
+/*! The octree is dropped by each modification of the coordinates done through the Python API
+ *  (see ccGenericPointCloud_notifyGeometryUpdate_py): an existing octree is up to date.
+ *  The number of points is the one recorded at the build, the points with NaN coordinates being not projected.
+ *  \return the octree, null if the build failed
+ */
+ccOctree::Shared ccGenericPointCloud_updateOctree_py(ccGenericPointCloud& self,
+                                                    CCCoreLib::GenericProgressCallback* progressCb = nullptr,
+                                                    bool autoAddChild = true,
+                                                    int maxThreadCount = 0);
+
+//! indexes of the points sorted by cell code at the deepest level (Morton order), multithreaded
+/*! \return the indexes, empty if the cloud is empty or if there is not enough memory
+ */
+std::vector<unsigned> ccGenericPointCloud_spatialOrder_py(ccGenericPointCloud& self, int maxThreadCount = 0);
+
+#endif /* OCTREEIOPY_HPP_ */
@@ -0,0 +1,552 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "packedSFPy.hpp"
+
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
+#include <ccPointCloud.h>
+#include <ScalarField.h>
+
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QVariantMap>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace bp = boost::python;
+namespace bnp = boost::python::numpy;
+
+//! metadata key of a packed scalar field
+static QString packedKey(const QString& name)
+{
+    return QString("PYCC_PackedSF:") + name;
+}
+
+//! metadata key of an evicted scalar field
+static QString evictedKey(const QString& name)
+{
+    return QString("PYCC_EvictedSF:") + name;
+}
+
+// --- IEEE 754 half precision, round to nearest even
+
+static uint16_t floatToHalf(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t mant = x & 0x7fffff;
+    int exp = (x >> 23) & 0xff;
+    if (exp == 255)
+        return static_cast<uint16_t>(sign | 0x7c00 | (mant ? 0x200 : 0)); // inf or NaN
+    int e = exp - 127 + 15;
+    if (e >= 31)
+        return static_cast<uint16_t>(sign | 0x7c00); // overflow
+    if (e <= 0) // subnormal or zero
+    {
+        if (e < -10)
+            return static_cast<uint16_t>(sign);
+        mant |= 0x800000;
+        int shift = 14 - e;
+        uint32_t h = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1)))
+            h++;
+        return static_cast<uint16_t>(sign | h);
+    }
+    uint32_t h = (static_cast<uint32_t>(e) << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1)))
+        h++; // a carry into the exponent gives the right result, up to inf
+    return static_cast<uint16_t>(sign | h);
+}
+
+static float halfToFloat(uint16_t h)
+{
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    int exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t x;
+    if (exp == 0)
+    {
+        if (mant == 0)
+            x = sign;
+        else
+        {
+            exp = 1;
+            while (!(mant & 0x400))
+            {
+                mant <<= 1;
+                exp--;
+            }
+            mant &= 0x3ff;
+            x = sign | (static_cast<uint32_t>(exp + 127 - 15) << 23) | (mant << 13);
+        }
+    }
+    else if (exp == 31)
+        x = sign | 0x7f800000 | (mant << 13);
+    else
+        x = sign | (static_cast<uint32_t>(exp + 127 - 15) << 23) | (mant << 13);
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+// --- encoders and decoders, one parallel pass
+
+template<typename T> static void encodeInt(const ScalarType* v, size_t n, T* out, double scale, double offset)
+{
+    const double low = static_cast<double>(std::numeric_limits<T>::min());
+    const double high = static_cast<double>(std::numeric_limits<T>::max()) - 1; // max is NaN
+    pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            double x = v[i];
+            if (std::isnan(x))
+                out[i] = std::numeric_limits<T>::max();
+            else
+                out[i] = static_cast<T>(std::min(std::max(std::nearbyint((x - offset) / scale), low), high));
+        }
+    });
+}
+
+template<typename T> static void decodeInt(const T* in, size_t n, ScalarType* v, double scale, double offset)
+{
+    pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            v[i] = (in[i] == std::numeric_limits<T>::max()) ? CCCoreLib::NAN_VALUE
+                                                            : static_cast<ScalarType>(in[i] * scale + offset);
+    });
+}
+
+static void encodeHalf(const ScalarType* v, size_t n, uint16_t* out, double scale, double offset)
+{
+    pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            out[i] = floatToHalf(static_cast<float>((v[i] - offset) / scale));
+    });
+}
+
+static void decodeHalf(const uint16_t* in, size_t n, ScalarType* v, double scale, double offset)
+{
+    pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            v[i] = static_cast<ScalarType>(halfToFloat(in[i]) * scale + offset);
+    });
+}
+
+//! the packed data is stored in a QByteArray (cloud metadata), its size is an int, header included
+static const size_t PACKED_MAX_BYTES = static_cast<size_t>(std::numeric_limits<int>::max()) - 64;
+
+//! size in bytes of an element of a packed type, 0 if the type is unknown
+static size_t packedTypeSize(const std::string& type)
+{
+    if (type == "uint8")
+        return 1;
+    if (type == "int16" || type == "uint16" || type == "float16")
+        return 2;
+    if (type == "int32")
+        return 4;
+    return 0;
+}
+
+static QVariantMap packedField(ccPointCloud& self, const QString& name)
+{
+    QString key = packedKey(name);
+    if (!self.hasMetaData(key))
+    {
+        PyErr_Format(PyExc_KeyError, "no packed scalar field named %s", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    QVariantMap field = self.getMetaData(key).toMap();
+    std::string type = field["type"].toString().toStdString();
+    if (static_cast<size_t>(field["data"].toByteArray().size()) != self.size() * packedTypeSize(type))
+    {
+        PyErr_Format(PyExc_ValueError, "packed scalar field %s does not match the cloud size", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    return field;
+}
+
+size_t packScalarField_py(ccPointCloud& self, const QString& name, const std::string& type, double scale, double offset)
+{
+    size_t elemSize = packedTypeSize(type);
+    if (elemSize == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "unknown packed type, use uint8, int16, uint16, int32 or float16");
+        bp::throw_error_already_set();
+    }
+    if (!(scale > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "scale must be strictly positive");
+        bp::throw_error_already_set();
+    }
+    int sfIdx = self.getScalarFieldIndexByName(qPrintable(name));
+    if (sfIdx < 0)
+    {
+        PyErr_Format(PyExc_KeyError, "no scalar field named %s", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    if (self.hasMetaData(packedKey(name)))
+    {
+        PyErr_Format(PyExc_ValueError, "a packed scalar field named %s already exists", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    CCCoreLib::ScalarField* sf = self.getScalarField(sfIdx);
+    size_t n = sf->size();
+    if (n * elemSize > PACKED_MAX_BYTES)
+    {
+        PyErr_Format(PyExc_ValueError, "packed scalar field %s too large: %zu bytes, %zu at most",
+                     qPrintable(name), n * elemSize, PACKED_MAX_BYTES);
+        bp::throw_error_already_set();
+    }
+    QByteArray data(static_cast<int>(n * elemSize), Qt::Uninitialized);
+    const ScalarType* v = sf->data();
+    if (type == "uint8")
+        encodeInt(v, n, reinterpret_cast<uint8_t*>(data.data()), scale, offset);
+    else if (type == "int16")
+        encodeInt(v, n, reinterpret_cast<int16_t*>(data.data()), scale, offset);
+    else if (type == "uint16")
+        encodeInt(v, n, reinterpret_cast<uint16_t*>(data.data()), scale, offset);
+    else if (type == "int32")
+        encodeInt(v, n, reinterpret_cast<int32_t*>(data.data()), scale, offset);
+    else
+        encodeHalf(v, n, reinterpret_cast<uint16_t*>(data.data()), scale, offset);
+
+    QVariantMap field;
+    field["type"] = QString::fromStdString(type);
+    field["scale"] = scale;
+    field["offset"] = offset;
+    field["data"] = data;
+    self.setMetaData(packedKey(name), field);
+    self.deleteScalarField(sfIdx);
+    CCTRACE("packScalarField " << name.toStdString() << " " << type << ": " << n * sizeof(ScalarType) << " -> " << data.size() << " bytes");
+    return data.size();
+}
+
+int unpackScalarField_py(ccPointCloud& self, const QString& name)
+{
+    QVariantMap field = packedField(self, name);
+    if (self.getScalarFieldIndexByName(qPrintable(name)) >= 0)
+    {
+        PyErr_Format(PyExc_ValueError, "a scalar field named %s already exists", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    int sfIdx = self.addScalarField(qPrintable(name));
+    if (sfIdx < 0)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+    std::string type = field["type"].toString().toStdString();
+    double scale = field["scale"].toDouble();
+    double offset = field["offset"].toDouble();
+    QByteArray data = field["data"].toByteArray();
+    CCCoreLib::ScalarField* sf = self.getScalarField(sfIdx);
+    ScalarType* v = sf->data();
+    size_t n = self.size();
+    if (type == "uint8")
+        decodeInt(reinterpret_cast<const uint8_t*>(data.constData()), n, v, scale, offset);
+    else if (type == "int16")
+        decodeInt(reinterpret_cast<const int16_t*>(data.constData()), n, v, scale, offset);
+    else if (type == "uint16")
+        decodeInt(reinterpret_cast<const uint16_t*>(data.constData()), n, v, scale, offset);
+    else if (type == "int32")
+        decodeInt(reinterpret_cast<const int32_t*>(data.constData()), n, v, scale, offset);
+    else
+        decodeHalf(reinterpret_cast<const uint16_t*>(data.constData()), n, v, scale, offset);
+    sf->computeMinAndMax();
+    self.removeMetaData(packedKey(name));
+    CCTRACE("unpackScalarField " << name.toStdString() << " " << type);
+    return sfIdx;
+}
+
+bp::tuple getPackedScalarField_py(ccPointCloud& self, const QString& name)
+{
+    QVariantMap field = packedField(self, name);
+    QByteArray data = field["data"].toByteArray();
+    bnp::dtype dt = bnp::dtype(bp::str(field["type"].toString().toStdString()));
+    bnp::ndarray result = bnp::empty(bp::make_tuple(self.size()), dt);
+    memcpy(result.get_data(), data.constData(), data.size());
+    return bp::make_tuple(result, field["scale"].toDouble(), field["offset"].toDouble());
+}
+
+//! names of the fields stored in metadata under a prefix
+static bp::list storedNames(ccPointCloud& self, const QString& prefix)
+{
+    bp::list names;
+    for (const QString& key : self.metaData().keys())
+    {
+        if (key.startsWith(prefix))
+            names.append(key.mid(prefix.size()));
+    }
+    return names;
+}
+
+bp::list getPackedScalarFieldNames_py(ccPointCloud& self)
+{
+    return storedNames(self, packedKey(QString()));
+}
+
+//! directory of the evicted scalar fields, removed at exit
+static QString evictionDir()
+{
+    static std::unique_ptr<QTemporaryDir> dir;
+    if (!dir)
+        dir.reset(new QTemporaryDir(QDir::tempPath() + "/pyccEvictedSF-XXXXXX"));
+    if (!dir->isValid())
+    {
+        PyErr_SetString(PyExc_IOError, "cannot create a temporary directory for evicted scalar fields");
+        bp::throw_error_already_set();
+    }
+    return dir->path();
+}
+
+//! write the scalar field to a new temporary file, delete it and record the file in the metadata
+static bool evictField(ccPointCloud& self, int sfIdx, QString& error)
+{
+    static unsigned fileCounter = 0;
+    QString name = self.getScalarFieldName(sfIdx);
+    CCCoreLib::ScalarField* sf = self.getScalarField(sfIdx);
+    size_t nbBytes = sf->size() * sizeof(ScalarType);
+    QString path = evictionDir() + QString("/sf%1.raw").arg(fileCounter++);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(reinterpret_cast<const char*>(sf->data()), nbBytes) != static_cast<qint64>(nbBytes))
+    {
+        file.remove();
+        error = QString("cannot write the evicted scalar field %1").arg(name);
+        return false;
+    }
+    file.close();
+    QVariantMap field;
+    field["file"] = path;
+    field["size"] = static_cast<qulonglong>(sf->size());
+    self.setMetaData(evictedKey(name), field);
+    self.deleteScalarField(sfIdx);
+    return true;
+}
+
+//! read an evicted field back in a new scalar field and remove its metadata, -1 on error
+/*! The file is kept: clones made by CloudCompare copy the metadata, and may share it.
+ */
+static int restoreField(ccPointCloud& self, const QString& name, QString& error)
+{
+    QString key = evictedKey(name);
+    QVariantMap field = self.getMetaData(key).toMap();
+    size_t n = field["size"].toULongLong();
+    if (n != self.size() || self.getScalarFieldIndexByName(qPrintable(name)) >= 0)
+    {
+        error = QString("evicted scalar field %1 does not match the cloud (size or name in use)").arg(name);
+        return -1;
+    }
+    int sfIdx = self.addScalarField(qPrintable(name));
+    if (sfIdx < 0)
+    {
+        error = "Not enough memory";
+        return -1;
+    }
+    CCCoreLib::ScalarField* sf = self.getScalarField(sfIdx);
+    size_t nbBytes = n * sizeof(ScalarType);
+    QFile file(field["file"].toString());
+    if (!file.open(QIODevice::ReadOnly)
+        || file.read(reinterpret_cast<char*>(sf->data()), nbBytes) != static_cast<qint64>(nbBytes))
+    {
+        self.deleteScalarField(sfIdx);
+        error = QString("cannot read the evicted scalar field %1").arg(name);
+        return -1;
+    }
+    sf->computeMinAndMax();
+    self.removeMetaData(key);
+    return sfIdx;
+}
+
+size_t evictScalarField_py(ccPointCloud& self, const QString& name)
+{
+    int sfIdx = self.getScalarFieldIndexByName(qPrintable(name));
+    if (sfIdx < 0)
+    {
+        PyErr_Format(PyExc_KeyError, "no scalar field named %s", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    if (self.hasMetaData(evictedKey(name)) || self.hasMetaData(packedKey(name)))
+    {
+        PyErr_Format(PyExc_ValueError, "a stored scalar field named %s already exists", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    size_t nbBytes = self.getScalarField(sfIdx)->size() * sizeof(ScalarType);
+    QString error;
+    if (!evictField(self, sfIdx, error))
+    {
+        PyErr_SetString(PyExc_IOError, qPrintable(error));
+        bp::throw_error_already_set();
+    }
+    CCTRACE("evictScalarField " << name.toStdString() << ": " << nbBytes << " bytes");
+    return nbBytes;
+}
+
+int evictScalarFields_py(ccPointCloud& self, double maxBytes)
+{
+    // the last added fields first, the displayed field last
+    std::vector<QString> candidates;
+    int displayed = self.getCurrentDisplayedScalarFieldIndex();
+    for (int k = static_cast<int>(self.getNumberOfScalarFields()) - 1; k >= 0; k--)
+        if (k != displayed)
+            candidates.push_back(self.getScalarFieldName(k));
+    if (displayed >= 0)
+        candidates.push_back(self.getScalarFieldName(displayed));
+
+    const size_t fieldBytes = self.size() * sizeof(ScalarType);
+    size_t resident = self.getNumberOfScalarFields() * fieldBytes;
+    int count = 0;
+    for (const QString& name : candidates)
+    {
+        if (maxBytes > 0 && resident <= maxBytes)
+            break;
+        evictScalarField_py(self, name);
+        resident -= fieldBytes;
+        count++;
+    }
+    return count;
+}
+
+int restoreScalarField_py(ccPointCloud& self, const QString& name)
+{
+    if (!self.hasMetaData(evictedKey(name)))
+    {
+        PyErr_Format(PyExc_KeyError, "no evicted scalar field named %s", qPrintable(name));
+        bp::throw_error_already_set();
+    }
+    QString error;
+    int sfIdx = restoreField(self, name, error);
+    if (sfIdx < 0)
+    {
+        PyErr_SetString(error == "Not enough memory" ? PyExc_MemoryError : PyExc_IOError, qPrintable(error));
+        bp::throw_error_already_set();
+    }
+    CCTRACE("restoreScalarField " << name.toStdString());
+    return sfIdx;
+}
+
+EvictedFieldsGuard_py::EvictedFieldsGuard_py(ccHObject* entity, bool withPacked)
+{
+    if (!entity)
+        return;
+    ccHObject::Container clouds;
+    if (entity->isA(CC_TYPES::POINT_CLOUD))
+        clouds.push_back(entity);
+    entity->filterChildren(clouds, true, CC_TYPES::POINT_CLOUD, true);
+    for (ccHObject* object : clouds)
+    {
+        ccPointCloud* cloud = static_cast<ccPointCloud*>(object);
+        for (const QString& key : cloud->metaData().keys())
+        {
+            if (key.startsWith(evictedKey(QString())))
+            {
+                QString name = key.mid(evictedKey(QString()).size());
+                QVariant field = cloud->getMetaData(key);
+                if (restoreField(*cloud, name, m_error) < 0)
+                    return;
+                m_restored.push_back({ cloud, name, key, field });
+            }
+            else if (withPacked && key.startsWith(packedKey(QString())))
+            {
+                QString name = key.mid(packedKey(QString()).size());
+                QVariant field = cloud->getMetaData(key);
+                try
+                {
+                    unpackScalarField_py(*cloud, name);
+                }
+                catch (const bp::error_already_set&)
+                {
+                    PyErr_Clear();
+                    m_error = QString("the packed scalar field %1 can't be unpacked").arg(name);
+                    return;
+                }
+                m_restored.push_back({ cloud, name, key, field });
+            }
+        }
+    }
+}
+
+EvictedFieldsGuard_py::~EvictedFieldsGuard_py()
+{
+    // the files and the packed data were kept: evict or pack again without writing nor encoding
+    for (const Restored& r : m_restored)
+    {
+        int sfIdx = r.cloud->getScalarFieldIndexByName(qPrintable(r.name));
+        if (sfIdx < 0)
+            continue;
+        r.cloud->deleteScalarField(sfIdx);
+        r.cloud->setMetaData(r.key, r.field);
+    }
+}
+
+void EvictedFieldsGuard_py::check() const
+{
+    if (!m_error.isEmpty())
+    {
+        PyErr_SetString(PyExc_IOError, qPrintable(m_error));
+        bp::throw_error_already_set();
+    }
+}
+
+bp::list getEvictedScalarFieldNames_py(ccPointCloud& self)
+{
+    return storedNames(self, evictedKey(QString()));
+}
+
+int materializeScalarField_py(ccPointCloud& self, const QString& name)
+{
+    if (self.hasMetaData(evictedKey(name)))
+        return restoreScalarField_py(self, name);
+    if (self.hasMetaData(packedKey(name)))
+        return unpackScalarField_py(self, name);
+    return -1;
+}
+
+int materializeScalarFields_py(ccPointCloud& self)
+{
+    bp::list names = getEvictedScalarFieldNames_py(self);
+    names.extend(getPackedScalarFieldNames_py(self));
+    int nb = 0;
+    for (int i = 0; i < bp::len(names); i++)
+    {
+        QString name = bp::extract<QString>(names[i]);
+        if (materializeScalarField_py(self, name) >= 0)
+            nb++;
+    }
+    return nb;
+}
@@ -0,0 +1,115 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef PACKEDSFPY_HPP_
+#define PACKEDSFPY_HPP_
+
+#include <boost/python.hpp>
+#include <string>
+
+#include <QString>
+#include <QVariant>
+
+#include <vector>
+
+class ccHObject;
+class ccPointCloud;
+
+// --- Packed scalar fields: compact storage (uint8, int16, uint16, int32, float16, with scale and offset)
+// of scalar fields not in use. CCCoreLib scalar fields have a fixed ScalarType storage, so a packed field is
+// removed from the cloud scalar fields and kept in the cloud metadata, until it is unpacked.
+
+//! encode the scalar field in the given type, store it in the cloud metadata and delete the scalar field
+/*! value = code * scale + offset. For integer types the largest code is reserved for NaN.
+ *  \return the size of the packed data, in bytes
+ */
+size_t packScalarField_py(ccPointCloud& self, const QString& name, const std::string& type,
+                          double scale = 1., double offset = 0.);
+
+//! decode a packed field into a new scalar field, in parallel, and remove the packed data
+/*! \return the index of the new scalar field
+ */
+int unpackScalarField_py(ccPointCloud& self, const QString& name);
+
+//! a copy of the packed data as a numpy array of its native dtype, with scale and offset: (array, scale, offset)
+boost::python::tuple getPackedScalarField_py(ccPointCloud& self, const QString& name);
+
+//! names of the packed scalar fields of the cloud
+boost::python::list getPackedScalarFieldNames_py(ccPointCloud& self);
+
+// --- Evicted scalar fields: the values are written to a temporary file and the scalar field is deleted.
+// The field is read back on demand (getScalarField by name), at the cost of a single file read.
+// The files are in a temporary directory removed at the end of the Python session. A file is kept when
+// its field is restored: clones of the cloud made by CloudCompare copy the metadata and may share it.
+// Eviction is explicit: the script decides which fields to evict, or evicts down to a memory budget.
+
+//! write the scalar field to a temporary file and delete it from the cloud
+/*! \return the size of the memory released, in bytes
+ */
+size_t evictScalarField_py(ccPointCloud& self, const QString& name);
+
+//! evict the scalar fields of the cloud until they use at most maxBytes, all of them if maxBytes is 0
+/*! The last added fields are evicted first, the displayed field last.
+ *  \return the number of evicted fields
+ */
+int evictScalarFields_py(ccPointCloud& self, double maxBytes = 0);
+
+//! read back an evicted scalar field
+/*! \return the index of the new scalar field
+ */
+int restoreScalarField_py(ccPointCloud& self, const QString& name);
+
+//! names of the evicted scalar fields of the cloud
+boost::python::list getEvictedScalarFieldNames_py(ccPointCloud& self);
+
+//! restore an evicted field or unpack a packed field, -1 if there is no such field
+int materializeScalarField_py(ccPointCloud& self, const QString& name);
+
+//! restore all the evicted fields and unpack all the packed fields of the cloud
+/*! \return the number of fields materialized
+ */
+int materializeScalarFields_py(ccPointCloud& self);
+
+//! restores the evicted fields of a cloud and its child clouds for the time of an operation
+/*! Save and clone operations do not know the evicted fields: they are materialised by the guard,
+ *  and evicted again (without writing) when the guard is destroyed. Call check() after construction.
+ *  withPacked: the packed fields are also unpacked, and packed again from their saved data, for the operations
+ *  on a subset of the points (the clone would copy packed data of the former number of points).
+ */
+class EvictedFieldsGuard_py
+{
+public:
+    explicit EvictedFieldsGuard_py(ccHObject* entity, bool withPacked = false);
+    ~EvictedFieldsGuard_py();
+
+    //! raise a Python IOError if a field could not be restored
+    void check() const;
+
+private:
+    struct Restored
+    {
+        ccPointCloud* cloud;
+        QString name;
+        QString key;        //!< metadata key of the evicted or packed field
+        QVariant field;
+    };
+    std::vector<Restored> m_restored;
+    QString m_error;
+};
+
+#endif /* PACKEDSFPY_HPP_ */
@@ -0,0 +1,344 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "voxelAggregatePy.hpp"
+
+#include <ccOctree.h>
+#include <ccPointCloud.h>
+#include <ScalarField.h>
+
+#include "ccOctreePy.hpp"
+#include "ccPointCloudPy.hpp"
+#include "gilPy.hpp"
+#include "octreeIOPy.hpp"
+#include "pyccParallel.h"
+#include "pyccTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace bp = boost::python;
+
+namespace
+{
+    enum VoxelStat_py { VOXEL_MEAN, VOXEL_MIN, VOXEL_MAX, VOXEL_SUM, VOXEL_STD, VOXEL_MEDIAN, VOXEL_NB_STATS };
+
+    const char* voxelStatNames[VOXEL_NB_STATS] = { "mean", "min", "max", "sum", "std", "median" };
+
+    //! an aggregated field: a coordinate or a scalar field, with its statistics and their output fields
+    struct VoxelField_py
+    {
+        std::string name;
+        int axis = -1;                            //!< 0, 1, 2 for X, Y, Z, -1 for a scalar field
+        CCCoreLib::ScalarField* sf = nullptr;
+        std::vector<VoxelStat_py> stats;
+        std::vector<ScalarType*> out;
+        bool withMedian = false;
+    };
+}
+
+static VoxelStat_py voxelStat(const std::string& name)
+{
+    for (int s = 0; s < VOXEL_NB_STATS; s++)
+    {
+        if (name == voxelStatNames[s])
+            return static_cast<VoxelStat_py>(s);
+    }
+    PyErr_Format(PyExc_ValueError, "unknown statistic '%s', use mean, min, max, sum, std or median", name.c_str());
+    bp::throw_error_already_set();
+    return VOXEL_MEAN;
+}
+
+//! "mean" is the only statistic on colors and normals
+static bool meanOnly(const std::string& key, bp::object value, bool available)
+{
+    bp::extract<std::string> stat(value);
+    if (!stat.check() || stat() != "mean")
+    {
+        PyErr_Format(PyExc_ValueError, "only 'mean' is available for %s", key.c_str());
+        bp::throw_error_already_set();
+    }
+    if (!available)
+    {
+        PyErr_Format(PyExc_ValueError, "the cloud has no %s", key == "color" ? "colors" : "normals");
+        bp::throw_error_already_set();
+    }
+    return true;
+}
+
+ccPointCloud* voxelAggregate_py(ccPointCloud* cloud, int level, double cellSize, bp::dict aggregates)
+{
+    if (!cloud)
+    {
+        PyErr_SetString(PyExc_ValueError, "a cloud is required");
+        bp::throw_error_already_set();
+    }
+    bool withCount = false;
+    bool withColor = false;
+    bool withNormal = false;
+    std::vector<VoxelField_py> fields;
+    bp::list keys = aggregates.keys();
+    for (int i = 0; i < bp::len(keys); i++)
+    {
+        std::string key = bp::extract<std::string>(keys[i]);
+        bp::object value = aggregates[keys[i]];
+        if (key == "count")
+        {
+            withCount = bp::extract<bool>(value);
+            continue;
+        }
+        if (key == "color")
+        {
+            withColor = meanOnly(key, value, cloud->hasColors());
+            continue;
+        }
+        if (key == "normal")
+        {
+            withNormal = meanOnly(key, value, cloud->hasNormals());
+            continue;
+        }
+        VoxelField_py field;
+        field.name = key;
+        if (key == "X" || key == "Y" || key == "Z")
+            field.axis = key[0] - 'X';
+        else
+        {
+            field.sf = getScalarFieldByName_py(*cloud, QString::fromStdString(key));
+            if (!field.sf)
+            {
+                PyErr_Format(PyExc_KeyError, "no scalar field named %s", key.c_str());
+                bp::throw_error_already_set();
+            }
+        }
+        bp::extract<std::string> single(value);
+        if (single.check())
+            field.stats.push_back(voxelStat(single()));
+        else
+        {
+            for (int k = 0; k < bp::len(value); k++)
+                field.stats.push_back(voxelStat(bp::extract<std::string>(value[k])));
+        }
+        field.withMedian = std::find(field.stats.begin(), field.stats.end(), VOXEL_MEDIAN) != field.stats.end();
+        fields.push_back(field);
+    }
+
+    // the output scalar fields must have distinct names (repeated statistic, "count")
+    std::set<std::string> outNames;
+    if (withCount)
+        outNames.insert("count");
+    for (const VoxelField_py& field : fields)
+    {
+        for (VoxelStat_py stat : field.stats)
+        {
+            std::string name = field.name + "_" + voxelStatNames[stat];
+            if (!outNames.insert(name).second)
+            {
+                PyErr_Format(PyExc_ValueError, "duplicate output scalar field %s", name.c_str());
+                bp::throw_error_already_set();
+            }
+        }
+    }
+
+    if (level < 0 || level > CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL)
+    {
+        PyErr_SetString(PyExc_ValueError, "level out of range");
+        bp::throw_error_already_set();
+    }
+    if (level == 0 && !(cellSize > 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "an octree level or a cell size is required");
+        bp::throw_error_already_set();
+    }
+    ccOctree::Shared octree = ccGenericPointCloud_updateOctree_py(*cloud);
+    if (!octree)
+    {
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory, or empty cloud");
+        bp::throw_error_already_set();
+    }
+    if (level == 0)
+    {
+        level = CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL;
+        for (int l = 1; l < CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL; l++)
+        {
+            if (octree->getCellSize(static_cast<unsigned char>(l)) <= cellSize)
+            {
+                level = l;
+                break;
+            }
+        }
+    }
+    std::vector<size_t> starts;
+    {
+        GILRelease_py noGIL;
+        starts = DgmOctree_cellStarts_py(*octree, static_cast<unsigned char>(level));
+    }
+    unsigned nbCells = static_cast<unsigned>(starts.size() - 1);
+
+    ccPointCloud* result = new ccPointCloud(cloud->getName() + ".voxels");
+    result->setGlobalShift(cloud->getGlobalShift());
+    result->setGlobalScale(cloud->getGlobalScale());
+    bool ok = result->reserve(nbCells) && result->resize(nbCells);
+    if (ok && withColor)
+        ok = result->resizeTheRGBTable(false);
+    if (ok && withNormal)
+        ok = result->resizeTheNormsTable();
+    ScalarType* countOut = nullptr;
+    if (ok && withCount)
+    {
+        int sfIdx = result->addScalarField("count");
+        ok = (sfIdx >= 0);
+        if (ok)
+            countOut = result->getScalarField(sfIdx)->data();
+    }
+    for (VoxelField_py& field : fields)
+    {
+        for (size_t k = 0; ok && k < field.stats.size(); k++)
+        {
+            std::string name = field.name + "_" + voxelStatNames[field.stats[k]];
+            int sfIdx = result->addScalarField(name.c_str());
+            ok = (sfIdx >= 0);
+            if (ok)
+                field.out.push_back(result->getScalarField(sfIdx)->data());
+        }
+    }
+    if (!ok)
+    {
+        delete result;
+        PyErr_SetString(PyExc_MemoryError, "Not enough memory");
+        bp::throw_error_already_set();
+    }
+
+    {
+        GILRelease_py noGIL;
+        const CCCoreLib::DgmOctree::cellsContainer& cells = octree->pointsAndTheirCellCodes();
+        pyCC_ParallelFor(nbCells, [&](size_t begin, size_t end)
+        {
+            std::vector<double> values;
+            for (size_t c = begin; c < end; c++)
+            {
+                const size_t first = starts[c];
+                const size_t last = starts[c + 1];
+                const double n = static_cast<double>(last - first);
+                CCVector3d centroid(0, 0, 0);
+                for (size_t i = first; i < last; i++)
+                {
+                    const CCVector3* P = cloud->getPoint(cells[i].theIndex);
+                    centroid += CCVector3d(P->x, P->y, P->z);
+                }
+                centroid /= n;
+                *result->point(static_cast<unsigned>(c)) = CCVector3(static_cast<PointCoordinateType>(centroid.x),
+                                                                     static_cast<PointCoordinateType>(centroid.y),
+                                                                     static_cast<PointCoordinateType>(centroid.z));
+                if (countOut)
+                    countOut[c] = static_cast<ScalarType>(n);
+
+                for (const VoxelField_py& field : fields)
+                {
+                    // Welford mean and variance, NaN values ignored
+                    size_t count = 0;
+                    double mean = 0, m2 = 0, sum = 0;
+                    double vmin = std::numeric_limits<double>::infinity();
+                    double vmax = -vmin;
+                    values.clear();
+                    for (size_t i = first; i < last; i++)
+                    {
+                        unsigned index = cells[i].theIndex;
+                        double v = (field.axis >= 0) ? cloud->getPoint(index)->u[field.axis] : field.sf->getValue(index);
+                        if (std::isnan(v))
+                            continue;
+                        count++;
+                        double delta = v - mean;
+                        mean += delta / count;
+                        m2 += delta * (v - mean);
+                        sum += v;
+                        vmin = std::min(vmin, v);
+                        vmax = std::max(vmax, v);
+                        if (field.withMedian)
+                            values.push_back(v);
+                    }
+                    for (size_t k = 0; k < field.stats.size(); k++)
+                    {
+                        double stat = std::numeric_limits<double>::quiet_NaN();
+                        if (count > 0)
+                        {
+                            switch (field.stats[k])
+                            {
+                            case VOXEL_MEAN: stat = mean; break;
+                            case VOXEL_MIN: stat = vmin; break;
+                            case VOXEL_MAX: stat = vmax; break;
+                            case VOXEL_SUM: stat = sum; break;
+                            case VOXEL_STD: stat = std::sqrt(m2 / count); break;
+                            case VOXEL_MEDIAN:
+                            {
+                                size_t mid = values.size() / 2;
+                                std::nth_element(values.begin(), values.begin() + mid, values.end());
+                                stat = values[mid];
+                                if (values.size() % 2 == 0)
+                                    stat = (stat + *std::max_element(values.begin(), values.begin() + mid)) / 2;
+                                break;
+                            }
+                            default: break;
+                            }
+                        }
+                        field.out[k][c] = static_cast<ScalarType>(stat);
+                    }
+                }
+
+                if (withColor)
+                {
+                    uint64_t rgba[4] = { 0, 0, 0, 0 };
+                    for (size_t i = first; i < last; i++)
+                    {
+                        const ccColor::Rgba& col = cloud->getPointColor(cells[i].theIndex);
+                        rgba[0] += col.r;
+                        rgba[1] += col.g;
+                        rgba[2] += col.b;
+                        rgba[3] += col.a;
+                    }
+                    uint64_t nb = static_cast<uint64_t>(last - first);
+                    result->rgbaColors()->at(c) = ccColor::Rgba(static_cast<ColorCompType>((rgba[0] + nb / 2) / nb),
+                                                                static_cast<ColorCompType>((rgba[1] + nb / 2) / nb),
+                                                                static_cast<ColorCompType>((rgba[2] + nb / 2) / nb),
+                                                                static_cast<ColorCompType>((rgba[3] + nb / 2) / nb));
+                }
+                if (withNormal)
+                {
+                    CCVector3 N(0, 0, 0);
+                    for (size_t i = first; i < last; i++)
+                        N += cloud->getPointNormal(cells[i].theIndex);
+                    N.normalize();
+                    result->setPointNormal(static_cast<unsigned>(c), N);
+                }
+            }
+        });
+    }
+
+    for (unsigned k = 0; k < result->getNumberOfScalarFields(); k++)
+        result->getScalarField(k)->computeMinAndMax();
+    if (result->getNumberOfScalarFields())
+        result->setCurrentDisplayedScalarField(0);
+    result->showColors(withColor);
+    result->showNormals(withNormal);
+    CCTRACE("voxelAggregate: level " << level << ", " << nbCells << " cells, " << fields.size() << " aggregated fields");
+    return result;
+}
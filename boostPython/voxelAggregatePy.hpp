@@ -0,0 +1,37 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef VOXELAGGREGATEPY_HPP_
+#define VOXELAGGREGATEPY_HPP_
+
+#include <boost/python.hpp>
+
+class ccPointCloud;
+
+//! one point per non empty octree cell, with per cell statistics of coordinates, scalar fields, colors, normals
+/*! level: octree level, or 0 to use the first level with a cell size <= cellSize.
+ *  aggregates: {field: stat or [stats]}, field in "X", "Y", "Z" or a scalar field name,
+ *  stat in "mean", "min", "max", "sum", "std", "median"; {"count": True}, {"color": "mean"}, {"normal": "mean"}.
+ *  The cells are processed in parallel, GIL released.
+ */
+ccPointCloud* voxelAggregate_py(ccPointCloud* cloud,
+                                int level = 0,
+                                double cellSize = 0,
+                                boost::python::dict aggregates = boost::python::dict());
+
+#endif /* VOXELAGGREGATEPY_HPP_ */
@@ -0,0 +1,505 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "pyccCellKernels.h"
+
+#include <ccPointCloud.h>
+#include <CCConst.h>
+#include <DgmOctree.h>
+#include <ReferenceCloud.h>
+#include <ScalarField.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <locale>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+    //! a kernel with a fixed list of outputs, selected by name
+    class NamedOutputsKernel : public pyCC_CellKernel
+    {
+    public:
+        NamedOutputsKernel(const std::vector<std::string>& names, const std::vector<std::string>& defaults)
+            : m_names(names), m_defaults(defaults) {}
+
+        bool setOutputs(std::vector<std::string>& outputs, ccPointCloud& cloud, std::string& error) override
+        {
+            if (outputs.empty())
+                outputs = m_defaults;
+            m_selected.clear();
+            for (const std::string& output : outputs)
+            {
+                auto it = std::find(m_names.begin(), m_names.end(), output);
+                if (it == m_names.end())
+                {
+                    error = "unknown output '" + output + "', available outputs:";
+                    for (const std::string& name : m_names)
+                        error += " " + name;
+                    return false;
+                }
+                m_selected.push_back(static_cast<int>(it - m_names.begin()));
+            }
+            return true;
+        }
+
+    protected:
+        //! write the same value for all the points of the cell
+        static void fill(CCCoreLib::ReferenceCloud& cell, ScalarType* output, double value)
+        {
+            for (unsigned i = 0; i < cell.size(); i++)
+                output[cell.getPointGlobalIndex(i)] = static_cast<ScalarType>(value);
+        }
+
+        std::vector<std::string> m_names;
+        std::vector<std::string> m_defaults;
+        std::vector<int> m_selected; //!< index in m_names of each requested output
+    };
+
+    //! centroid, covariance matrix (xx, yy, zz, xy, xz, yz) of the points of a cell
+    void cellCovariance(CCCoreLib::ReferenceCloud& cell, CCVector3d& centroid, double cov[6])
+    {
+        unsigned n = cell.size();
+        centroid = CCVector3d(0, 0, 0);
+        for (unsigned i = 0; i < n; i++)
+            centroid += cell.getPoint(i)->toDouble();
+        centroid /= n;
+        std::fill(cov, cov + 6, 0.0);
+        for (unsigned i = 0; i < n; i++)
+        {
+            CCVector3d d = cell.getPoint(i)->toDouble() - centroid;
+            cov[0] += d.x * d.x;
+            cov[1] += d.y * d.y;
+            cov[2] += d.z * d.z;
+            cov[3] += d.x * d.y;
+            cov[4] += d.x * d.z;
+            cov[5] += d.y * d.z;
+        }
+        for (int k = 0; k < 6; k++)
+            cov[k] /= n;
+    }
+
+    //! eigenvalues of a symmetric 3x3 matrix in decreasing order, and the eigenvector of the smallest one
+    /*! closed form (trigonometric solution of the characteristic polynomial)
+     */
+    void symmetricEigen(const double cov[6], double lambda[3], CCVector3d& smallest)
+    {
+        const double a00 = cov[0], a11 = cov[1], a22 = cov[2], a01 = cov[3], a02 = cov[4], a12 = cov[5];
+        const double p1 = a01 * a01 + a02 * a02 + a12 * a12;
+        const double q = (a00 + a11 + a22) / 3;
+        if (p1 <= 0)
+        {
+            lambda[0] = a00; lambda[1] = a11; lambda[2] = a22;
+            std::sort(lambda, lambda + 3, [](double a, double b) { return a > b; });
+        }
+        else
+        {
+            const double p2 = (a00 - q) * (a00 - q) + (a11 - q) * (a11 - q) + (a22 - q) * (a22 - q) + 2 * p1;
+            const double p = std::sqrt(p2 / 6);
+            const double b00 = (a00 - q) / p, b11 = (a11 - q) / p, b22 = (a22 - q) / p;
+            const double b01 = a01 / p, b02 = a02 / p, b12 = a12 / p;
+            double r = (b00 * (b11 * b22 - b12 * b12) - b01 * (b01 * b22 - b12 * b02) + b02 * (b01 * b12 - b11 * b02)) / 2;
+            r = std::min(std::max(r, -1.0), 1.0);
+            const double phi = std::acos(r) / 3;
+            lambda[0] = q + 2 * p * std::cos(phi);
+            lambda[2] = q + 2 * p * std::cos(phi + 2 * M_PI / 3);
+            lambda[1] = 3 * q - lambda[0] - lambda[2];
+        }
+        // the eigenvector is orthogonal to the rows of (A - lambda.I): best cross product of two rows
+        const CCVector3d r0(a00 - lambda[2], a01, a02);
+        const CCVector3d r1(a01, a11 - lambda[2], a12);
+        const CCVector3d r2(a02, a12, a22 - lambda[2]);
+        const CCVector3d candidates[3] = { r0.cross(r1), r0.cross(r2), r1.cross(r2) };
+        smallest = CCVector3d(0, 0, 1);
+        double best = 0;
+        for (const CCVector3d& c : candidates)
+        {
+            if (c.norm2() > best)
+            {
+                best = c.norm2();
+                smallest = c;
+            }
+        }
+        smallest.normalize();
+    }
+
+    //! PCA of the points of the cell: eigenvalues and shape features (Weinmann et al.)
+    class PcaKernel : public NamedOutputsKernel
+    {
+    public:
+        PcaKernel() : NamedOutputsKernel({ "eigenvalue1", "eigenvalue2", "eigenvalue3", "sum", "omnivariance", "eigenentropy",
+                                           "anisotropy", "planarity", "linearity", "surfaceVariation", "sphericity", "verticality" },
+                                         { "linearity", "planarity", "sphericity" }) {}
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            double values[12];
+            std::fill(values, values + 12, static_cast<double>(CCCoreLib::NAN_VALUE));
+            if (cell.size() >= 3)
+            {
+                CCVector3d centroid, normal;
+                double cov[6], l[3];
+                cellCovariance(cell, centroid, cov);
+                symmetricEigen(cov, l, normal);
+                for (int k = 0; k < 3; k++)
+                    l[k] = std::max(l[k], 0.0);
+                const double sum = l[0] + l[1] + l[2];
+                values[0] = l[0]; values[1] = l[1]; values[2] = l[2];
+                values[3] = sum;
+                values[4] = std::cbrt(l[0] * l[1] * l[2]);
+                if (sum > 0)
+                {
+                    double entropy = 0;
+                    for (int k = 0; k < 3; k++)
+                        entropy -= (l[k] > 0) ? (l[k] / sum) * std::log(l[k] / sum) : 0;
+                    values[5] = entropy;
+                    values[6] = (l[0] - l[2]) / l[0];
+                    values[7] = (l[1] - l[2]) / l[0];
+                    values[8] = (l[0] - l[1]) / l[0];
+                    values[9] = l[2] / sum;
+                    values[10] = l[2] / l[0];
+                    values[11] = 1 - std::abs(normal.z);
+                }
+            }
+            for (size_t k = 0; k < m_selected.size(); k++)
+                fill(cell, outputs[k], values[m_selected[k]]);
+            return true;
+        }
+    };
+
+    //! least squares plane of the points of the cell, and the signed distance of each point to the plane
+    class PlaneKernel : public NamedOutputsKernel
+    {
+    public:
+        PlaneKernel() : NamedOutputsKernel({ "distance", "rms", "nx", "ny", "nz", "dip" }, { "distance", "rms" }) {}
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            const double nan = static_cast<double>(CCCoreLib::NAN_VALUE);
+            CCVector3d centroid, normal(nan, nan, nan);
+            double rms = nan;
+            if (cell.size() >= 3)
+            {
+                double cov[6], l[3];
+                cellCovariance(cell, centroid, cov);
+                symmetricEigen(cov, l, normal);
+                if (normal.z < 0)
+                    normal = -normal;
+                rms = std::sqrt(std::max(l[2], 0.0)); // variance along the normal
+            }
+            const double cellValues[6] = { nan, rms, normal.x, normal.y, normal.z,
+                                           (cell.size() >= 3) ? std::acos(std::min(normal.z, 1.0)) * 180 / M_PI : nan };
+            for (size_t k = 0; k < m_selected.size(); k++)
+            {
+                if (m_selected[k] != 0)
+                {
+                    fill(cell, outputs[k], cellValues[m_selected[k]]);
+                    continue;
+                }
+                for (unsigned i = 0; i < cell.size(); i++)
+                {
+                    double d = (cell.size() >= 3) ? (cell.getPoint(i)->toDouble() - centroid).dot(normal) : nan;
+                    outputs[k][cell.getPointGlobalIndex(i)] = static_cast<ScalarType>(d);
+                }
+            }
+            return true;
+        }
+    };
+
+    //! altitude statistics of the cell, and the height of each point above the lowest point of the cell
+    class HeightKernel : public NamedOutputsKernel
+    {
+    public:
+        HeightKernel() : NamedOutputsKernel({ "zmin", "zmax", "zmean", "zrange", "height" }, { "height", "zrange" }) {}
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            double zmin = cell.getPoint(0)->z;
+            double zmax = zmin;
+            double zsum = 0;
+            for (unsigned i = 0; i < cell.size(); i++)
+            {
+                double z = cell.getPoint(i)->z;
+                zmin = std::min(zmin, z);
+                zmax = std::max(zmax, z);
+                zsum += z;
+            }
+            const double cellValues[4] = { zmin, zmax, zsum / cell.size(), zmax - zmin };
+            for (size_t k = 0; k < m_selected.size(); k++)
+            {
+                if (m_selected[k] < 4)
+                {
+                    fill(cell, outputs[k], cellValues[m_selected[k]]);
+                    continue;
+                }
+                for (unsigned i = 0; i < cell.size(); i++)
+                    outputs[k][cell.getPointGlobalIndex(i)] = static_cast<ScalarType>(cell.getPoint(i)->z - zmin);
+            }
+            return true;
+        }
+    };
+
+    //! number of points in the cell
+    class CountKernel : public NamedOutputsKernel
+    {
+    public:
+        CountKernel() : NamedOutputsKernel({ "count" }, { "count" }) {}
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            for (size_t k = 0; k < m_selected.size(); k++)
+                fill(cell, outputs[k], cell.size());
+            return true;
+        }
+    };
+
+    //! linear interpolation of a percentile in sorted values (as numpy.percentile)
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        double pos = p / 100 * (sorted.size() - 1);
+        size_t below = static_cast<size_t>(std::floor(pos));
+        size_t above = std::min(below + 1, sorted.size() - 1);
+        return sorted[below] + (pos - below) * (sorted[above] - sorted[below]);
+    }
+
+    //! altitude percentiles of the cell, outputs named "pXX" for the percentile XX (from 0 to 100)
+    class ZPercentileKernel : public pyCC_CellKernel
+    {
+    public:
+        bool setOutputs(std::vector<std::string>& outputs, ccPointCloud& cloud, std::string& error) override
+        {
+            if (outputs.empty())
+                outputs.push_back("p50");
+            m_percentiles.clear();
+            for (const std::string& output : outputs)
+            {
+                // C locale: "p2.5" whatever the decimal separator of the application locale
+                double p = -1;
+                bool ok = false;
+                if (output.size() > 1 && output[0] == 'p')
+                {
+                    std::istringstream stream(output.substr(1));
+                    stream.imbue(std::locale::classic());
+                    stream >> p;
+                    ok = !stream.fail() && stream.eof();
+                }
+                if (!ok || p < 0 || p > 100)
+                {
+                    error = "unknown output '" + output + "', use pXX for the percentile XX, from 0 to 100 (p50: median)";
+                    return false;
+                }
+                m_percentiles.push_back(p);
+            }
+            return true;
+        }
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            std::vector<double> z(cell.size());
+            for (unsigned i = 0; i < cell.size(); i++)
+                z[i] = cell.getPoint(i)->z;
+            std::sort(z.begin(), z.end());
+            for (size_t k = 0; k < m_percentiles.size(); k++)
+            {
+                ScalarType value = static_cast<ScalarType>(percentile(z, m_percentiles[k]));
+                for (unsigned i = 0; i < cell.size(); i++)
+                    outputs[k][cell.getPointGlobalIndex(i)] = value;
+            }
+            return true;
+        }
+
+    private:
+        std::vector<double> m_percentiles;
+    };
+
+    //! statistics of scalar fields in the cell, outputs named "field_stat", NaN values ignored
+    class ScalarFieldKernel : public pyCC_CellKernel
+    {
+    public:
+        bool setOutputs(std::vector<std::string>& outputs, ccPointCloud& cloud, std::string& error) override
+        {
+            static const std::vector<std::string> statNames = { "mean", "min", "max", "sum", "std", "median" };
+            if (outputs.empty())
+            {
+                for (unsigned k = 0; k < cloud.getNumberOfScalarFields(); k++)
+                    outputs.push_back(std::string(cloud.getScalarFieldName(static_cast<int>(k))) + "_mean");
+                if (outputs.empty())
+                {
+                    error = "the cloud has no scalar field";
+                    return false;
+                }
+            }
+            m_fields.clear();
+            m_stats.clear();
+            for (const std::string& output : outputs)
+            {
+                size_t sep = output.rfind('_');
+                std::string name = (sep == std::string::npos) ? output : output.substr(0, sep);
+                std::string stat = (sep == std::string::npos) ? std::string() : output.substr(sep + 1);
+                auto it = std::find(statNames.begin(), statNames.end(), stat);
+                int sfIdx = cloud.getScalarFieldIndexByName(name.c_str());
+                if (it == statNames.end() || sfIdx < 0)
+                {
+                    error = "unknown output '" + output + "', use field_stat with an existing scalar field "
+                            "and stat in mean, min, max, sum, std, median";
+                    return false;
+                }
+                m_fields.push_back(cloud.getScalarField(sfIdx));
+                m_stats.push_back(static_cast<int>(it - statNames.begin()));
+            }
+            return true;
+        }
+
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const override
+        {
+            std::vector<double> values;
+            values.reserve(cell.size());
+            for (size_t k = 0; k < m_fields.size(); k++)
+            {
+                values.clear();
+                for (unsigned i = 0; i < cell.size(); i++)
+                {
+                    ScalarType v = m_fields[k]->getValue(cell.getPointGlobalIndex(i));
+                    if (!std::isnan(v))
+                        values.push_back(v);
+                }
+                double result = static_cast<double>(CCCoreLib::NAN_VALUE);
+                if (!values.empty())
+                {
+                    double sum = 0, sum2 = 0;
+                    for (double v : values)
+                    {
+                        sum += v;
+                        sum2 += v * v;
+                    }
+                    double mean = sum / values.size();
+                    switch (m_stats[k])
+                    {
+                    case 0: result = mean; break;
+                    case 1: result = *std::min_element(values.begin(), values.end()); break;
+                    case 2: result = *std::max_element(values.begin(), values.end()); break;
+                    case 3: result = sum; break;
+                    case 4: result = std::sqrt(std::max(sum2 / values.size() - mean * mean, 0.0)); break;
+                    default:
+                        std::sort(values.begin(), values.end());
+                        result = percentile(values, 50);
+                    }
+                }
+                for (unsigned i = 0; i < cell.size(); i++)
+                    outputs[k][cell.getPointGlobalIndex(i)] = static_cast<ScalarType>(result);
+            }
+            return true;
+        }
+
+    private:
+        std::vector<const CCCoreLib::ScalarField*> m_fields;
+        std::vector<int> m_stats;
+    };
+
+    struct CellKernelEntry
+    {
+        std::string description;
+        pyCC_CellKernelFactory factory;
+    };
+
+    template<typename Kernel> std::unique_ptr<pyCC_CellKernel> makeKernel()
+    {
+        return std::unique_ptr<pyCC_CellKernel>(new Kernel);
+    }
+
+    std::mutex registryMutex;
+
+    //! the registry, with the built-in kernels (call with the mutex locked)
+    std::map<std::string, CellKernelEntry>& registry()
+    {
+        static std::map<std::string, CellKernelEntry> kernels = {
+            { "count", { "number of points of the cell (output: count)", &makeKernel<CountKernel> } },
+            { "height", { "altitude statistics of the cell (outputs: zmin, zmax, zmean, zrange), "
+                          "height of the points above the lowest point of the cell (output: height)", &makeKernel<HeightKernel> } },
+            { "pca", { "eigenvalues and shape features of the cell points (outputs: eigenvalue1, eigenvalue2, eigenvalue3, sum, "
+                       "omnivariance, eigenentropy, anisotropy, planarity, linearity, surfaceVariation, sphericity, verticality)",
+                       &makeKernel<PcaKernel> } },
+            { "plane", { "least squares plane of the cell (outputs: rms, nx, ny, nz, dip in degrees), "
+                         "signed distance of the points to the plane (output: distance)", &makeKernel<PlaneKernel> } },
+            { "sf", { "statistics of scalar fields in the cell, NaN ignored (outputs: field_stat, stat in mean, min, max, sum, std, median)",
+                      &makeKernel<ScalarFieldKernel> } },
+            { "zpercentile", { "altitude percentiles of the cell (outputs: pXX, XX from 0 to 100)", &makeKernel<ZPercentileKernel> } },
+        };
+        return kernels;
+    }
+
+    bool runKernelOnCell(const CCCoreLib::DgmOctree::octreeCell& cell,
+                         void** additionalParameters,
+                         CCCoreLib::NormalizedProgress* nProgress)
+    {
+        const pyCC_CellKernel* kernel = static_cast<const pyCC_CellKernel*>(additionalParameters[0]);
+        ScalarType* const* outputs = static_cast<ScalarType* const*>(additionalParameters[1]);
+        return kernel->compute(*cell.points, outputs);
+    }
+}
+
+bool pyCC_RegisterCellKernel(const std::string& name, const std::string& description, pyCC_CellKernelFactory factory)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return registry().emplace(name, CellKernelEntry{ description, factory }).second;
+}
+
+std::map<std::string, std::string> pyCC_CellKernelDescriptions()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::map<std::string, std::string> descriptions;
+    for (const auto& kernel : registry())
+        descriptions[kernel.first] = kernel.second.description;
+    return descriptions;
+}
+
+std::unique_ptr<pyCC_CellKernel> pyCC_CreateCellKernel(const std::string& name)
+{
+    pyCC_CellKernelFactory factory;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = registry().find(name);
+        if (it == registry().end())
+            return nullptr;
+        factory = it->second.factory;
+    }
+    return factory();
+}
+
+bool pyCC_RunCellKernel(CCCoreLib::DgmOctree& octree,
+                        unsigned char level,
+                        const pyCC_CellKernel& kernel,
+                        const std::vector<ScalarType*>& outputs,
+                        int maxThreadCount)
+{
+    // executeFunctionForAllCellsAtLevel keeps its multithreaded state in static variables of CCCoreLib:
+    // one run at a time, the GIL being released by the callers
+    static std::mutex runMutex;
+    std::lock_guard<std::mutex> lock(runMutex);
+    void* additionalParameters[2] = { const_cast<pyCC_CellKernel*>(&kernel), const_cast<ScalarType**>(outputs.data()) };
+    unsigned nbCells = octree.executeFunctionForAllCellsAtLevel(level,
+                                                                &runKernelOnCell,
+                                                                additionalParameters,
+                                                                maxThreadCount != 1,
+                                                                nullptr,
+                                                                nullptr,
+                                                                maxThreadCount);
+    return nbCells != 0;
+}
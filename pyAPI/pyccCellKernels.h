@@ -0,0 +1,83 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCCELLKERNELS_H_
+#define CLOUDCOMPY_PYAPI_PYCCCELLKERNELS_H_
+
+#include <CCTypes.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ccPointCloud;
+
+namespace CCCoreLib
+{
+    class DgmOctree;
+    class GenericProgressCallback;
+    class ReferenceCloud;
+}
+
+//! a computation on the points of an octree cell, writing one value per point and per output
+/*! A kernel instance is created for each run: setOutputs is called once, then compute is called
+ *  concurrently on the cells (see DgmOctree::executeFunctionForAllCellsAtLevel) and must be thread safe.
+ */
+class pyCC_CellKernel
+{
+public:
+    virtual ~pyCC_CellKernel() = default;
+
+    //! check the requested outputs and prepare the run on the cloud of the octree
+    /*! An empty list is replaced by the default outputs of the kernel.
+     *  \return false, with a message in error, if an output is not supported
+     */
+    virtual bool setOutputs(std::vector<std::string>& outputs, ccPointCloud& cloud, std::string& error) = 0;
+
+    //! compute the outputs for the points of a cell: outputs[k][cloud index of the point] for the output k
+    virtual bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const* outputs) const = 0;
+};
+
+typedef std::function<std::unique_ptr<pyCC_CellKernel>()> pyCC_CellKernelFactory;
+
+//! register a kernel under a name, the built-in kernels are always registered
+/*! \return false if the name is already used
+ */
+bool pyCC_RegisterCellKernel(const std::string& name, const std::string& description, pyCC_CellKernelFactory factory);
+
+//! the registered kernels: name, description
+std::map<std::string, std::string> pyCC_CellKernelDescriptions();
+
+//! a new instance of a registered kernel, null if the name is unknown
+std::unique_ptr<pyCC_CellKernel> pyCC_CreateCellKernel(const std::string& name);
+
+//! run the kernel on all the cells of the octree at a level, multithreaded
+/*! outputs: one array per output of the kernel, of the size of the cloud.
+ *  The runs are serialized: DgmOctree::executeFunctionForAllCellsAtLevel is not reentrant (static state),
+ *  a run started from another thread waits for the current one.
+ *  \return false if the computation failed or was cancelled
+ */
+bool pyCC_RunCellKernel(CCCoreLib::DgmOctree& octree,
+                        unsigned char level,
+                        const pyCC_CellKernel& kernel,
+                        const std::vector<ScalarType*>& outputs,
+                        int maxThreadCount = 0);
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCCELLKERNELS_H_ */
@@ -0,0 +1,378 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "pyccExpression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    struct FunctionDef
+    {
+        const char* name;
+        int arity;
+        int op;
+    };
+}
+
+pyCC_Expression::pyCC_Expression(const std::string& text)
+    : m_text(text)
+    , m_pos(0)
+    , m_depth(0)
+    , m_maxDepth(0)
+{
+    parseOr();
+    skipSpaces();
+    if (m_pos != m_text.size())
+        syntaxError("unexpected character");
+    if (m_program.empty())
+        syntaxError("empty expression");
+}
+
+void pyCC_Expression::syntaxError(const std::string& message) const
+{
+    throw std::invalid_argument("expression syntax error at position " + std::to_string(m_pos) + ": " + message
+                                + " in '" + m_text + "'");
+}
+
+void pyCC_Expression::emit(OpCode op, int arity, int var, double value)
+{
+    m_program.push_back({ op, var, value });
+    m_depth += 1 - arity;
+    m_maxDepth = std::max(m_maxDepth, m_depth);
+}
+
+void pyCC_Expression::skipSpaces()
+{
+    while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+        m_pos++;
+}
+
+bool pyCC_Expression::accept(const char* token)
+{
+    skipSpaces();
+    size_t len = strlen(token);
+    if (m_text.compare(m_pos, len, token) != 0)
+        return false;
+    // do not take '<' for '<=', or '=' alone
+    if (len == 1 && (token[0] == '<' || token[0] == '>') && m_pos + 1 < m_text.size() && m_text[m_pos + 1] == '=')
+        return false;
+    m_pos += len;
+    return true;
+}
+
+void pyCC_Expression::expect(const char* token)
+{
+    if (!accept(token))
+        syntaxError(std::string("'") + token + "' expected");
+}
+
+void pyCC_Expression::parseOr()
+{
+    parseAnd();
+    while (accept("||"))
+    {
+        parseAnd();
+        emit(OP_OR, 2);
+    }
+}
+
+void pyCC_Expression::parseAnd()
+{
+    parseComparison();
+    while (accept("&&"))
+    {
+        parseComparison();
+        emit(OP_AND, 2);
+    }
+}
+
+void pyCC_Expression::parseComparison()
+{
+    parseSum();
+    static const struct { const char* token; OpCode op; } comparisons[] =
+    {
+        { "<=", OP_LE }, { ">=", OP_GE }, { "==", OP_EQ }, { "!=", OP_NE }, { "<", OP_LT }, { ">", OP_GT }
+    };
+    for (const auto& c : comparisons)
+    {
+        if (accept(c.token))
+        {
+            parseSum();
+            emit(c.op, 2);
+            return;
+        }
+    }
+}
+
+void pyCC_Expression::parseSum()
+{
+    parseProduct();
+    while (true)
+    {
+        if (accept("+"))
+        {
+            parseProduct();
+            emit(OP_ADD, 2);
+        }
+        else if (accept("-"))
+        {
+            parseProduct();
+            emit(OP_SUB, 2);
+        }
+        else
+            break;
+    }
+}
+
+void pyCC_Expression::parseProduct()
+{
+    parseUnary();
+    while (true)
+    {
+        if (accept("*"))
+        {
+            parseUnary();
+            emit(OP_MUL, 2);
+        }
+        else if (accept("/"))
+        {
+            parseUnary();
+            emit(OP_DIV, 2);
+        }
+        else
+            break;
+    }
+}
+
+void pyCC_Expression::parseUnary()
+{
+    if (accept("-"))
+    {
+        parseUnary();
+        emit(OP_NEG, 1);
+    }
+    else if (accept("+"))
+        parseUnary();
+    else if (accept("!"))
+    {
+        parseUnary();
+        emit(OP_NOT, 1);
+    }
+    else
+        parsePower();
+}
+
+void pyCC_Expression::parsePower()
+{
+    parsePrimary();
+    if (accept("^"))
+    {
+        parseUnary(); // right associative, -2^2 = -4 and 2^-1 = 0.5
+        emit(OP_POW, 2);
+    }
+}
+
+void pyCC_Expression::parsePrimary()
+{
+    static const FunctionDef functions[] =
+    {
+        { "abs", 1, OP_ABS }, { "sqrt", 1, OP_SQRT }, { "exp", 1, OP_EXP }, { "log", 1, OP_LOG },
+        { "log10", 1, OP_LOG10 }, { "sin", 1, OP_SIN }, { "cos", 1, OP_COS }, { "tan", 1, OP_TAN },
+        { "asin", 1, OP_ASIN }, { "acos", 1, OP_ACOS }, { "atan", 1, OP_ATAN }, { "floor", 1, OP_FLOOR },
+        { "ceil", 1, OP_CEIL }, { "isnan", 1, OP_ISNAN },
+        { "atan2", 2, OP_ATAN2 }, { "pow", 2, OP_POW }, { "min", 2, OP_MIN }, { "max", 2, OP_MAX },
+        { "clip", 3, OP_CLIP }, { "if", 3, OP_IF }
+    };
+
+    skipSpaces();
+    if (m_pos >= m_text.size())
+        syntaxError("unexpected end of expression");
+    char c = m_text[m_pos];
+
+    if (accept("("))
+    {
+        parseOr();
+        expect(")");
+        return;
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+    {
+        // C locale: the application may have set a locale with a comma as decimal separator
+        std::istringstream stream(m_text.substr(m_pos));
+        stream.imbue(std::locale::classic());
+        double value = 0;
+        stream >> value;
+        if (stream.fail())
+            syntaxError("bad number");
+        m_pos = stream.eof() ? m_text.size() : m_pos + static_cast<size_t>(stream.tellg());
+        emit(OP_CONST, 0, -1, value);
+        return;
+    }
+
+    std::string name;
+    bool bracketed = false;
+    if (c == '[')
+    {
+        size_t close = m_text.find(']', m_pos + 1);
+        if (close == std::string::npos)
+            syntaxError("']' expected");
+        name = m_text.substr(m_pos + 1, close - m_pos - 1);
+        m_pos = close + 1;
+        bracketed = true;
+    }
+    else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+    {
+        size_t start = m_pos;
+        while (m_pos < m_text.size() && (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_'))
+            m_pos++;
+        name = m_text.substr(start, m_pos - start);
+    }
+    else
+        syntaxError("unexpected character");
+
+    if (!bracketed && accept("("))
+    {
+        for (const FunctionDef& f : functions)
+        {
+            if (name != f.name)
+                continue;
+            for (int i = 0; i < f.arity; i++)
+            {
+                if (i > 0)
+                    expect(",");
+                parseOr();
+            }
+            expect(")");
+            emit(static_cast<OpCode>(f.op), f.arity);
+            return;
+        }
+        syntaxError("unknown function " + name);
+    }
+    if (!bracketed && name == "pi")
+    {
+        emit(OP_CONST, 0, -1, 3.14159265358979323846);
+        return;
+    }
+    auto it = std::find(m_variables.begin(), m_variables.end(), name);
+    int var = static_cast<int>(it - m_variables.begin());
+    if (it == m_variables.end())
+        m_variables.push_back(name);
+    emit(OP_VAR, 0, var);
+}
+
+namespace
+{
+    template<typename F> inline void unaryOp(double* a, size_t count, F f)
+    {
+        for (size_t i = 0; i < count; i++)
+            a[i] = f(a[i]);
+    }
+
+    template<typename F> inline void binaryOp(double* a, const double* b, size_t count, F f)
+    {
+        for (size_t i = 0; i < count; i++)
+            a[i] = f(a[i], b[i]);
+    }
+}
+
+void pyCC_Expression::evaluateBlock(size_t begin, size_t count, const std::vector<Loader>& loaders, double* work, double* result) const
+{
+    double* vars = work;
+    double* stack = work + m_variables.size() * BLOCK;
+    for (size_t v = 0; v < m_variables.size(); v++)
+        loaders[v](begin, count, vars + v * BLOCK);
+
+    size_t sp = 0;
+    for (const Instruction& ins : m_program)
+    {
+        double* b = sp ? stack + (sp - 1) * BLOCK : stack; // top of the stack
+        double* a = b;
+        if (ins.op >= OP_ADD && ins.op <= OP_OR)
+            a -= BLOCK;
+        else if (ins.op >= OP_ATAN2 && ins.op <= OP_MAX)
+            a -= BLOCK;
+        switch (ins.op)
+        {
+        case OP_CONST:
+            std::fill(stack + sp * BLOCK, stack + sp * BLOCK + count, ins.value);
+            sp++;
+            break;
+        case OP_VAR:
+            std::copy(vars + ins.var * BLOCK, vars + ins.var * BLOCK + count, stack + sp * BLOCK);
+            sp++;
+            break;
+        case OP_NEG:   unaryOp(a, count, [](double x) { return -x; }); break;
+        case OP_NOT:   unaryOp(a, count, [](double x) { return x == 0. ? 1. : 0.; }); break;
+        case OP_ABS:   unaryOp(a, count, [](double x) { return std::abs(x); }); break;
+        case OP_SQRT:  unaryOp(a, count, [](double x) { return std::sqrt(x); }); break;
+        case OP_EXP:   unaryOp(a, count, [](double x) { return std::exp(x); }); break;
+        case OP_LOG:   unaryOp(a, count, [](double x) { return std::log(x); }); break;
+        case OP_LOG10: unaryOp(a, count, [](double x) { return std::log10(x); }); break;
+        case OP_SIN:   unaryOp(a, count, [](double x) { return std::sin(x); }); break;
+        case OP_COS:   unaryOp(a, count, [](double x) { return std::cos(x); }); break;
+        case OP_TAN:   unaryOp(a, count, [](double x) { return std::tan(x); }); break;
+        case OP_ASIN:  unaryOp(a, count, [](double x) { return std::asin(x); }); break;
+        case OP_ACOS:  unaryOp(a, count, [](double x) { return std::acos(x); }); break;
+        case OP_ATAN:  unaryOp(a, count, [](double x) { return std::atan(x); }); break;
+        case OP_FLOOR: unaryOp(a, count, [](double x) { return std::floor(x); }); break;
+        case OP_CEIL:  unaryOp(a, count, [](double x) { return std::ceil(x); }); break;
+        case OP_ISNAN: unaryOp(a, count, [](double x) { return std::isnan(x) ? 1. : 0.; }); break;
+        case OP_ADD:   binaryOp(a, b, count, [](double x, double y) { return x + y; }); break;
+        case OP_SUB:   binaryOp(a, b, count, [](double x, double y) { return x - y; }); break;
+        case OP_MUL:   binaryOp(a, b, count, [](double x, double y) { return x * y; }); break;
+        case OP_DIV:   binaryOp(a, b, count, [](double x, double y) { return x / y; }); break;
+        case OP_POW:   binaryOp(a, b, count, [](double x, double y) { return std::pow(x, y); }); break;
+        case OP_LT:    binaryOp(a, b, count, [](double x, double y) { return x < y ? 1. : 0.; }); break;
+        case OP_LE:    binaryOp(a, b, count, [](double x, double y) { return x <= y ? 1. : 0.; }); break;
+        case OP_GT:    binaryOp(a, b, count, [](double x, double y) { return x > y ? 1. : 0.; }); break;
+        case OP_GE:    binaryOp(a, b, count, [](double x, double y) { return x >= y ? 1. : 0.; }); break;
+        case OP_EQ:    binaryOp(a, b, count, [](double x, double y) { return x == y ? 1. : 0.; }); break;
+        case OP_NE:    binaryOp(a, b, count, [](double x, double y) { return x != y ? 1. : 0.; }); break;
+        case OP_AND:   binaryOp(a, b, count, [](double x, double y) { return (x != 0. && y != 0.) ? 1. : 0.; }); break;
+        case OP_OR:    binaryOp(a, b, count, [](double x, double y) { return (x != 0. || y != 0.) ? 1. : 0.; }); break;
+        case OP_ATAN2: binaryOp(a, b, count, [](double x, double y) { return std::atan2(x, y); }); break;
+        case OP_MIN:   binaryOp(a, b, count, [](double x, double y) { return std::min(x, y); }); break;
+        case OP_MAX:   binaryOp(a, b, count, [](double x, double y) { return std::max(x, y); }); break;
+        case OP_CLIP:
+        case OP_IF:
+        {
+            double* x = stack + (sp - 3) * BLOCK;
+            const double* y = x + BLOCK;
+            const double* z = y + BLOCK;
+            if (ins.op == OP_CLIP)
+                for (size_t i = 0; i < count; i++)
+                    x[i] = std::min(std::max(x[i], y[i]), z[i]);
+            else
+                for (size_t i = 0; i < count; i++)
+                    x[i] = (x[i] != 0.) ? y[i] : z[i];
+            sp -= 2;
+            break;
+        }
+        }
+        if ((ins.op >= OP_ADD && ins.op <= OP_OR) || (ins.op >= OP_ATAN2 && ins.op <= OP_MAX))
+            sp--;
+    }
+    std::copy(stack, stack + count, result);
+}
@@ -0,0 +1,113 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCEXPRESSION_H_
+#define CLOUDCOMPY_PYAPI_PYCCEXPRESSION_H_
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+//! arithmetic expression on per point variables, parsed once, evaluated by blocks of points
+/*! Grammar (usual precedence, ^ is right associative):
+ *  numbers, variables (identifiers or [any name]), + - * / ^, unary - and !,
+ *  comparisons < <= > >= == != (1 or 0), && ||,
+ *  functions: abs sqrt exp log log10 sin cos tan asin acos atan floor ceil isnan (1 argument),
+ *  atan2 pow min max (2 arguments), clip(x, lo, hi) and if(cond, a, b), constant pi.
+ *  The expression is compiled to a stack program: each instruction runs on a block of values,
+ *  so the evaluation of a chunk of points needs no temporary of the cloud size.
+ */
+class pyCC_Expression
+{
+public:
+    //! number of points processed by each instruction
+    static const size_t BLOCK = 256;
+
+    //! fill out[0..count[ with the values of a variable for the points [begin, begin+count[
+    typedef std::function<void(size_t begin, size_t count, double* out)> Loader;
+
+    //! parse and compile the expression, throw std::invalid_argument on syntax error
+    explicit pyCC_Expression(const std::string& text);
+
+    //! names of the variables used in the expression, loaders must be given in this order
+    const std::vector<std::string>& variableNames() const { return m_variables; }
+
+    //! evaluate the expression on the points [begin, end[, result in out[begin..end[
+    /*! thread safe: evaluate disjoint ranges in parallel.
+     */
+    template<typename T> void evaluate(size_t begin, size_t end, const std::vector<Loader>& loaders, T* out) const
+    {
+        std::vector<double> work(workSize());
+        double result[BLOCK];
+        for (size_t b = begin; b < end; b += BLOCK)
+        {
+            size_t count = std::min(BLOCK, end - b);
+            evaluateBlock(b, count, loaders, work.data(), result);
+            for (size_t i = 0; i < count; i++)
+                out[b + i] = static_cast<T>(result[i]);
+        }
+    }
+
+protected:
+    enum OpCode
+    {
+        OP_CONST, OP_VAR,
+        OP_NEG, OP_NOT,
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+        OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE, OP_AND, OP_OR,
+        OP_ABS, OP_SQRT, OP_EXP, OP_LOG, OP_LOG10, OP_SIN, OP_COS, OP_TAN,
+        OP_ASIN, OP_ACOS, OP_ATAN, OP_FLOOR, OP_CEIL, OP_ISNAN,
+        OP_ATAN2, OP_MIN, OP_MAX,
+        OP_CLIP, OP_IF
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int var;
+        double value;
+    };
+
+    size_t workSize() const { return (m_variables.size() + m_maxDepth) * BLOCK; }
+    void evaluateBlock(size_t begin, size_t count, const std::vector<Loader>& loaders, double* work, double* result) const;
+
+    // --- recursive descent parser
+    void parseOr();
+    void parseAnd();
+    void parseComparison();
+    void parseSum();
+    void parseProduct();
+    void parseUnary();
+    void parsePower();
+    void parsePrimary();
+    void skipSpaces();
+    bool accept(const char* token);
+    void expect(const char* token);
+    [[noreturn]] void syntaxError(const std::string& message) const;
+    void emit(OpCode op, int arity, int var = -1, double value = 0);
+
+    std::string m_text;
+    size_t m_pos;
+    int m_depth;
+    int m_maxDepth;
+    std::vector<Instruction> m_program;
+    std::vector<std::string> m_variables;
+};
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCEXPRESSION_H_ */
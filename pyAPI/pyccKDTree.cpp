@@ -0,0 +1,252 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "pyccKDTree.h"
+#include "pyccParallel.h"
+
+#include <GenericIndexedCloudPersist.h>
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+namespace
+{
+    //! keeps the k nearest points in a max heap
+    struct KnnVisitor
+    {
+        unsigned k;
+        double maxSquareDist;
+        double shrink;      //!< 1 / (1 + epsilon)^2, 1 for an exact search
+        std::vector<pyCC_KDTree::Neighbour>& heap;
+
+        //! the boxes farther than this square distance are not visited
+        double worst() const
+        {
+            return (heap.size() < k) ? maxSquareDist : heap.front().first * shrink;
+        }
+
+        void add(double squareDist, unsigned index)
+        {
+            if (squareDist > maxSquareDist)
+                return;
+            if (heap.size() < k)
+            {
+                heap.emplace_back(squareDist, index);
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if (squareDist < heap.front().first)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = pyCC_KDTree::Neighbour(squareDist, index);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+    };
+
+    //! keeps all the points within a radius
+    struct RadiusVisitor
+    {
+        double squareRadius;
+        std::vector<pyCC_KDTree::Neighbour>& found;
+
+        double worst() const { return squareRadius; }
+
+        void add(double squareDist, unsigned index)
+        {
+            if (squareDist <= squareRadius)
+                found.emplace_back(squareDist, index);
+        }
+    };
+}
+
+pyCC_KDTree::pyCC_KDTree(unsigned leafSize)
+    : m_leafSize(std::max(leafSize, 1u))
+{
+}
+
+bool pyCC_KDTree::build(CCCoreLib::GenericIndexedCloudPersist* cloud, int maxThreadCount)
+{
+    m_points.clear();
+    m_indexes.clear();
+    m_nodes.clear();
+    unsigned n = cloud ? cloud->size() : 0;
+    if (n == 0)
+        return false;
+    std::vector<CCVector3> sorted;
+    try
+    {
+        m_points.resize(n);
+        m_indexes.resize(n);
+        sorted.resize(n);
+        m_nodes.reserve(2 * (n / m_leafSize) + 1);
+    }
+    catch (const std::bad_alloc&)
+    {
+        m_points.clear();
+        m_indexes.clear();
+        return false;
+    }
+    pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            m_points[i] = *cloud->getPoint(static_cast<unsigned>(i));
+            m_indexes[i] = static_cast<unsigned>(i);
+        }
+    }, maxThreadCount);
+
+    // top of the tree built sequentially, down to a few subtrees per thread, then the subtrees in parallel
+    size_t nbSubtrees = pyCC_SplitRange(n, maxThreadCount).size();
+    unsigned stopSize = std::max(m_leafSize, static_cast<unsigned>(n / nbSubtrees));
+    buildNode(m_nodes, 0, n, stopSize);
+    std::vector<unsigned> pending;
+    for (unsigned i = 0; i < m_nodes.size(); i++)
+    {
+        if (m_nodes[i].left == 0 && m_nodes[i].end - m_nodes[i].begin > m_leafSize)
+            pending.push_back(i);
+    }
+    std::vector<std::vector<Node>> subtrees(pending.size());
+    std::vector<pyCC_Range> tasks;
+    for (size_t s = 0; s < pending.size(); s++)
+        tasks.push_back({ s, m_nodes[pending[s]].begin, m_nodes[pending[s]].end });
+    pyCC_ParallelForRanges(tasks, [&](const pyCC_Range& r)
+    {
+        buildNode(subtrees[r.chunk], static_cast<unsigned>(r.begin), static_cast<unsigned>(r.end), m_leafSize);
+    }, maxThreadCount);
+
+    // append the subtrees, their root replaces the pending node
+    for (size_t s = 0; s < subtrees.size(); s++)
+    {
+        unsigned base = static_cast<unsigned>(m_nodes.size());
+        for (Node node : subtrees[s])
+        {
+            if (node.left)
+            {
+                node.left += base;
+                node.right += base;
+            }
+            m_nodes.push_back(node);
+        }
+        m_nodes[pending[s]] = m_nodes[base];
+    }
+
+    pyCC_ParallelFor(n, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            sorted[i] = m_points[m_indexes[i]];
+    }, maxThreadCount);
+    m_points.swap(sorted);
+    return true;
+}
+
+unsigned pyCC_KDTree::buildNode(std::vector<Node>& nodes, unsigned begin, unsigned end, unsigned stopSize)
+{
+    unsigned nodeIndex = static_cast<unsigned>(nodes.size());
+    nodes.push_back({ 0, begin, end, 0, 0, 0 });
+    if (end - begin <= stopSize)
+        return nodeIndex;
+
+    CCVector3 bbMin = m_points[m_indexes[begin]];
+    CCVector3 bbMax = bbMin;
+    for (unsigned i = begin + 1; i < end; i++)
+    {
+        const CCVector3& P = m_points[m_indexes[i]];
+        for (int d = 0; d < 3; d++)
+        {
+            bbMin.u[d] = std::min(bbMin.u[d], P.u[d]);
+            bbMax.u[d] = std::max(bbMax.u[d], P.u[d]);
+        }
+    }
+    CCVector3 extent = bbMax - bbMin;
+    unsigned char axis = (extent.x >= extent.y) ? (extent.x >= extent.z ? 0 : 2) : (extent.y >= extent.z ? 1 : 2);
+    if (extent.u[axis] == 0)
+        return nodeIndex; // duplicate points: a larger leaf
+
+    unsigned mid = begin + (end - begin) / 2;
+    const std::vector<CCVector3>& points = m_points;
+    std::nth_element(m_indexes.begin() + begin, m_indexes.begin() + mid, m_indexes.begin() + end,
+                     [&points, axis](unsigned a, unsigned b) { return points[a].u[axis] < points[b].u[axis]; });
+    PointCoordinateType split = m_points[m_indexes[mid]].u[axis];
+    unsigned left = buildNode(nodes, begin, mid, stopSize);
+    unsigned right = buildNode(nodes, mid, end, stopSize);
+    Node& node = nodes[nodeIndex];
+    node.split = split;
+    node.axis = axis;
+    node.left = left;
+    node.right = right;
+    return nodeIndex;
+}
+
+template<typename Visitor> void pyCC_KDTree::search(unsigned nodeIndex, const CCVector3& query,
+                                                    double lowerBound, CCVector3d& offsets, Visitor& visitor) const
+{
+    const Node& node = m_nodes[nodeIndex];
+    if (node.left == 0)
+    {
+        for (unsigned i = node.begin; i < node.end; i++)
+            visitor.add((m_points[i] - query).norm2d(), m_indexes[i]);
+        return;
+    }
+    double diff = static_cast<double>(query.u[node.axis]) - node.split;
+    unsigned nearChild = (diff <= 0) ? node.left : node.right;
+    unsigned farChild = (diff <= 0) ? node.right : node.left;
+    search(nearChild, query, lowerBound, offsets, visitor);
+
+    // lower bound of the distance to the far child box: replace the offset on the split axis
+    double previous = offsets.u[node.axis];
+    double bound = lowerBound - previous * previous + diff * diff;
+    if (bound <= visitor.worst())
+    {
+        offsets.u[node.axis] = diff;
+        search(farChild, query, bound, offsets, visitor);
+        offsets.u[node.axis] = previous;
+    }
+}
+
+size_t pyCC_KDTree::memoryUsed() const
+{
+    return sizeof(*this)
+        + m_points.capacity() * sizeof(CCVector3)
+        + m_indexes.capacity() * sizeof(unsigned)
+        + m_nodes.capacity() * sizeof(Node);
+}
+
+void pyCC_KDTree::knn(const CCVector3& query, unsigned k, double maxSquareDist, std::vector<Neighbour>& result,
+                      double epsilon) const
+{
+    result.clear();
+    if (k == 0 || m_nodes.empty())
+        return;
+    double shrink = (epsilon > 0) ? 1. / ((1. + epsilon) * (1. + epsilon)) : 1.;
+    KnnVisitor visitor{ k, (maxSquareDist > 0) ? maxSquareDist : std::numeric_limits<double>::infinity(), shrink, result };
+    CCVector3d offsets(0, 0, 0);
+    search(0, query, 0., offsets, visitor);
+    std::sort_heap(result.begin(), result.end());
+}
+
+void pyCC_KDTree::radius(const CCVector3& query, double radius, std::vector<Neighbour>& result) const
+{
+    result.clear();
+    if (m_nodes.empty())
+        return;
+    RadiusVisitor visitor{ radius * radius, result };
+    CCVector3d offsets(0, 0, 0);
+    search(0, query, 0., offsets, visitor);
+    std::sort(result.begin(), result.end());
+}
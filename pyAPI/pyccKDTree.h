@@ -0,0 +1,98 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCKDTREE_H_
+#define CLOUDCOMPY_PYAPI_PYCCKDTREE_H_
+
+#include <CCGeom.h>
+
+#include <utility>
+#include <vector>
+
+namespace CCCoreLib
+{
+    class GenericIndexedCloudPersist;
+}
+
+//! KD-tree on a copy of the cloud coordinates, stored in flat arrays for kNN and radius queries
+/*! The points are copied in tree order: the points of a leaf are contiguous in memory.
+ *  Nodes split the widest side of their points bounding box at the median.
+ *  The search keeps the per axis offsets to the query (Arya & Mount), so the far child
+ *  is visited only if its box is closer than the current worst neighbour.
+ *  Queries are const and thread safe.
+ */
+class pyCC_KDTree
+{
+public:
+    //! a neighbour: (square distance, point index in the cloud)
+    typedef std::pair<double, unsigned> Neighbour;
+
+    explicit pyCC_KDTree(unsigned leafSize = 16);
+
+    //! build the tree on the cloud points, subtrees built in parallel
+    /*! \return false if the cloud is empty or if there is not enough memory
+     */
+    bool build(CCCoreLib::GenericIndexedCloudPersist* cloud, int maxThreadCount = 0);
+
+    //! number of points in the tree
+    size_t size() const { return m_points.size(); }
+
+    //! maximum number of points in a leaf
+    unsigned leafSize() const { return m_leafSize; }
+
+    //! number of nodes, leaves included
+    size_t nodeCount() const { return m_nodes.size(); }
+
+    //! memory used by the tree, in bytes
+    size_t memoryUsed() const;
+
+    //! the k nearest neighbours of a point, within maxSquareDist if > 0, sorted by increasing distance
+    /*! With epsilon > 0, the search is approximate: a box is skipped if it is not closer than the current
+     *  worst neighbour divided by (1 + epsilon), so the i-th neighbour found is at most (1 + epsilon) times
+     *  farther than the exact i-th neighbour. Much less leaves are visited on dense clouds.
+     */
+    void knn(const CCVector3& query, unsigned k, double maxSquareDist, std::vector<Neighbour>& result,
+             double epsilon = 0) const;
+
+    //! all the points within a radius of a point, sorted by increasing distance
+    void radius(const CCVector3& query, double radius, std::vector<Neighbour>& result) const;
+
+protected:
+    struct Node
+    {
+        PointCoordinateType split;
+        unsigned begin;        //!< first point of the node, in tree order
+        unsigned end;
+        unsigned left;         //!< children, 0 for a leaf (the root is never a child)
+        unsigned right;
+        unsigned char axis;
+    };
+
+    //! build the subtree on the points [begin, end[, nodes appended, returns the index of its root
+    unsigned buildNode(std::vector<Node>& nodes, unsigned begin, unsigned end, unsigned stopSize);
+
+    template<typename Visitor> void search(unsigned nodeIndex, const CCVector3& query,
+                                           double lowerBound, CCVector3d& offsets, Visitor& visitor) const;
+
+    unsigned m_leafSize;
+    std::vector<CCVector3> m_points;   //!< coordinates in tree order
+    std::vector<unsigned> m_indexes;   //!< cloud index of the points, in tree order
+    std::vector<Node> m_nodes;
+};
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCKDTREE_H_ */
@@ -0,0 +1,85 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCKERNELABI_H_
+#define CLOUDCOMPY_PYAPI_PYCCKERNELABI_H_
+
+/* C ABI of the point kernel plugins, loaded with cloudComPy.loadKernel(path).
+ *
+ * A plugin is a shared library written in C or C++ (extern "C"), compiled with this header only:
+ * it does not depend on CloudCompare, Qt or Python. It exports the functions below, by name.
+ * The kernel is called for each point of the cloud, with the neighbours of the point within the search radius,
+ * from several threads at once, on disjoint points: it must be thread safe and write only the outputs of its point.
+ *
+ * The ABI version changes with any incompatible change of this file.
+ */
+
+#define PYCC_KERNEL_ABI_VERSION 1
+
+#if defined(_WIN32)
+#define PYCC_KERNEL_EXPORT __declspec(dllexport)
+#else
+#define PYCC_KERNEL_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the neighbourhood of a point: the points of the cloud within the search radius, the point itself included, not sorted */
+typedef struct pycc_neighbours
+{
+    unsigned count;
+    const unsigned* indexes;        /* indexes of the neighbours in the cloud */
+    const double* squareDistances;  /* square distances of the neighbours to the point */
+} pycc_neighbours;
+
+/* "pycc_kernel_abi_version": must return PYCC_KERNEL_ABI_VERSION */
+typedef int (*pycc_kernel_abi_version_fn)(void);
+
+/* "pycc_kernel_name": unique name of the kernel */
+typedef const char* (*pycc_kernel_name_fn)(void);
+
+/* "pycc_kernel_description": optional, one line description */
+typedef const char* (*pycc_kernel_description_fn)(void);
+
+/* "pycc_kernel_input_count": number of input scalar fields, given by name at each run */
+typedef unsigned (*pycc_kernel_input_count_fn)(void);
+
+/* "pycc_kernel_output_count" and "pycc_kernel_output_name": the outputs, written in scalar fields of the same names */
+typedef unsigned (*pycc_kernel_output_count_fn)(void);
+typedef const char* (*pycc_kernel_output_name_fn)(unsigned output);
+
+/* "pycc_point_kernel": compute the outputs of the point of the given index
+ *   xyz:        coordinates of all the points of the cloud, x, y, z for each point
+ *   neighbours: the neighbourhood of the point
+ *   sfIn:       sfIn[k][i] is the value of the input scalar field k for the point i (NaN for invalid values)
+ *   sfOut:      sfOut[k][index] receives the output k of the point
+ * returns 0 on success, any other value stops the computation
+ */
+typedef int (*pycc_point_kernel_fn)(unsigned index,
+                                    const float* xyz,
+                                    const pycc_neighbours* neighbours,
+                                    const float* const* sfIn,
+                                    float* const* sfOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCKERNELABI_H_ */
@@ -0,0 +1,262 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#include "pyccKernelPlugins.h"
+#include "pyccCellKernels.h"
+#include "pyccParallel.h"
+
+#include <DgmOctree.h>
+#include <GenericIndexedCloudPersist.h>
+#include <ReferenceCloud.h>
+
+#include <QFileInfo>
+#include <QLibrary>
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <type_traits>
+
+static_assert(std::is_same<PointCoordinateType, float>::value && sizeof(CCVector3) == 3 * sizeof(float),
+              "the kernel ABI gives the coordinates as packed float triplets");
+
+namespace
+{
+    struct PluginEntry
+    {
+        pyCC_KernelPlugin plugin;
+        std::unique_ptr<QLibrary> library;
+    };
+
+    std::mutex pluginsMutex;
+
+    std::map<std::string, std::unique_ptr<PluginEntry>>& plugins()
+    {
+        static std::map<std::string, std::unique_ptr<PluginEntry>> loaded;
+        return loaded;
+    }
+
+    //! drives the plugin on the points of a cell, each point with its spherical neighbourhood
+    class PointKernelRunner : public pyCC_CellKernel
+    {
+    public:
+        PointKernelRunner(CCCoreLib::DgmOctree& octree, PointCoordinateType radius, unsigned char level,
+                          const pyCC_KernelPlugin& plugin, const float* xyz, const float* const* in, float* const* out)
+            : m_octree(octree), m_radius(radius), m_level(level), m_plugin(plugin), m_xyz(xyz), m_in(in), m_out(out) {}
+
+        bool setOutputs(std::vector<std::string>& outputs, ccPointCloud&, std::string&) override
+        {
+            outputs = m_plugin.outputs;
+            return true;
+        }
+
+        //! the outputs are written by the plugin, in the float arrays given at construction
+        bool compute(CCCoreLib::ReferenceCloud& cell, ScalarType* const*) const override
+        {
+            CCCoreLib::DgmOctree::NeighboursSet neighbours;
+            std::vector<unsigned> indexes;
+            std::vector<double> squareDistances;
+            for (unsigned i = 0; i < cell.size(); i++)
+            {
+                neighbours.clear();
+                m_octree.getPointsInSphericalNeighbourhood(*cell.getPoint(i), m_radius, neighbours, m_level);
+                indexes.resize(neighbours.size());
+                squareDistances.resize(neighbours.size());
+                for (size_t k = 0; k < neighbours.size(); k++)
+                {
+                    indexes[k] = neighbours[k].pointIndex;
+                    squareDistances[k] = neighbours[k].squareDistd;
+                }
+                pycc_neighbours nb = { static_cast<unsigned>(indexes.size()), indexes.data(), squareDistances.data() };
+                if (m_plugin.kernel(cell.getPointGlobalIndex(i), m_xyz, &nb, m_in, m_out) != 0)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        CCCoreLib::DgmOctree& m_octree;
+        PointCoordinateType m_radius;
+        unsigned char m_level;
+        const pyCC_KernelPlugin& m_plugin;
+        const float* m_xyz;
+        const float* const* m_in;
+        float* const* m_out;
+    };
+}
+
+const pyCC_KernelPlugin* pyCC_LoadKernelPlugin(const QString& path, std::string& error)
+{
+    std::unique_ptr<PluginEntry> entry(new PluginEntry);
+    entry->library.reset(new QLibrary(path));
+    if (!entry->library->load())
+    {
+        error = "cannot load " + path.toStdString() + ": " + entry->library->errorString().toStdString();
+        return nullptr;
+    }
+    QLibrary& lib = *entry->library;
+    auto abiVersion = reinterpret_cast<pycc_kernel_abi_version_fn>(lib.resolve("pycc_kernel_abi_version"));
+    auto name = reinterpret_cast<pycc_kernel_name_fn>(lib.resolve("pycc_kernel_name"));
+    auto description = reinterpret_cast<pycc_kernel_description_fn>(lib.resolve("pycc_kernel_description"));
+    auto inputCount = reinterpret_cast<pycc_kernel_input_count_fn>(lib.resolve("pycc_kernel_input_count"));
+    auto outputCount = reinterpret_cast<pycc_kernel_output_count_fn>(lib.resolve("pycc_kernel_output_count"));
+    auto outputName = reinterpret_cast<pycc_kernel_output_name_fn>(lib.resolve("pycc_kernel_output_name"));
+    auto kernel = reinterpret_cast<pycc_point_kernel_fn>(lib.resolve("pycc_point_kernel"));
+    if (!abiVersion || !name || !inputCount || !outputCount || !outputName || !kernel)
+    {
+        error = path.toStdString() + " is not a point kernel plugin (missing pycc_kernel_* functions)";
+        lib.unload();
+        return nullptr;
+    }
+    if (abiVersion() != PYCC_KERNEL_ABI_VERSION)
+    {
+        error = path.toStdString() + ": kernel ABI version " + std::to_string(abiVersion())
+              + ", version " + std::to_string(PYCC_KERNEL_ABI_VERSION) + " required";
+        lib.unload();
+        return nullptr;
+    }
+    pyCC_KernelPlugin& plugin = entry->plugin;
+    plugin.name = name() ? name() : "";
+    plugin.description = (description && description()) ? description() : "";
+    plugin.path = QFileInfo(path).canonicalFilePath();
+    plugin.inputCount = inputCount();
+    for (unsigned k = 0; k < outputCount(); k++)
+        plugin.outputs.push_back(outputName(k) ? outputName(k) : "");
+    plugin.kernel = kernel;
+    if (plugin.name.empty() || plugin.outputs.empty())
+    {
+        error = path.toStdString() + ": the kernel has no name or no output";
+        lib.unload();
+        return nullptr;
+    }
+    std::set<std::string> distinct;
+    for (const std::string& output : plugin.outputs)
+    {
+        if (output.empty() || !distinct.insert(output).second)
+        {
+            error = path.toStdString() + ": the kernel '" + plugin.name + "' has an empty or duplicate output name";
+            lib.unload();
+            return nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pluginsMutex);
+    auto it = plugins().find(plugin.name);
+    if (it != plugins().end())
+    {
+        if (it->second->plugin.path == plugin.path)
+        {
+            lib.unload(); // already loaded: the library is reference counted, and stays loaded by the first handle
+            return &it->second->plugin;
+        }
+        error = "a kernel named '" + plugin.name + "' is already loaded from " + it->second->plugin.path.toStdString();
+        lib.unload();
+        return nullptr;
+    }
+    const pyCC_KernelPlugin* result = &plugin;
+    plugins()[plugin.name] = std::move(entry);
+    return result;
+}
+
+const pyCC_KernelPlugin* pyCC_GetKernelPlugin(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(pluginsMutex);
+    auto it = plugins().find(name);
+    return (it != plugins().end()) ? &it->second->plugin : nullptr;
+}
+
+std::map<std::string, std::string> pyCC_KernelPluginDescriptions()
+{
+    std::lock_guard<std::mutex> lock(pluginsMutex);
+    std::map<std::string, std::string> descriptions;
+    for (const auto& plugin : plugins())
+        descriptions[plugin.first] = plugin.second->plugin.description;
+    return descriptions;
+}
+
+//! scalar fields seen as float arrays by the plugins: direct access, or converted copies if ScalarType is double
+template<typename Data> static bool floatArrays(const std::vector<Data*>& fields, size_t n, bool copy,
+                                                std::vector<std::vector<float>>& buffers,
+                                                std::vector<float*>& arrays)
+{
+    for (Data* field : fields)
+    {
+        if (std::is_same<ScalarType, float>::value)
+        {
+            arrays.push_back(reinterpret_cast<float*>(const_cast<ScalarType*>(field)));
+            continue;
+        }
+        try
+        {
+            buffers.emplace_back(n);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return false;
+        }
+        if (copy)
+        {
+            float* d = buffers.back().data();
+            pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                    d[i] = static_cast<float>(field[i]);
+            });
+        }
+        arrays.push_back(buffers.back().data());
+    }
+    return true;
+}
+
+bool pyCC_RunPointKernel(CCCoreLib::DgmOctree& octree,
+                         double radius,
+                         const pyCC_KernelPlugin& plugin,
+                         const std::vector<const ScalarType*>& inputs,
+                         const std::vector<ScalarType*>& outputs,
+                         int maxThreadCount)
+{
+    CCCoreLib::GenericIndexedCloudPersist* cloud = octree.associatedCloud();
+    size_t n = cloud->size();
+    if (n == 0 || inputs.size() != plugin.inputCount || outputs.size() != plugin.outputs.size())
+        return false;
+    std::vector<std::vector<float>> inBuffers, outBuffers;
+    std::vector<float*> in, out;
+    inBuffers.reserve(inputs.size());
+    outBuffers.reserve(outputs.size());
+    if (!floatArrays(inputs, n, true, inBuffers, in) || !floatArrays(outputs, n, false, outBuffers, out))
+        return false;
+
+    const PointCoordinateType r = static_cast<PointCoordinateType>(radius);
+    unsigned char level = octree.findBestLevelForAGivenNeighbourhoodSizeExtraction(r);
+    const float* xyz = reinterpret_cast<const float*>(cloud->getPoint(0));
+    PointKernelRunner runner(octree, r, level, plugin, xyz, in.data(), out.data());
+    bool ok = pyCC_RunCellKernel(octree, level, runner, std::vector<ScalarType*>(), maxThreadCount);
+
+    for (size_t k = 0; k < outBuffers.size(); k++)
+    {
+        const float* s = outBuffers[k].data();
+        ScalarType* d = outputs[k];
+        pyCC_ParallelFor(n, [=](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                d[i] = static_cast<ScalarType>(s[i]);
+        });
+    }
+    return ok;
+}
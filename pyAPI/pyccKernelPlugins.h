@@ -0,0 +1,74 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCKERNELPLUGINS_H_
+#define CLOUDCOMPY_PYAPI_PYCCKERNELPLUGINS_H_
+
+#include <CCTypes.h>
+
+#include <QString>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pyccKernelABI.h"
+
+namespace CCCoreLib
+{
+    class DgmOctree;
+}
+
+//! a point kernel plugin, loaded from a shared library following the C ABI of pyccKernelABI.h
+struct pyCC_KernelPlugin
+{
+    std::string name;
+    std::string description;
+    QString path;
+    unsigned inputCount;
+    std::vector<std::string> outputs;
+    pycc_point_kernel_fn kernel;
+};
+
+//! load a plugin and register it under its name; the library stays loaded until the end of the process
+/*! Loading again the same file returns the plugin already loaded.
+ *  \return the plugin, null with a message in error if the library is not a valid plugin (empty or duplicate
+ *  output names included) or if its name is already used
+ */
+const pyCC_KernelPlugin* pyCC_LoadKernelPlugin(const QString& path, std::string& error);
+
+//! a loaded plugin, null if the name is unknown
+const pyCC_KernelPlugin* pyCC_GetKernelPlugin(const std::string& name);
+
+//! the loaded plugins: name, description
+std::map<std::string, std::string> pyCC_KernelPluginDescriptions();
+
+//! run the plugin on all the points of the octree cloud, with their neighbours within the radius
+/*! The points are processed cell by cell, at the octree level suited to the radius, in parallel:
+ *  same scheduling as the CloudCompare geometric features (DgmOctree::executeFunctionForAllCellsAtLevel).
+ *  inputs and outputs: one array of the size of the cloud per input and per output of the plugin.
+ *  \return false if the plugin stopped the computation, or if there is not enough memory
+ */
+bool pyCC_RunPointKernel(CCCoreLib::DgmOctree& octree,
+                         double radius,
+                         const pyCC_KernelPlugin& plugin,
+                         const std::vector<const ScalarType*>& inputs,
+                         const std::vector<ScalarType*>& outputs,
+                         int maxThreadCount = 0);
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCKERNELPLUGINS_H_ */
@@ -0,0 +1,103 @@
+//##########################################################################
+//#                                                                        #
+//#                                PYCC                                    #
+//#                                                                        #
+//#  This program is free software; you can redistribute it and/or modify  #
+//#  it under the terms of the GNU Library General Public License as       #
+//#  published by the Free Software Foundation; version 2 or later of the  #
+//#  License.                                                              #
+//#                                                                        #
+//#  This program is distributed in the hope that it will be useful,       #
+//#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+//#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+//#  GNU General Public License for more details.                          #
+//#                                                                        #
+//#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+//#                                                                        #
+//##########################################################################
+
+#ifndef CLOUDCOMPY_PYAPI_PYCCPARALLEL_H_
+#define CLOUDCOMPY_PYAPI_PYCCPARALLEL_H_
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+//! below this number of items per chunk, splitting a loop costs more than it gains
+const size_t PYCC_PARALLEL_GRAIN = 32768;
+
+//! a contiguous range of items [begin, end[, processed by one task
+struct pyCC_Range
+{
+    size_t chunk;
+    size_t begin;
+    size_t end;
+};
+
+//! split [0, count[ in contiguous ranges, a few per thread to balance the load
+/*! \param count number of items
+ *  \param maxThreadCount maximum number of threads, 0 = all the cores
+ *  \return the ranges, a single one for small loops
+ */
+inline std::vector<pyCC_Range> pyCC_SplitRange(size_t count, int maxThreadCount = 0)
+{
+    size_t nbThreads = (maxThreadCount > 0) ? maxThreadCount : std::max(QThread::idealThreadCount(), 1);
+    size_t nbChunks = std::min(nbThreads * 4, count / PYCC_PARALLEL_GRAIN + 1);
+    if (nbThreads == 1)
+        nbChunks = 1;
+    std::vector<pyCC_Range> ranges;
+    ranges.reserve(nbChunks);
+    size_t step = count / nbChunks;
+    size_t remainder = count % nbChunks;
+    size_t begin = 0;
+    for (size_t i = 0; i < nbChunks; i++)
+    {
+        size_t end = begin + step + (i < remainder ? 1 : 0);
+        ranges.push_back({ i, begin, end });
+        begin = end;
+    }
+    return ranges;
+}
+
+//! apply func(const pyCC_Range&) on each range, with QtConcurrent (same scheduling as CCCoreLib)
+/*! func must be thread safe on disjoint ranges.
+ *  Use the chunk index of the range to store per thread partial results (reductions).
+ *  maxThreadCount limits the number of concurrent tasks, not the global thread pool (shared by concurrent calls):
+ *  at most maxThreadCount workers pick the ranges in turn.
+ */
+template<typename Func> void pyCC_ParallelForRanges(const std::vector<pyCC_Range>& ranges,
+                                                    Func func,
+                                                    int maxThreadCount = 0)
+{
+    if (ranges.size() < 2 || maxThreadCount == 1)
+    {
+        for (const auto& r : ranges)
+            func(r);
+        return;
+    }
+    if (maxThreadCount <= 0 || static_cast<size_t>(maxThreadCount) >= ranges.size())
+    {
+        std::vector<pyCC_Range> work = ranges;
+        QtConcurrent::blockingMap(work, func);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    std::vector<int> workers(maxThreadCount);
+    QtConcurrent::blockingMap(workers, [&](int&)
+    {
+        for (size_t r = next++; r < ranges.size(); r = next++)
+            func(ranges[r]);
+    });
+}
+
+//! apply func(begin, end) on consecutive chunks of [0, count[, in parallel
+template<typename Func> void pyCC_ParallelFor(size_t count, Func func, int maxThreadCount = 0)
+{
+    std::vector<pyCC_Range> ranges = pyCC_SplitRange(count, maxThreadCount);
+    pyCC_ParallelForRanges(ranges, [&func](const pyCC_Range& r) { func(r.begin, r.end); }, maxThreadCount);
+}
+
+#endif /* CLOUDCOMPY_PYAPI_PYCCPARALLEL_H_ */
@@ -0,0 +1,74 @@
+/*##########################################################################
+#                                                                        #
+#                               PYCC TEST                                #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################*/
+
+/* Example of point kernel plugin, see pyccKernelABI.h, loaded by test042.py:
+ * for each point, the number of neighbours, the mean of the input scalar field on the neighbourhood
+ * (NaN values ignored) and the height of the point above the lowest neighbour.
+ */
+
+#include <math.h>
+
+#include "pyccKernelABI.h"
+
+static const char* outputs[] = { "neighbourCount", "meanInput", "heightAboveMin" };
+
+PYCC_KERNEL_EXPORT int pycc_kernel_abi_version(void) { return PYCC_KERNEL_ABI_VERSION; }
+
+PYCC_KERNEL_EXPORT const char* pycc_kernel_name(void) { return "example"; }
+
+PYCC_KERNEL_EXPORT const char* pycc_kernel_description(void)
+{
+    return "neighbourCount, meanInput (mean of the input scalar field), heightAboveMin";
+}
+
+PYCC_KERNEL_EXPORT unsigned pycc_kernel_input_count(void) { return 1; }
+
+PYCC_KERNEL_EXPORT unsigned pycc_kernel_output_count(void) { return 3; }
+
+PYCC_KERNEL_EXPORT const char* pycc_kernel_output_name(unsigned output)
+{
+    return (output < 3) ? outputs[output] : 0;
+}
+
+PYCC_KERNEL_EXPORT int pycc_point_kernel(unsigned index,
+                                         const float* xyz,
+                                         const pycc_neighbours* neighbours,
+                                         const float* const* sfIn,
+                                         float* const* sfOut)
+{
+    double sum = 0;
+    unsigned valid = 0;
+    float zmin = xyz[3 * index + 2];
+    unsigned k;
+    for (k = 0; k < neighbours->count; k++)
+    {
+        unsigned j = neighbours->indexes[k];
+        float v = sfIn[0][j];
+        if (!isnan(v))
+        {
+            sum += v;
+            valid++;
+        }
+        if (xyz[3 * j + 2] < zmin)
+            zmin = xyz[3 * j + 2];
+    }
+    sfOut[0][index] = (float)neighbours->count;
+    sfOut[1][index] = valid ? (float)(sum / valid) : NAN;
+    sfOut[2][index] = xyz[3 * index + 2] - zmin;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+if cloud.isShifted():
+    raise RuntimeError
+
+cloud.setGlobalShift((-1000000., -2000000., 0.))
+if not cloud.isShifted():
+    raise RuntimeError
+shift = cloud.getGlobalShift()
+if shift != (-1000000., -2000000., 0.):
+    raise RuntimeError
+if cloud.getGlobalScale() != 1.0:
+    raise RuntimeError
+
+local = cloud.toNpArrayCopy()
+glob = cloud.toNpArrayGlobal()
+if glob.dtype != np.float64 or glob.shape != (1000000, 3):
+    raise RuntimeError
+ref = local.astype(np.float64) - np.array(shift)
+if not np.array_equal(glob, ref):
+    raise RuntimeError
+
+cloud2 = cc.ccPointCloud("fromGlobal")
+cloud2.setGlobalShift(shift)
+cloud2.fromNpArrayGlobal(glob)
+if cloud2.size() != 1000000:
+    raise RuntimeError
+if not np.array_equal(cloud2.toNpArray(), local):
+    raise RuntimeError
+
+cloud3 = cc.ccPointCloud("autoShift")
+cloud3.fromNpArrayGlobal(glob, True)
+if not cloud3.isShifted():
+    raise RuntimeError
+glob3 = cloud3.toNpArrayGlobal()
+if not np.allclose(glob3, glob, rtol=0., atol=1.e-3):
+    raise RuntimeError
+
+cloud.setGlobalScale(2.0)
+glob = cloud.toNpArrayGlobal()
+if not np.allclose(glob, local.astype(np.float64)/2.0 - np.array(shift)):
+    raise RuntimeError
+
+res = cc.SavePointCloud(cloud2, os.path.join(dataDir, "globalShift.bin"))
+if res:
+    raise RuntimeError
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+sf = cloud.getScalarField(0)
+
+if cloud.__dlpack_device__() != (1, 0):
+    raise RuntimeError
+if sf.__dlpack_device__() != (1, 0):
+    raise RuntimeError
+
+# --- round trip through a capsule: the new cloud is a copy
+capsule = cloud.__dlpack__()
+cloud2 = cc.ccPointCloud.fromDLPack(capsule, "fromCapsule")
+if cloud2.size() != cloud.size():
+    raise RuntimeError
+if not np.array_equal(cloud2.toNpArray(), cloud.toNpArray()):
+    raise RuntimeError
+if cloud2.getName() != "fromCapsule":
+    raise RuntimeError
+
+# --- a consumed capsule can not be used twice
+try:
+    cc.ccPointCloud.fromDLPack(capsule)
+except ValueError:
+    pass
+else:
+    raise RuntimeError
+
+# --- objects implementing the DLPack protocol (numpy >= 1.22)
+if hasattr(np, "from_dlpack"):
+    coords = np.from_dlpack(cloud)
+    if coords.shape != (1000000, 3):
+        raise RuntimeError
+    if not np.shares_memory(coords, cloud.toNpArray()):
+        raise RuntimeError
+    asf = np.from_dlpack(sf)
+    if not np.shares_memory(asf, sf.toNpArray()):
+        raise RuntimeError
+    if not np.array_equal(asf, coords[:, 2]):
+        raise RuntimeError
+
+    cloud3 = cc.ccPointCloud.fromDLPack(cloud.toNpArrayCopy().astype(np.float64))
+    if not np.array_equal(cloud3.toNpArray(), cloud.toNpArray()):
+        raise RuntimeError
+
+    strided = cloud.toNpArrayCopy()[::2]
+    cloud4 = cc.ccPointCloud.fromDLPack(strided)
+    if cloud4.size() != 500000:
+        raise RuntimeError
+    if not np.array_equal(cloud4.toNpArray(), strided):
+        raise RuntimeError
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+cloud.renameScalarField(0, "height")
+
+# --- round trip through the capsules
+schema, array = cloud.toArrow()
+cloud2 = cc.fromArrow((schema, array), "fromArrow")
+if cloud2.size() != cloud.size():
+    raise RuntimeError
+if not np.array_equal(cloud2.toNpArray(), cloud.toNpArray()):
+    raise RuntimeError
+dic = cloud2.getScalarFieldDic()
+if "height" not in dic:
+    raise RuntimeError
+if not np.array_equal(cloud2.getScalarField(dic["height"]).toNpArray(), cloud.getScalarField(0).toNpArray()):
+    raise RuntimeError
+
+# --- consumed capsules can not be used twice
+try:
+    cc.fromArrow((schema, array))
+except ValueError:
+    pass
+else:
+    raise RuntimeError
+
+# --- evicted and packed fields are exported, restored in the cloud
+cloud.exportCoordToSF(True, False, False)
+cloud.evictScalarField("height")
+cloud.packScalarField("Coord. X", "float16")
+cloud4 = cc.fromArrow(cloud.toArrow())
+dic = cloud4.getScalarFieldDic()
+if "height" not in dic or "Coord. X" not in dic:
+    raise RuntimeError
+if not np.array_equal(cloud4.getScalarField(dic["height"]).toNpArray(), cloud.toNpArray()[:, 2]):
+    raise RuntimeError
+if cloud.getEvictedScalarFieldNames() or cloud.getPackedScalarFieldNames():
+    raise RuntimeError
+cloud.deleteScalarField(cloud.getScalarFieldDic()["Coord. X"])
+
+# --- with pyarrow, if available
+try:
+    import pyarrow as pa
+except ImportError:
+    pa = None
+
+if pa is not None and hasattr(pa.RecordBatch, "_import_from_c_capsule"):
+    batch = pa.RecordBatch._import_from_c_capsule(*cloud.toArrow())
+    if batch.num_rows != 1000000:
+        raise RuntimeError
+    if batch.schema.names != ["X", "Y", "Z", "height"]:
+        raise RuntimeError
+    if not np.array_equal(batch.column("Z").to_numpy(), cloud.toNpArray()[:, 2]):
+        raise RuntimeError
+    if not np.array_equal(batch.column("height").to_numpy(), cloud.toNpArray()[:, 2]):
+        raise RuntimeError
+
+    z = batch.column("Z").to_numpy()
+    intensity = pa.array((z * 100).astype(np.int32), mask=(z < 0))
+    batch2 = pa.RecordBatch.from_arrays([batch.column("X"), batch.column("Y"), batch.column("Z"), intensity],
+                                        names=["X", "Y", "Z", "Intensity"])
+    cloud3 = cc.fromArrow(batch2)
+    sf = cloud3.getScalarField("Intensity")
+    asf = sf.toNpArray()
+    if not np.all(np.isnan(asf[z < 0])):
+        raise RuntimeError
+    if not np.array_equal(asf[z >= 0], (z[z >= 0] * 100).astype(np.int32).astype(asf.dtype)):
+        raise RuntimeError
+
+    # null coordinates are rejected
+    zNull = pa.array(z, mask=(z < 0))
+    batch3 = pa.RecordBatch.from_arrays([batch.column("X"), batch.column("Y"), zNull], names=["X", "Y", "Z"])
+    try:
+        cc.fromArrow(batch3)
+    except ValueError:
+        pass
+    else:
+        raise RuntimeError
+
+    # two scalar field columns with the same name are rejected
+    batch4 = pa.RecordBatch.from_arrays([batch.column("X"), batch.column("Y"), batch.column("Z"), intensity, intensity],
+                                        names=["X", "Y", "Z", "Intensity", "Intensity"])
+    try:
+        cc.fromArrow(batch4)
+    except ValueError:
+        pass
+    else:
+        raise RuntimeError
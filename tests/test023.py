@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+n = cloud.size()
+
+indexes = np.arange(0, n, 3, dtype=np.int32)
+ref = cc.ReferenceCloud.fromIndices(cloud, indexes)
+if ref.size() != len(indexes):
+    raise RuntimeError
+back = ref.toIndices()
+if back.dtype != np.uint32:
+    raise RuntimeError
+if not np.array_equal(back, indexes):
+    raise RuntimeError
+
+coords = cloud.toNpArrayCopy()
+mask = coords[:, 0] > 0.
+ref = cc.ReferenceCloud.fromIndices(cloud, mask)
+if ref.size() != np.count_nonzero(mask):
+    raise RuntimeError
+if not np.array_equal(ref.toIndices(), np.flatnonzero(mask)):
+    raise RuntimeError
+
+(sub, warn) = cloud.partialClone(mask)
+if warn != 0 or sub.size() != np.count_nonzero(mask):
+    raise RuntimeError
+if not np.array_equal(sub.toNpArrayCopy(), coords[mask]):
+    raise RuntimeError
+
+(sub, warn) = cloud.partialClone(np.array([n - 1, 0, 5], dtype=np.uint64))
+if sub.size() != 3:
+    raise RuntimeError
+if not np.array_equal(sub.toNpArrayCopy(), coords[[n - 1, 0, 5]]):
+    raise RuntimeError
+
+try:
+    cc.ReferenceCloud.fromIndices(cloud, np.array([0, n], dtype=np.int64))
+    raise RuntimeError
+except IndexError:
+    pass
+
+try:
+    cc.ReferenceCloud.fromIndices(None, np.array([0, 1], dtype=np.int64))
+    raise RuntimeError
+except ValueError:
+    pass
+
+try:
+    cloud.partialClone(np.array([True, False]))
+    raise RuntimeError
+except ValueError:
+    pass
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, True, True)
+nameY = cloud.getScalarFieldName(0)
+nameZ = cloud.getScalarFieldName(1)
+n = cloud.size()
+coords = cloud.toNpArrayCopy()
+
+indexes = np.array([n - 1, 10, 10, 0], dtype=np.int64)
+(pts, sfs) = cloud.gather(indexes, [nameY, nameZ])
+if pts.shape != (4, 3):
+    raise RuntimeError
+if not np.array_equal(pts, coords[indexes]):
+    raise RuntimeError
+if not np.allclose(sfs[nameY], coords[indexes, 1]):
+    raise RuntimeError
+if not np.allclose(sfs[nameZ], coords[indexes, 2]):
+    raise RuntimeError
+
+p = cloud.getPoint(10)
+if not np.allclose(p, pts[1]):
+    raise RuntimeError
+
+mask = coords[:, 2] > 0.
+(pts, sfs) = cloud.gather(mask)
+if len(sfs) != 0 or pts.shape[0] != np.count_nonzero(mask):
+    raise RuntimeError
+
+try:
+    cloud.gather(np.array([n]))
+    raise RuntimeError
+except IndexError:
+    pass
+
+try:
+    cloud.getPoint(n)
+    raise RuntimeError
+except IndexError:
+    pass
+
+try:
+    cloud.gather(indexes, ["noSuchField"])
+    raise RuntimeError
+except KeyError:
+    pass
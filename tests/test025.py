@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+n = cloud.size()
+coords = cloud.toNpArrayCopy()
+sfz = cloud.getScalarField(0).toNpArrayCopy()
+
+mask = (coords[:, 0] > 0.) & (sfz < 1.)
+kept = cloud.filterByMask(mask)
+if kept.size() != np.count_nonzero(mask):
+    raise RuntimeError
+if not np.array_equal(kept.toNpArrayCopy(), coords[mask]):
+    raise RuntimeError
+if kept.getNumberOfScalarFields() != 1:
+    raise RuntimeError
+if not np.array_equal(kept.getScalarField(0).toNpArrayCopy(), sfz[mask]):
+    raise RuntimeError
+
+(kept, rejected) = cloud.split(mask)
+if kept.size() + rejected.size() != n:
+    raise RuntimeError
+if not np.array_equal(rejected.toNpArrayCopy(), coords[~mask]):
+    raise RuntimeError
+if not np.array_equal(rejected.getScalarField(0).toNpArrayCopy(), sfz[~mask]):
+    raise RuntimeError
+
+empty = cloud.filterByMask(np.zeros(n, dtype=bool))
+if empty.size() != 0:
+    raise RuntimeError
+
+try:
+    cloud.filterByMask(np.ones(n - 1, dtype=bool))
+    raise RuntimeError
+except ValueError:
+    pass
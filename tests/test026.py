@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+sf = cloud.getScalarField(0)
+asf = sf.toNpArray()
+asf[0:10] = np.nan
+a = asf[~np.isnan(asf)]
+
+st = sf.stats(bins=64, percentiles=[0., 5., 50., 95., 100.])
+if st['count'] != a.size or st['nanCount'] != 10:
+    raise RuntimeError
+if not math.isclose(st['min'], a.min()) or not math.isclose(st['max'], a.max()):
+    raise RuntimeError
+if not math.isclose(st['mean'], a.astype(np.float64).mean(), rel_tol=1.e-6, abs_tol=1.e-6):
+    raise RuntimeError
+if not math.isclose(st['variance'], a.astype(np.float64).var(), rel_tol=1.e-6):
+    raise RuntimeError
+
+(h, edges) = np.histogram(a, bins=64, range=(a.min(), a.max()))
+if st['histogram'].sum() != a.size:
+    raise RuntimeError
+if np.abs(st['histogram'] - h).sum() > 4:  # bin boundaries rounding
+    raise RuntimeError
+if not np.allclose(st['binEdges'], edges):
+    raise RuntimeError
+
+tol = 2. * (a.max() - a.min()) / 16384
+for p, v in st['percentiles'].items():
+    if abs(v - np.percentile(a, p)) > tol:
+        raise RuntimeError
+
+st = sf.stats(0)
+if len(st['histogram']) != 0 or len(st['percentiles']) != 0:
+    raise RuntimeError
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import locale
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, True, True)
+nameY = cloud.getScalarFieldName(0)
+nameZ = cloud.getScalarFieldName(1)
+coords = cloud.toNpArrayCopy().astype(np.float64)
+x = coords[:, 0]
+y = coords[:, 1]
+z = coords[:, 2]
+
+idx = cloud.evalScalarField("ratio", "clip(([%s] - X) / (abs([%s]) + 1), -0.5, 0.5)" % (nameY, nameZ))
+if cloud.getScalarFieldName(idx) != "ratio":
+    raise RuntimeError
+res = cloud.getScalarField(idx).toNpArrayCopy()
+ref = np.clip((y - x) / (np.abs(z) + 1), -0.5, 0.5)
+if not np.allclose(res, ref, atol=1.e-5):
+    raise RuntimeError
+
+# in place, on an input field
+idx2 = cloud.evalScalarField("ratio", "if(ratio > 0, ratio^2, -sqrt(-ratio)) + 2*pi")
+if idx2 != idx:
+    raise RuntimeError
+res = cloud.getScalarField(idx).toNpArrayCopy()
+ref = np.where(ref > 0, ref**2, -np.sqrt(np.abs(ref))) + 2*np.pi
+if not np.allclose(res, ref, atol=1.e-5):
+    raise RuntimeError
+sf = cloud.getScalarField(idx)
+if not math.isclose(sf.getMax(), res.max()):
+    raise RuntimeError
+
+for bad in ("X +", "foo(X)", "unknownField * 2", "Nx"):
+    try:
+        cloud.evalScalarField("bad", bad)
+        raise RuntimeError
+    except ValueError:
+        pass
+
+# --- numbers are read with a dot whatever the locale (comma decimal separator here)
+commaLocale = None
+for name in ("fr_FR.UTF-8", "fr_FR.utf8", "de_DE.UTF-8", "de_DE.utf8", "French_France.1252"):
+    try:
+        locale.setlocale(locale.LC_NUMERIC, name)
+        commaLocale = name
+        break
+    except locale.Error:
+        pass
+if commaLocale is None:
+    print("no comma decimal locale available, locale check skipped")
+else:
+    try:
+        idx = cloud.evalScalarField("scaled", "Z*1.5 + .5")
+        if not np.allclose(cloud.getScalarField(idx).toNpArrayCopy(), z * 1.5 + .5, atol=1.e-4):
+            raise RuntimeError
+    finally:
+        locale.setlocale(locale.LC_NUMERIC, "C")
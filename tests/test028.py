@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+nameZ = cloud.getScalarFieldName(0)
+coords = cloud.toNpArrayCopy()
+x = coords[:, 0]
+y = coords[:, 1]
+z = cloud.getScalarField(0).toNpArrayCopy()
+idx = cloud.evalScalarField("class", "floor(abs(X)) - 5 * floor(abs(X) / 5)")  # 0 to 4
+cl = cloud.getScalarField(idx).toNpArrayCopy()
+
+preds = [(nameZ, -1., 2.), ("class", "in", [1, 3]), ("Y", "lt", 1.)]
+mask = cloud.filterMask(preds)
+ref = (z >= -1.) & (z <= 2.) & np.isin(cl, [1, 3]) & (y < 1.)
+if mask.dtype != bool or not np.array_equal(mask, ref):
+    raise RuntimeError
+
+filtered = cloud.filter(preds)
+if filtered.size() != np.count_nonzero(ref):
+    raise RuntimeError
+if not np.array_equal(filtered.toNpArrayCopy(), coords[ref]):
+    raise RuntimeError
+if filtered.getNumberOfScalarFields() != 2:
+    raise RuntimeError
+
+mask = cloud.filterMask([("X", ">=", 0.), ("class", "notin", [0])])
+if not np.array_equal(mask, (x >= 0.) & (cl != 0)):
+    raise RuntimeError
+
+try:
+    cloud.filter([("noSuchField", 0., 1.)])
+    raise RuntimeError
+except KeyError:
+    pass
+
+try:
+    cloud.filter([("X", "between", 1.)])
+    raise RuntimeError
+except ValueError:
+    pass
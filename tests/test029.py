@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+n = cloud.size()
+idx = cloud.evalScalarField("class", "floor(abs(X)) - 5 * floor(abs(X) / 5)")  # 0 to 4
+cl = cloud.getScalarField(idx).toNpArrayCopy()
+idx = cloud.evalScalarField("height", "Z")
+z = cloud.getScalarField(idx).toNpArrayCopy()
+z[5] = np.nan
+cloud.getScalarField(idx).fromNpArrayCopy(z)
+
+size = cloud.packScalarField("class", "uint8")
+if size != n:
+    raise RuntimeError
+size = cloud.packScalarField("height", "int16", 0.001, -10.)
+if size != 2 * n:
+    raise RuntimeError
+if cloud.getNumberOfScalarFields() != 0:
+    raise RuntimeError
+if sorted(cloud.getPackedScalarFieldNames()) != ["class", "height"]:
+    raise RuntimeError
+
+(codes, scale, offset) = cloud.getPackedScalarField("class")
+if codes.dtype != np.uint8 or not np.array_equal(codes, cl.astype(np.uint8)):
+    raise RuntimeError
+
+cloud.unpackScalarField("class")
+cloud.unpackScalarField("height")
+if len(cloud.getPackedScalarFieldNames()) != 0:
+    raise RuntimeError
+dic = cloud.getScalarFieldDic()
+if not np.array_equal(cloud.getScalarField(dic["class"]).toNpArrayCopy(), cl):
+    raise RuntimeError
+zz = cloud.getScalarField(dic["height"]).toNpArrayCopy()
+if not np.isnan(zz[5]):
+    raise RuntimeError
+if not np.allclose(zz, z, atol=0.0006, equal_nan=True):
+    raise RuntimeError
+
+cloud.packScalarField("height", "float16")
+(h, scale, offset) = cloud.getPackedScalarField("height")
+if h.dtype != np.float16 or not np.array_equal(h, z.astype(np.float16), equal_nan=True):
+    raise RuntimeError
+
+try:
+    cloud.packScalarField("class", "uint4")
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- clones on a subset of the points get the packed fields unpacked, the cloud keeps them packed
+cloud.packScalarField("class", "uint8")
+mask = np.zeros(n, dtype=bool)
+mask[::3] = True
+(part, warnings) = cloud.partialClone(np.nonzero(mask)[0])
+masked = cloud.filterByMask(mask)
+for c in (part, masked):
+    if len(c.getPackedScalarFieldNames()) != 0 or c.size() != np.count_nonzero(mask):
+        raise RuntimeError
+    if not np.array_equal(c.getScalarField("class").toNpArrayCopy(), cl[mask]):
+        raise RuntimeError
+if sorted(cloud.getPackedScalarFieldNames()) != ["class", "height"] or cloud.getNumberOfScalarFields() != 0:
+    raise RuntimeError
+
+# --- fusion and resize unpack the fields first: no packed data of the former number of points
+other = cloud.cloneThis()
+cloud.fuse(other)
+if len(cloud.getPackedScalarFieldNames()) != 0 or len(other.getPackedScalarFieldNames()) != 2:
+    raise RuntimeError
+if not np.array_equal(cloud.getScalarField("class").toNpArrayCopy(), np.concatenate((cl, cl))):
+    raise RuntimeError
+other.resize(n // 2)
+if len(other.getPackedScalarFieldNames()) != 0:
+    raise RuntimeError
+if not np.array_equal(other.getScalarField("class").toNpArrayCopy(), cl[:n // 2]):
+    raise RuntimeError
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(True, True, True)
+n = cloud.size()
+names = [cloud.getScalarFieldName(i) for i in range(3)]
+values = [cloud.getScalarField(i).toNpArrayCopy() for i in range(3)]
+
+size = cloud.evictScalarField(names[0])
+if size != 4 * n and size != 8 * n:  # float or double scalar type
+    raise RuntimeError
+if cloud.getNumberOfScalarFields() != 2:
+    raise RuntimeError
+if cloud.evictScalarFields() != 2:
+    raise RuntimeError
+if sorted(cloud.getEvictedScalarFieldNames()) != sorted(names):
+    raise RuntimeError
+
+# materialised on first access by name
+sf = cloud.getScalarField(names[1])
+if sf is None or not np.array_equal(sf.toNpArrayCopy(), values[1]):
+    raise RuntimeError
+if cloud.getNumberOfScalarFields() != 1 or len(cloud.getEvictedScalarFieldNames()) != 2:
+    raise RuntimeError
+
+# and by the vectorized methods
+(pts, sfs) = cloud.gather(np.arange(10), [names[2]])
+if not np.array_equal(sfs[names[2]], values[2][:10]):
+    raise RuntimeError
+
+idx = cloud.restoreScalarField(names[0])
+if not np.array_equal(cloud.getScalarField(idx).toNpArrayCopy(), values[0]):
+    raise RuntimeError
+if len(cloud.getEvictedScalarFieldNames()) != 0:
+    raise RuntimeError
+
+# a packed field is also unpacked on first access
+cloud.packScalarField(names[0], "float16")
+sf = cloud.getScalarField(names[0])
+if sf is None or len(cloud.getPackedScalarFieldNames()) != 0:
+    raise RuntimeError
+
+if cloud.getScalarField("noSuchField") is not None:
+    raise RuntimeError
+
+# --- eviction down to a memory budget: the displayed field is kept
+fieldBytes = cloud.getScalarField(0).toNpArray().nbytes
+cloud.setCurrentDisplayedScalarField(0)
+displayed = cloud.getScalarFieldName(0)
+if cloud.evictScalarFields(1.5 * fieldBytes) != 2 or cloud.getNumberOfScalarFields() != 1:
+    raise RuntimeError
+if cloud.getScalarFieldName(0) != displayed:
+    raise RuntimeError
+cloud.evictScalarFields()
+
+# --- clones and saved files get the evicted fields, the cloud keeps them evicted
+clone1 = cloud.cloneThis()
+clone2 = cloud.filterByMask(np.ones(n, dtype=bool))
+for cl in (clone1, clone2):
+    if cl.getNumberOfScalarFields() != 3 or len(cl.getEvictedScalarFieldNames()) != 0:
+        raise RuntimeError
+    if not np.array_equal(cl.getScalarField(names[1]).toNpArrayCopy(), values[1]):
+        raise RuntimeError
+if cloud.getNumberOfScalarFields() != 0 or len(cloud.getEvictedScalarFieldNames()) != 3:
+    raise RuntimeError
+binFile = os.path.join(dataDir, "evicted.bin")
+if cc.SavePointCloud(cloud, binFile) != cc.CC_FILE_ERROR.CC_FERR_NO_ERROR:
+    raise RuntimeError
+reloaded = cc.loadPointCloud(binFile)
+if reloaded.getNumberOfScalarFields() != 3 or len(reloaded.getEvictedScalarFieldNames()) != 0:
+    raise RuntimeError
+if not np.array_equal(reloaded.getScalarField(names[2]).toNpArrayCopy(), values[2]):
+    raise RuntimeError
+if len(cloud.getEvictedScalarFieldNames()) != 3:
+    raise RuntimeError
+if not np.array_equal(cloud.getScalarField(names[2]).toNpArrayCopy(), values[2]):
+    raise RuntimeError
+
+# --- fusion and resize restore the evicted fields first: the cloud can still be saved
+for op in ("fuse", "resize"):
+    cl = cloud.cloneThis()
+    cl.evictScalarFields()
+    other = cloud.cloneThis()
+    other.evictScalarFields()
+    if op == "fuse":
+        cl.fuse(other)
+        expected = np.concatenate((values[1], values[1]))
+    else:
+        cl.resize(n // 2)
+        expected = values[1][:n // 2]
+    if len(cl.getEvictedScalarFieldNames()) != 0 or len(other.getEvictedScalarFieldNames()) != 3:
+        raise RuntimeError
+    if not np.array_equal(cl.getScalarField(names[1]).toNpArrayCopy(), expected):
+        raise RuntimeError
+    opFile = os.path.join(dataDir, "evicted_%s.bin" % op)
+    if cc.SavePointCloud(cl, opFile) != cc.CC_FILE_ERROR.CC_FERR_NO_ERROR:
+        raise RuntimeError
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+octree = cloud.computeOctree()
+coords = cloud.toNpArrayCopy()
+
+queries = coords[::1000]
+k = 6
+(idx, d2) = octree.knn(queries, k)
+if idx.shape != (len(queries), k) or d2.shape != (len(queries), k):
+    raise RuntimeError
+if not np.array_equal(idx[:, 0], np.arange(0, cloud.size(), 1000)):
+    raise RuntimeError  # each query point is its own nearest neighbour
+if not np.all(np.diff(d2, axis=1) >= 0):
+    raise RuntimeError
+
+# brute force check on a few queries
+for q in range(0, len(queries), 50):
+    dist = np.sum((coords.astype(np.float64) - queries[q])**2, axis=1)
+    ref = np.sort(dist)[:k]
+    if not np.allclose(d2[q], ref, rtol=1.e-4, atol=1.e-6):
+        raise RuntimeError
+
+# any memory layout: Fortran order, float64 Fortran order, columns of a wider array
+(idx0, d20) = octree.knn(np.ascontiguousarray(queries), k)
+wide = np.zeros((len(queries), 5), dtype=np.float32)
+wide[:, 1:4] = queries
+for q in (np.asfortranarray(queries), np.asfortranarray(queries, dtype=np.float64), wide[:, 1:4]):
+    (idxF, d2F) = octree.knn(q, k)
+    if not np.array_equal(idxF[:, 0], idx0[:, 0]) or not np.allclose(d2F, d20):
+        raise RuntimeError
+    (offF, nF, r2F) = octree.radiusSearch(q, 0.02)
+    if not np.all(np.diff(offF) >= 1):  # at least the query point itself
+        raise RuntimeError
+
+# query points outside the cloud, float64, with a maximum distance
+(idx, d2) = octree.knn(np.array([[0., 0., 100.], [0.1, 0.2, 0.3]]), 3, maxDist=1.)
+if np.any(idx[0] != -1) or not np.all(np.isinf(d2[0])):
+    raise RuntimeError
+if np.any(d2[1][idx[1] >= 0] > 1.):
+    raise RuntimeError
+
+try:
+    octree.knn(queries[:, :2], 3)
+    raise RuntimeError
+except TypeError:
+    pass
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+octree = cloud.computeOctree()
+coords = cloud.toNpArrayCopy().astype(np.float64)
+
+queries = coords[::2000]
+radius = 0.2
+(offsets, idx, d2) = octree.radiusSearch(queries, radius)
+if len(offsets) != len(queries) + 1 or offsets[-1] != len(idx) or len(idx) != len(d2):
+    raise RuntimeError
+for q in range(len(queries)):
+    dist = np.sum((coords - queries[q])**2, axis=1)
+    ref = np.flatnonzero(dist <= radius * radius)
+    found = idx[offsets[q]:offsets[q + 1]]
+    if set(found) != set(ref):
+        raise RuntimeError
+    if not np.all(np.diff(d2[offsets[q]:offsets[q + 1]]) >= 0):
+        raise RuntimeError
+
+# the single query API gives the same result
+pts = octree.getPointsInSphericalNeighbourhood(tuple(queries[3]), radius, octree.findBestLevelForAGivenNeighbourhoodSizeExtraction(radius))
+if set(p.pointIndex for p in pts) != set(idx[offsets[3]:offsets[4]]):
+    raise RuntimeError
+
+(offsets, idx, d2) = octree.boxSearch(queries, (0.4, 0.4, 1.))
+for q in range(len(queries)):
+    delta = np.abs(coords - queries[q])
+    ref = np.flatnonzero((delta[:, 0] <= 0.2) & (delta[:, 1] <= 0.2) & (delta[:, 2] <= 0.5))
+    if set(idx[offsets[q]:offsets[q + 1]]) != set(ref):
+        raise RuntimeError
+
+(offsets, idx, d2) = octree.cylinderSearch(queries, (0., 0., 1.), 0.2, 0.5)
+for q in range(len(queries)):
+    delta = coords - queries[q]
+    ref = np.flatnonzero((delta[:, 0]**2 + delta[:, 1]**2 <= 0.04) & (np.abs(delta[:, 2]) <= 0.5))
+    if set(idx[offsets[q]:offsets[q + 1]]) != set(ref):
+        raise RuntimeError
+
+try:
+    octree.radiusSearch(queries, 0.)
+    raise RuntimeError
+except ValueError:
+    pass
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+
+import os
+import struct
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+octree = cloud.computeOctree()
+level = 8
+codes = octree.getCellCodes(level)
+queries = cloud.toNpArrayCopy()[::500]
+(idx, d2) = octree.knn(queries, 5)
+
+octreeFile = os.path.join(dataDir, "res33.oct")
+if not cloud.saveOctree(octreeFile):
+    raise RuntimeError
+
+cloud2 = cc.loadPointCloud(getSampleCloud(5.0))
+if cloud2.getContentHash() != cloud.getContentHash():
+    raise RuntimeError
+if not cloud2.loadOctree(octreeFile):
+    raise RuntimeError
+octree2 = cloud2.getOctree()
+if octree2.getCellCodes(level) != codes:
+    raise RuntimeError
+if octree2.getCellNumber(level) != octree.getCellNumber(level):
+    raise RuntimeError
+(idx2, d22) = octree2.knn(queries, 5)
+if not np.array_equal(idx, idx2):
+    raise RuntimeError
+
+# a modified cloud does not match the saved octree
+cloud3 = cc.loadPointCloud(getSampleCloud(5.0))
+cloud3.translate((0., 0., 1.))
+if cloud3.getContentHash() == cloud.getContentHash():
+    raise RuntimeError
+if cloud3.loadOctree(octreeFile):
+    raise RuntimeError
+if cloud3.loadOctree(os.path.join(dataDir, "noSuchFile.oct")):
+    raise RuntimeError
+
+# a corrupted file with the right content hash is rejected
+with open(octreeFile, "rb") as f:
+    data = bytearray(f.read())
+coordSize = struct.unpack_from("<I", data, 8)[0]
+recordSize = struct.unpack_from("<I", data, 12)[0]
+headerSize = (64 + 12 * coordSize + 7) // 8 * 8
+badIndex = bytearray(data)
+struct.pack_into("<I", badIndex, headerSize, 0xFFFFFFFF)
+unsorted = bytearray(data)
+first = data[headerSize:headerSize + recordSize]
+unsorted[headerSize:headerSize + recordSize] = data[len(data) - recordSize:]
+unsorted[len(data) - recordSize:] = first
+truncated = data[:len(data) - recordSize]
+for i, bad in enumerate((badIndex, unsorted, truncated)):
+    badFile = os.path.join(dataDir, "res33_bad%d.oct" % i)
+    with open(badFile, "wb") as f:
+        f.write(bad)
+    if cloud2.loadOctree(badFile):
+        raise RuntimeError
+
+try:
+    cloud3.saveOctree(octreeFile)
+    raise RuntimeError
+except ValueError:
+    pass
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+
+# reference: sequential CloudCompare build
+octree = cloud.computeOctree(maxThreadCount=1)
+ref = {}
+for level in (1, 5, 10, 21):
+    ref[level] = (octree.getCellNumber(level), list(octree.getCellCodes(level, False)))
+
+# multithreaded build, with all the cores, then with 3 threads: same structure
+for nbThreads in (0, 3):
+    octree = cloud.computeOctree(maxThreadCount=nbThreads)
+    if octree is None:
+        raise RuntimeError
+    for level in ref:
+        if octree.getCellNumber(level) != ref[level][0]:
+            raise RuntimeError
+        if list(octree.getCellCodes(level, False)) != ref[level][1]:
+            raise RuntimeError
+
+# the octree is usable for neighbourhood queries
+queries = cloud.toNpArrayCopy()[::1000]
+(idx, d2) = octree.knn(queries, 1)
+if not np.allclose(d2[:, 0], 0.):
+    raise RuntimeError
+
+# points with NaN coordinates are not projected, as in the sequential build
+coords = cloud.toNpArrayCopy()[:20000]
+coords[500::1000] = np.nan
+nanCloud = cc.ccPointCloud("nan")
+nanCloud.coordsFromNPArray_copy(coords)
+nbValid = int(np.count_nonzero(~np.isnan(coords[:, 0])))
+seq = nanCloud.computeOctree(maxThreadCount=1)
+seqCodes = list(seq.getCellCodes(10, False))
+par = nanCloud.computeOctree(maxThreadCount=0)
+if seq.getNumberOfProjectedPoints() != nbValid or par.getNumberOfProjectedPoints() != nbValid:
+    raise RuntimeError
+if list(par.getCellCodes(10, False)) != seqCodes:
+    raise RuntimeError
+
+# the octree of a cloud with NaN coordinates is up to date: updateOctree does not rebuild it
+mins = par.getOctreeMins()
+view = nanCloud.toNpArray()
+view[:, 0] += 100.  # recorded only at the release of the view: a rebuild would move the octree
+if nanCloud.updateOctree().getOctreeMins() != mins:
+    raise RuntimeError
+view[:, 0] -= 100.
+del view
+
+# the points not in the octree are moved at the end of the reordered cloud
+perm = nanCloud.reorderSpatially()
+if len(perm) != len(coords) or len(np.unique(perm)) != len(coords):
+    raise RuntimeError
+if not np.isnan(nanCloud.toNpArrayCopy()[nbValid:, 0]).all():
+    raise RuntimeError
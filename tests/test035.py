@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+cloud.evalScalarField("sum", "X + Y")
+cloud.packScalarField("sum", "float16")
+coords = cloud.toNpArrayCopy()
+sfz = cloud.getScalarField(0).toNpArrayCopy()
+queries = coords[::700]
+octree = cloud.computeOctree()
+(idx0, d20) = octree.knn(queries, 3)
+
+perm = cloud.reorderSpatially()
+if perm.dtype != np.uint32 or perm.shape != (cloud.size(),):
+    raise RuntimeError
+if not np.array_equal(np.sort(perm), np.arange(cloud.size(), dtype=np.uint32)):
+    raise RuntimeError
+if cloud.getOctree() is not None:
+    raise RuntimeError
+
+# all the point data follow the permutation, packed fields are restored
+if not np.array_equal(cloud.toNpArrayCopy(), coords[perm]):
+    raise RuntimeError
+if not np.array_equal(cloud.getScalarField(0).toNpArrayCopy(), sfz[perm]):
+    raise RuntimeError
+if len(cloud.getPackedScalarFieldNames()) != 0 or cloud.getNumberOfScalarFields() != 2:
+    raise RuntimeError
+back = np.empty_like(sfz)
+back[perm] = cloud.getScalarField(0).toNpArrayCopy()
+if not np.array_equal(back, sfz):
+    raise RuntimeError
+
+# neighbourhood queries give the same neighbours, mapped back with the permutation
+octree = cloud.computeOctree()
+(idx1, d21) = octree.knn(queries, 3)
+if not np.allclose(d20, d21):
+    raise RuntimeError
+if not np.array_equal(np.sort(idx0[:, 0]), np.sort(perm[idx1[:, 0]].astype(np.int64))):
+    raise RuntimeError
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+import time
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+queries = cloud.toNpArrayCopy()[::300]
+
+kdTree = cloud.computeKDTree(leafSize=12)
+if kdTree is None or cloud.getKDTree() is None:
+    raise RuntimeError
+if kdTree.size() != cloud.size() or kdTree.getLeafSize() != 12 or kdTree.getMemoryUsed() <= 0:
+    raise RuntimeError
+
+# --- same neighbours with both backends
+(idxT, d2T) = cloud.knn(queries, 8, backend="kdtree")
+(idxO, d2O) = cloud.knn(queries, 8, backend="octree")
+if not np.allclose(d2T, d2O):
+    raise RuntimeError
+if not np.allclose(d2T[:, 0], 0.):
+    raise RuntimeError
+(offT, nT, r2T) = cloud.radiusSearch(queries, 0.2, backend="kdtree")
+(offO, nO, r2O) = cloud.radiusSearch(queries, 0.2, backend="octree")
+# the octree compares distances in single precision: a point exactly on the sphere may differ
+if np.abs(np.diff(offT) - np.diff(offO)).sum() > len(queries) // 100:
+    raise RuntimeError
+if abs(r2T.sum() - r2O.sum()) > 0.04 * (len(queries) // 100 + 1):
+    raise RuntimeError
+(idxA, d2A) = cloud.knn(queries, 8, maxDist=0.05)  # auto: the KD-tree is attached
+(idxB, d2B) = kdTree.knn(queries, 8, 0.05)
+if not np.array_equal(idxA, idxB) or np.any(d2A[idxA >= 0] > 0.05**2):
+    raise RuntimeError
+
+try:
+    cloud.knn(queries, 8, backend="ball")
+except ValueError:
+    pass
+else:
+    raise RuntimeError
+
+cloud.deleteKDTree()
+if cloud.getKDTree() is not None:
+    raise RuntimeError
+
+# the tree held by Python outlives its removal from the cloud
+(idxC, d2C) = kdTree.knn(queries, 8, 0.05)
+if not np.array_equal(idxC, idxB) or kdTree.size() != cloud.size():
+    raise RuntimeError
+kdTree = cloud.computeKDTree()
+cloud.translate((0., 0., 1.))  # new content version: the cloud drops its tree
+if cloud.getKDTree() is not None or kdTree.size() != cloud.size():
+    raise RuntimeError
+(idxD, d2D) = kdTree.knn(queries, 8, 0.05)
+if not np.array_equal(idxD, idxB):
+    raise RuntimeError
+
+# --- benchmark: uniform density, and highly varying density (scanner like, dense near the origin)
+npts = 1000000
+rng = np.random.default_rng(42)
+uniform = np.float32(rng.uniform(-10., 10., (npts, 3)))
+dirs = rng.normal(size=(npts, 3))
+dirs /= np.linalg.norm(dirs, axis=1)[:, None]
+scan = np.float32(dirs * (0.5 + 50. * rng.random(npts)**4)[:, None])
+for (name, coords) in (("uniform", uniform), ("varying density", scan)):
+    cl = cc.ccPointCloud(name)
+    cl.coordsFromNPArray_copy(coords)
+    q = coords[::10]
+    t0 = time.perf_counter()
+    cl.computeOctree()
+    t1 = time.perf_counter()
+    (io, do) = cl.knn(q, 10, backend="octree")
+    t2 = time.perf_counter()
+    cl.computeKDTree()
+    t3 = time.perf_counter()
+    (it, dt) = cl.knn(q, 10, backend="kdtree")
+    t4 = time.perf_counter()
+    if not np.allclose(do, dt):
+        raise RuntimeError
+    print("%s: octree build %.3fs, knn %.3fs; KD-tree build %.3fs, knn %.3fs" % (name, t1 - t0, t2 - t1, t3 - t2, t4 - t3))
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+octree = cloud.computeOctree()
+level = 6
+table = octree.cellTable(level)
+codes = table["codes"]
+nbCells = octree.getCellNumber(level)
+if codes.shape != (nbCells,) or table["positions"].shape != (nbCells, 3):
+    raise RuntimeError
+if list(codes) != list(octree.getCellCodes(level, True)):
+    raise RuntimeError
+counts = table["counts"]
+offsets = table["offsets"]
+indexes = table["indexes"]
+if counts.sum() != cloud.size() or offsets[0] != 0 or not np.array_equal(offsets[1:], np.cumsum(counts)[:-1]):
+    raise RuntimeError
+if not np.array_equal(np.sort(indexes), np.arange(cloud.size(), dtype=np.uint32)):
+    raise RuntimeError
+for i in (0, nbCells // 2, nbCells - 1):
+    pos = octree.getCellPos(int(codes[i]), level, True)
+    if (pos[0], pos[1], pos[2]) != tuple(table["positions"][i]):
+        raise RuntimeError
+
+# --- per voxel statistics in numpy: centroids are inside their cell
+coords = cloud.toNpArrayCopy()
+centroids = np.add.reduceat(coords[indexes], offsets, axis=0) / counts[:, None]
+cellSize = octree.getCellSize(level)
+mins = np.array(octree.getOctreeMins())
+cellMins = mins + table["positions"] * cellSize
+if np.any(centroids < cellMins - 1.e-4) or np.any(centroids > cellMins + cellSize + 1.e-4):
+    raise RuntimeError
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.evalScalarField("Intensity", "abs(X * Y) + Z")
+octree = cloud.computeOctree()
+level = 6
+vox = cc.voxelAggregate(cloud, level, 0., {"Intensity": ["mean", "median"], "Z": ["min", "max"], "count": True})
+if vox.getName() != cloud.getName() + ".voxels":
+    raise RuntimeError
+nbCells = octree.getCellNumber(level)
+if vox.size() != nbCells or vox.getNumberOfScalarFields() != 5:
+    raise RuntimeError
+
+# --- reference: per cell statistics in numpy, same cell order
+table = octree.cellTable(level)
+idx = table["indexes"]
+off = table["offsets"]
+coords = cloud.toNpArrayCopy()[idx]
+values = cloud.getScalarField("Intensity").toNpArrayCopy()[idx]
+counts = table["counts"]
+sfs = vox.getScalarFieldDic()
+if not np.array_equal(vox.getScalarField(sfs["count"]).toNpArrayCopy(), counts):
+    raise RuntimeError
+if not np.allclose(vox.getScalarField(sfs["Z_min"]).toNpArrayCopy(), np.minimum.reduceat(coords[:, 2], off)):
+    raise RuntimeError
+if not np.allclose(vox.getScalarField(sfs["Z_max"]).toNpArrayCopy(), np.maximum.reduceat(coords[:, 2], off)):
+    raise RuntimeError
+if not np.allclose(vox.getScalarField(sfs["Intensity_mean"]).toNpArrayCopy(),
+                   np.add.reduceat(values, off) / counts, rtol=1.e-5, atol=1.e-5):
+    raise RuntimeError
+medians = vox.getScalarField(sfs["Intensity_median"]).toNpArrayCopy()
+for c in (0, nbCells // 3, nbCells - 1):
+    if not math.isclose(medians[c], np.median(values[off[c]:off[c] + counts[c]]), rel_tol=1.e-5, abs_tol=1.e-5):
+        raise RuntimeError
+centroids = np.add.reduceat(np.float64(coords), off, axis=0) / counts[:, None]
+if not np.allclose(vox.toNpArrayCopy(), centroids, atol=1.e-4):
+    raise RuntimeError
+
+# --- with a cell size
+vox2 = cc.voxelAggregate(cloud, cellSize=octree.getCellSize(level) * 1.5, aggregates={"count": True})
+if vox2.size() != nbCells:
+    raise RuntimeError
+
+try:
+    cc.voxelAggregate(cloud, level, 0., {"Z": ["min", "min"]})
+except ValueError:
+    pass
+else:
+    raise RuntimeError
+
+for bad in ({"Intensity": "mode"}, {"Unknown": "mean"}, {"color": "mean"}):
+    try:
+        cc.voxelAggregate(cloud, level, 0., bad)
+    except (ValueError, KeyError):
+        pass
+    else:
+        raise RuntimeError
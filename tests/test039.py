@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, getSamplePoly, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+poly = cc.loadPolyline(getSamplePoly("poly1"))
+vertices = np.array([[1., 2., 0.], [2., 4., 0.], [3., 1., 0.], [2., -2., 0.], [-1., -3., 0.], [-1., -1., 0.], [-2., 2., 0.]])
+radius = 1.5
+
+corridor = cc.extractCorridor(cloud, poly, radius)
+offsets = corridor["offsets"]
+if offsets.shape != (poly.segmentCount() + 1,) or offsets[-1] != len(corridor["indexes"]):
+    raise RuntimeError
+
+# --- brute force reference in numpy, points near the cylinder surface excluded from the comparison
+coords = np.float64(cloud.toNpArrayCopy())
+nbSeg = poly.segmentCount()
+lengths = [np.linalg.norm(vertices[s + 1] - vertices[s]) for s in range(nbSeg)]
+abscissas = [(coords - vertices[s]) @ ((vertices[s + 1] - vertices[s]) / lengths[s]) for s in range(nbSeg)]
+startAlong = 0.
+for s in range(nbSeg):
+    A = vertices[s]
+    B = vertices[s + 1]
+    length = lengths[s]
+    u = (B - A) / length
+    AP = coords - A
+    t = abscissas[s]
+    dist = np.sqrt(np.maximum(0., (AP * AP).sum(axis=1) - t * t))
+    inside = (t >= 0.) & (t <= length) & (dist <= radius)
+    sure = (np.abs(dist - radius) > 1.e-4) & (np.abs(t) > 1.e-4) & (np.abs(t - length) > 1.e-4)
+    # outer side of the bends: beyond both segments, within the radius of the vertex, least overshoot
+    tClamped = np.clip(t, 0., length)
+    vertexDist = np.linalg.norm(AP - np.outer(tClamped, u), axis=1)
+    if s > 0:
+        overPrev = abscissas[s - 1] - lengths[s - 1]
+        atStart = (t < 0.) & (overPrev > 0.) & (-t <= overPrev) & (vertexDist <= radius)
+        inside |= atStart
+        sure &= (np.abs(vertexDist - radius) > 1.e-4) & (np.abs(overPrev) > 1.e-4) & (np.abs(-t - overPrev) > 1.e-4)
+    if s < nbSeg - 1:
+        overNext = -abscissas[s + 1]
+        atEnd = (t > length) & (overNext > 0.) & (t - length < overNext) & (vertexDist <= radius)
+        inside |= atEnd
+        sure &= (np.abs(vertexDist - radius) > 1.e-4) & (np.abs(overNext) > 1.e-4) & (np.abs(t - length - overNext) > 1.e-4)
+    dist = np.where((t >= 0.) & (t <= length), dist, vertexDist)
+    seg = slice(offsets[s], offsets[s + 1])
+    found = corridor["indexes"][seg]
+    if set(np.nonzero(inside & sure)[0]) != set(found) - set(np.nonzero(~sure)[0]):
+        raise RuntimeError
+    if np.any(np.diff(corridor["along"][seg]) < 0):
+        raise RuntimeError
+    if not np.allclose(corridor["along"][seg], startAlong + tClamped[found], atol=1.e-4):
+        raise RuntimeError
+    if not np.allclose(corridor["distance"][seg], dist[found], atol=1.e-4):
+        raise RuntimeError
+    left = np.array([-u[1], u[0], 0.]) / np.linalg.norm(u[:2])
+    if not np.allclose(corridor["across"][seg], AP[found] @ left, atol=1.e-4):
+        raise RuntimeError
+    startAlong += length
+
+# every point within the radius of the polyline is found, including around the outer side of the bends
+near = np.zeros(len(coords), dtype=bool)
+for s in range(nbSeg):
+    u = (vertices[s + 1] - vertices[s]) / lengths[s]
+    tc = np.clip(abscissas[s], 0., lengths[s])
+    near |= np.linalg.norm(coords - vertices[s] - np.outer(tc, u), axis=1) < radius - 1.e-4
+if not set(np.nonzero(near)[0]) <= set(corridor["indexes"]):
+    raise RuntimeError
+
+# a tiny step is raised to radius/16: same points
+tiny = cc.extractCorridor(cloud, poly, radius, 1.e-6)
+if not np.array_equal(np.sort(tiny["indexes"]), np.sort(corridor["indexes"])):
+    raise RuntimeError
+
+if not math.isclose(startAlong, poly.computeLength(), rel_tol=1.e-5):
+    raise RuntimeError
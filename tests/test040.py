@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+if cloud.getContentVersion() != 0:
+    raise RuntimeError
+
+def checkNeighbours(cloud):
+    """the octree kept by the transformations must give the same neighbours as a brute force search"""
+    coords = np.float64(cloud.toNpArrayCopy())
+    queries = np.float32(coords[::5000] + 0.01)
+    (indexes, d2) = cloud.knn(queries, 4, backend="octree")
+    for q in range(len(queries)):
+        bf = ((coords - queries[q])**2).sum(axis=1)
+        ref = np.sort(bf)[:4]
+        if not np.allclose(d2[q], ref, rtol=1.e-4, atol=1.e-6):
+            raise RuntimeError
+
+# --- translation: the octree is kept, its bounding box translated
+octree = cloud.updateOctree()
+mins = np.array(octree.getOctreeMins())
+cloud.translate((1., 2., 3.))
+if cloud.getContentVersion() != 1:
+    raise RuntimeError
+octree = cloud.getOctree()
+if octree is None:
+    raise RuntimeError
+if not np.allclose(np.array(octree.getOctreeMins()), mins + (1., 2., 3.), atol=1.e-5):
+    raise RuntimeError
+checkNeighbours(cloud)
+
+# --- uniform scale: the octree is kept, non uniform scale: the octree is dropped
+cloud.scale(2., 2., 2., (1., 1., 1.))
+if cloud.getContentVersion() != 2 or cloud.getOctree() is None:
+    raise RuntimeError
+checkNeighbours(cloud)
+cloud.scale(1., 0.5, 1.)
+if cloud.getContentVersion() != 3 or cloud.getOctree() is not None:
+    raise RuntimeError
+
+# --- updateOctree computes only when needed
+octree = cloud.updateOctree()
+if octree is None or cloud.getOctree() is None:
+    raise RuntimeError
+if cloud.updateOctree().getOctreeMins() != octree.getOctreeMins():
+    raise RuntimeError
+
+# --- rigid transformations: only a translation keeps the octree
+tr = cc.ccGLMatrix()
+tr.initFromParameters(0., (0., 0., 1.), (5., 0., 0.))
+cloud.applyRigidTransformation(tr)
+if cloud.getContentVersion() != 4 or cloud.getOctree() is None:
+    raise RuntimeError
+checkNeighbours(cloud)
+tr.initFromParameters(0.3, (0., 0., 1.), (5., 0., 0.))
+cloud.applyRigidTransformation(tr)
+if cloud.getContentVersion() != 5 or cloud.getOctree() is not None:
+    raise RuntimeError
+
+# --- writable views: a modification is recorded at the release of the array
+cloud.updateOctree()
+cloud.computeKDTree()
+coords = cloud.toNpArray()
+total = coords.sum()
+del coords
+if cloud.getContentVersion() != 5 or cloud.getOctree() is None or cloud.getKDTree() is None:
+    raise RuntimeError
+coords = cloud.toNpArray()
+coords[:, 2] += 1.
+if cloud.getContentVersion() != 5:
+    raise RuntimeError
+del coords
+if cloud.getContentVersion() != 6 or cloud.getOctree() is not None or cloud.getKDTree() is not None:
+    raise RuntimeError
+
+# --- explicit notification and copies
+cloud.updateOctree()
+cloud.notifyGeometryUpdate()
+if cloud.getContentVersion() != 7 or cloud.getOctree() is not None:
+    raise RuntimeError
+cloud.coordsFromNPArray_copy(cloud.toNpArrayCopy())
+if cloud.getContentVersion() != 8:
+    raise RuntimeError
+
+# --- a read-only view keeps the octree built while it is in use
+coords = cloud.toNpArray()
+(idx, d2) = cloud.knn(coords[::1000], 2, backend="octree")
+del coords
+if cloud.getContentVersion() != 8 or cloud.getOctree() is None:
+    raise RuntimeError
+coords = cloud.toNpArray()
+coords[0, 0] += 1.
+del coords
+if cloud.getContentVersion() != 9 or cloud.getOctree() is not None:
+    raise RuntimeError
+
+# --- the version is kept in the metadata of a BIN file
+binFile = os.path.join(dataDir, "res40.bin")
+if cc.SavePointCloud(cloud, binFile) != cc.CC_FILE_ERROR.CC_FERR_NO_ERROR:
+    raise RuntimeError
+reloaded = cc.loadPointCloud(binFile)
+if reloaded.getContentVersion() != 9:
+    raise RuntimeError
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import locale
+import math
+import threading
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+kernels = cc.getCellKernels()
+for name in ("count", "height", "pca", "plane", "sf", "zpercentile"):
+    if name not in kernels:
+        raise RuntimeError
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+cloud.exportCoordToSF(False, False, True)
+octree = cloud.computeOctree()
+level = 6
+table = octree.cellTable(level)
+counts = table["counts"]
+offsets = table["offsets"]
+indexes = table["indexes"]
+coords = np.float64(cloud.toNpArrayCopy())
+z = coords[indexes, 2]
+
+def sfValues(name):
+    return cloud.getScalarField(name).toNpArrayCopy()[indexes]
+
+def perCell(values):
+    """the value of the first point of each cell, checking that all the points of a cell share the value"""
+    first = values[offsets]
+    if not np.array_equal(np.repeat(first, counts), values):
+        raise RuntimeError
+    return first
+
+# --- count and height
+res = octree.runCellKernel(level, "count")
+if list(res.keys()) != ["count"] or not np.array_equal(perCell(sfValues("count")), counts):
+    raise RuntimeError
+res = octree.runCellKernel(level, "height", ["zmin", "zmean", "height"])
+if len(res) != 3 or cloud.getScalarField(res["zmean"]).getName() != "zmean":
+    raise RuntimeError
+zmin = np.minimum.reduceat(z, offsets)
+if not np.allclose(perCell(sfValues("zmin")), zmin, atol=1.e-5):
+    raise RuntimeError
+zmean = np.add.reduceat(z, offsets) / counts
+if not np.allclose(perCell(sfValues("zmean")), zmean, atol=1.e-4):
+    raise RuntimeError
+if not np.allclose(sfValues("height"), z - np.repeat(zmin, counts), atol=1.e-4):
+    raise RuntimeError
+
+# --- scalar field statistics and percentiles
+octree.runCellKernel(level, "sf", ["Coord. Z_mean", "Coord. Z_max", "Coord. Z_median"])
+if not np.allclose(perCell(sfValues("Coord. Z_mean")), zmean, atol=1.e-4):
+    raise RuntimeError
+if not np.allclose(perCell(sfValues("Coord. Z_max")), np.maximum.reduceat(z, offsets), atol=1.e-5):
+    raise RuntimeError
+octree.runCellKernel(level, "zpercentile", ["p50", "p90"])
+cells = range(0, len(counts), max(1, len(counts) // 50))
+p90 = sfValues("p90")
+median = sfValues("Coord. Z_median")
+for c in cells:
+    zc = z[offsets[c]:offsets[c] + counts[c]]
+    if not math.isclose(p90[offsets[c]], np.percentile(zc, 90), abs_tol=1.e-4):
+        raise RuntimeError
+    if not math.isclose(median[offsets[c]], np.median(zc), abs_tol=1.e-4):
+        raise RuntimeError
+
+# --- PCA and plane against numpy
+octree.runCellKernel(level, "pca", ["eigenvalue1", "planarity", "verticality"])
+octree.runCellKernel(level, "plane", ["distance", "nz"])
+(eigenvalue1, planarity, nz, distance) = (sfValues(name) for name in ("eigenvalue1", "planarity", "nz", "distance"))
+for c in cells:
+    if counts[c] < 3:
+        if not math.isnan(planarity[offsets[c]]):
+            raise RuntimeError
+        continue
+    pts = coords[indexes[offsets[c]:offsets[c] + counts[c]]]
+    centered = pts - pts.mean(axis=0)
+    l, v = np.linalg.eigh(centered.T @ centered / len(pts))
+    l = np.maximum(l[::-1], 0.)
+    normal = v[:, 0] if v[2, 0] >= 0 else -v[:, 0]
+    i = offsets[c]
+    if not math.isclose(eigenvalue1[i], l[0], rel_tol=1.e-3, abs_tol=1.e-6):
+        raise RuntimeError
+    if l[0] > 1.e-6 and not math.isclose(planarity[i], (l[1] - l[2]) / l[0], abs_tol=1.e-3):
+        raise RuntimeError
+    if l[1] - l[2] > 1.e-3 * l[0]:
+        if not math.isclose(nz[i], normal[2], abs_tol=1.e-3):
+            raise RuntimeError
+        if not np.allclose(distance[i:i + counts[c]], centered @ normal, atol=1.e-3):
+            raise RuntimeError
+
+# --- errors
+try:
+    octree.runCellKernel(level, "nothing")
+    raise RuntimeError
+except KeyError:
+    pass
+try:
+    octree.runCellKernel(level, "pca", ["flatness"])
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- existing outputs are replaced only on request, repeated outputs are rejected
+try:
+    octree.runCellKernel(level, "count")
+    raise RuntimeError
+except ValueError:
+    pass
+res = octree.runCellKernel(level, "count", overwrite=True)
+if not np.array_equal(perCell(sfValues("count")), counts):
+    raise RuntimeError
+try:
+    octree.runCellKernel(level, "zpercentile", ["p10", "p10"], overwrite=True)
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- the "sf" kernel reads evicted scalar fields
+cloud.evictScalarField("Coord. Z")
+octree.runCellKernel(level, "sf", ["Coord. Z_min"])
+if not np.allclose(perCell(sfValues("Coord. Z_min")), zmin, atol=1.e-5):
+    raise RuntimeError
+
+# --- decimal percentiles are read with a dot whatever the locale
+for name in ("fr_FR.UTF-8", "fr_FR.utf8", "de_DE.UTF-8", "de_DE.utf8", ""):
+    try:
+        locale.setlocale(locale.LC_NUMERIC, name)
+        break
+    except locale.Error:
+        pass
+try:
+    octree.runCellKernel(level, "zpercentile", ["p2.5"])
+    p25 = sfValues("p2.5")
+    c = max(range(len(counts)), key=lambda k: counts[k])
+    zc = z[offsets[c]:offsets[c] + counts[c]]
+    if not math.isclose(p25[offsets[c]], np.percentile(zc, 2.5), abs_tol=1.e-4):
+        raise RuntimeError
+finally:
+    locale.setlocale(locale.LC_NUMERIC, "C")
+
+# --- concurrent runs from Python threads are serialized, each with its own kernel and outputs
+errors = []
+def run(outputs):
+    try:
+        octree.runCellKernel(level, "height", outputs, overwrite=True)
+    except Exception as e:
+        errors.append(e)
+threads = [threading.Thread(target=run, args=(["zmax"],)), threading.Thread(target=run, args=(["zrange"],))]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+if errors:
+    raise RuntimeError
+zmax = np.maximum.reduceat(z, offsets)
+if not np.allclose(perCell(sfValues("zmax")), zmax, atol=1.e-5):
+    raise RuntimeError
+if not np.allclose(perCell(sfValues("zrange")), zmax - zmin, atol=1.e-4):
+    raise RuntimeError
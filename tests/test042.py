@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+import glob
+import gendata
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+# --- the example plugin (pyccKernelExample.c) is built and installed next to the test utilities
+libs = [f for f in glob.glob(os.path.join(os.path.dirname(os.path.abspath(gendata.__file__)), "*pyccKernelExample*"))
+        if os.path.splitext(f)[1] in (".so", ".dll", ".dylib")]
+if not libs:
+    raise RuntimeError
+info = cc.loadKernel(libs[0])
+if info["name"] != "example" or info["inputCount"] != 1:
+    raise RuntimeError
+if info["outputs"] != ["neighbourCount", "meanInput", "heightAboveMin"]:
+    raise RuntimeError
+if cc.loadKernel(libs[0])["name"] != "example" or "example" not in cc.getLoadedKernels():
+    raise RuntimeError
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+coords = np.float64(cloud.toNpArrayCopy())
+z = coords[:, 2]
+values = np.float32(np.sin(7. * coords[:, 0]))
+values[::13] = np.nan
+idx = cloud.addScalarField("input")
+cloud.getScalarField(idx).fromNpArrayCopy(values)
+octree = cloud.computeOctree()
+
+radius = 0.025
+res = octree.runPointKernel("example", radius, ["input"])
+if sorted(res.keys()) != sorted(info["outputs"]):
+    raise RuntimeError
+count = cloud.getScalarField(res["neighbourCount"]).toNpArrayCopy()
+mean = cloud.getScalarField(res["meanInput"]).toNpArrayCopy()
+height = cloud.getScalarField(res["heightAboveMin"]).toNpArrayCopy()
+
+# --- against the neighbourhoods given by radiusSearch, on a sample of points
+sample = np.arange(0, cloud.size(), 997)
+(offsets, indexes, d2) = octree.radiusSearch(coords[sample], radius)
+sizes = np.diff(offsets)
+same = count[sample] == sizes
+if np.count_nonzero(same) < 0.99 * len(sample):  # ties on the radius may differ
+    raise RuntimeError
+for k in np.nonzero(same)[0]:
+    nb = indexes[offsets[k]:offsets[k + 1]]
+    v = np.float64(values[nb])
+    v = v[~np.isnan(v)]
+    i = sample[k]
+    if len(v) == 0:
+        if not math.isnan(mean[i]):
+            raise RuntimeError
+    elif not math.isclose(mean[i], v.mean(), abs_tol=1.e-5):
+        raise RuntimeError
+    if not math.isclose(height[i], z[i] - z[nb].min(), abs_tol=1.e-5):
+        raise RuntimeError
+
+# --- errors
+try:
+    octree.runPointKernel("nothing", radius, ["input"])
+    raise RuntimeError
+except KeyError:
+    pass
+try:
+    octree.runPointKernel("example", radius)
+    raise RuntimeError
+except ValueError:
+    pass
+try:
+    octree.runPointKernel("example", radius, ["unknown"])
+    raise RuntimeError
+except ValueError:
+    pass
+try:
+    octree.runPointKernel("example", radius, ["meanInput"])  # read and written at the same time
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- existing outputs are replaced only on request
+try:
+    octree.runPointKernel("example", radius, ["input"])
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- an evicted input is restored
+cloud.evictScalarField("input")
+res2 = octree.runPointKernel("example", radius, ["input"], overwrite=True)
+if not np.allclose(cloud.getScalarField(res2["meanInput"]).toNpArrayCopy(), mean, atol=1.e-6, equal_nan=True):
+    raise RuntimeError
+try:
+    cc.loadKernel(os.path.join(dataDir, "nothing.so"))
+    raise RuntimeError
+except ValueError:
+    pass
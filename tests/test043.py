@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+rng = np.random.default_rng(7)
+coords = np.float32(rng.uniform(-1., 1., (3000, 3)))
+cloud = cc.ccPointCloud("graph")
+cloud.coordsFromNPArray_copy(coords)
+octree = cloud.computeOctree()
+n = cloud.size()
+k = 6
+
+# --- brute force k nearest neighbours, the point itself excluded
+pts = np.float64(coords)
+d2 = ((pts[:, None, :] - pts[None, :, :])**2).sum(axis=2)
+np.fill_diagonal(d2, np.inf)
+nearest = np.argsort(d2, axis=1)[:, :k]
+edges = set((i, j) for i in range(n) for j in nearest[i])
+
+def checkCSR(indptr, indices, data):
+    if indptr.dtype != np.int64 or indices.dtype != np.int64 or data.dtype != np.float64:
+        raise RuntimeError
+    if len(indptr) != n + 1 or indptr[0] != 0 or indptr[-1] != len(indices) or len(data) != len(indices):
+        raise RuntimeError
+    for i in range(n):
+        row = indices[indptr[i]:indptr[i + 1]]
+        if np.any(np.diff(row) <= 0) or i in row:
+            raise RuntimeError
+
+# --- directed graph, distances
+memory = octree.knnGraphMemory(k, False)
+if memory["output"] != (n + 1) * 8 + n * k * 16 or memory["peak"] < memory["output"]:
+    raise RuntimeError
+(indptr, indices, data) = octree.knnGraph(k, False)
+checkCSR(indptr, indices, data)
+if not np.array_equal(np.diff(indptr), np.full(n, k)):
+    raise RuntimeError
+rows = np.repeat(np.arange(n), k)
+if set(zip(rows.tolist(), indices.tolist())) != edges:
+    raise RuntimeError
+if not np.allclose(data, np.sqrt(d2[rows, indices]), rtol=1.e-6):
+    raise RuntimeError
+
+# --- symmetric graph, connectivity and square distances
+(indptr, indices, data) = octree.knnGraph(k, weights="connectivity")
+checkCSR(indptr, indices, data)
+rows = np.repeat(np.arange(n), np.diff(indptr))
+union = edges | set((j, i) for (i, j) in edges)
+if set(zip(rows.tolist(), indices.tolist())) != union or not np.all(data == 1.):
+    raise RuntimeError
+if len(indices) * 16 + (n + 1) * 8 > octree.knnGraphMemory(k)["output"]:
+    raise RuntimeError
+(indptr2, indices2, data2) = octree.knnGraph(k, True, "squareDistance")
+if not np.array_equal(indptr2, indptr) or not np.array_equal(indices2, indices):
+    raise RuntimeError
+if not np.allclose(data2, d2[rows, indices], rtol=1.e-5):
+    raise RuntimeError
+
+# --- errors
+try:
+    octree.knnGraph(k, weights="gaussian")
+    raise RuntimeError
+except ValueError:
+    pass
+try:
+    octree.knnGraph(k, maxMemory=1000.)
+    raise RuntimeError
+except MemoryError:
+    pass
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+
+##########################################################################
+#                                                                        #
+#                                PYCC                                    #
+#                                                                        #
+#  This program is free software; you can redistribute it and/or modify  #
+#  it under the terms of the GNU Library General Public License as       #
+#  published by the Free Software Foundation; version 2 or later of the  #
+#  License.                                                              #
+#                                                                        #
+#  This program is distributed in the hope that it will be useful,       #
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of        #
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          #
+#  GNU General Public License for more details.                          #
+#                                                                        #
+#          Copyright 2021 Paul RASCLE www.openfields.fr                  #
+#                                                                        #
+##########################################################################
+import os
+import sys
+import math
+import time
+from gendata import getSampleCloud, dataDir
+import numpy as np
+import cloudComPy as cc
+
+cc.initCC()  # to do once before using plugins or dealing with numpy
+
+def recall(approx, exact):
+    """fraction of the exact neighbours found by the approximate search"""
+    found = sum(len(np.intersect1d(a, e)) for (a, e) in zip(approx, exact))
+    return found / exact.size
+
+cloud = cc.loadPointCloud(getSampleCloud(5.0))
+queries = cloud.toNpArrayCopy()[::50]
+k = 10
+kdTree = cloud.computeKDTree()
+(idx0, d20) = kdTree.knn(queries, k)
+
+# --- the approximation bound: the i-th neighbour found is at most (1 + epsilon) times farther
+for epsilon in (0.1, 0.5, 2.):
+    (idx, d2) = kdTree.knn(queries, k, 0., epsilon)
+    if np.any(idx < 0) or np.any(np.diff(d2, axis=1) < 0):
+        raise RuntimeError
+    if np.any(np.sqrt(d2) > (1. + epsilon) * np.sqrt(d20) + 1.e-6):
+        raise RuntimeError
+    if epsilon <= 0.5 and recall(idx, idx0) < 0.5:
+        raise RuntimeError
+(idx, d2) = kdTree.knn(queries, k, 0., 0.)
+if not np.array_equal(d2, d20):
+    raise RuntimeError
+
+# --- through the cloud: the KD-tree is required, and computed with "auto"
+cloud.deleteKDTree()
+(idxA, d2A) = cloud.knn(queries, k, epsilon=0.5)
+if cloud.getKDTree() is None or np.any(np.sqrt(d2A) > 1.5 * np.sqrt(d20) + 1.e-6):
+    raise RuntimeError
+try:
+    cloud.knn(queries, k, backend="octree", epsilon=0.5)
+    raise RuntimeError
+except ValueError:
+    pass
+try:
+    kdTree = cloud.getKDTree()
+    kdTree.knn(queries, k, 0., -1.)
+    raise RuntimeError
+except ValueError:
+    pass
+
+# --- benchmark on the sample clouds: recall and speedup of the approximate search against the exact one
+for (h, dx) in ((5.0, 0), (2.0, 0), (5.0, 3)):
+    cl = cc.loadPointCloud(getSampleCloud(h, dx))
+    q = cl.toNpArrayCopy()
+    tree = cl.computeKDTree()
+    t0 = time.perf_counter()
+    (exact, de) = tree.knn(q, k)
+    t1 = time.perf_counter()
+    for epsilon in (0.5, 1., 2.):
+        t2 = time.perf_counter()
+        (approx, da) = tree.knn(q, k, 0., epsilon)
+        t3 = time.perf_counter()
+        sample = slice(None, None, 20)
+        print("sample %s %s, k=%d, epsilon %.1f: recall %.3f, mean distance ratio %.4f, speedup %.2f" %
+              (h, dx, k, epsilon, recall(approx[sample], exact[sample]),
+               np.mean(np.sqrt(da[:, -1]) / np.maximum(np.sqrt(de[:, -1]), 1.e-12)), (t1 - t0) / (t3 - t2)))